@@ -3,8 +3,32 @@
 #include "Circuit.h"
 #include "export.h" 
 
-CIRCUITSIMULATOR_API void dcAnalysis(Circuit& circuit);
-CIRCUITSIMULATOR_API void transientAnalysis(Circuit& circuit, double t_step, double t_stop);
+CIRCUITSIMULATOR_API bool dcAnalysis(Circuit& circuit);
+CIRCUITSIMULATOR_API bool transientAnalysis(Circuit& circuit, double t_step, double t_stop);
+// Continues a transient from the circuit's present state (node voltages, inductor currents,
+// diode states) at t_start; history points are appended after t_start. The integration
+// history restarts with a backward Euler step unless keepHistory is set. With
+// detectSteadyState the run may end early as configured in TransientSettings.
+CIRCUITSIMULATOR_API bool transientSegment(Circuit& circuit, double t_step, double t_start, double t_stop,
+                                           bool keepHistory = false, bool detectSteadyState = false);
+// Continues a transient from a checkpoint written by transientAnalysis on the same circuit, to
+// t_stop (which may lie beyond the original one). History points after the checkpoint time are
+// replaced; with the original t_stop the result is bit-identical to the uninterrupted run.
+CIRCUITSIMULATOR_API bool resumeTransientAnalysis(Circuit& circuit, const std::string& checkpointPath, double t_stop);
+CIRCUITSIMULATOR_API bool waveformRelaxationAnalysis(Circuit& circuit, double t_step, double t_stop);
+CIRCUITSIMULATOR_API bool pararealAnalysis(Circuit& circuit, double t_step, double t_stop);
+// Steady-state response to sources periodic in `period`; the voltage history holds one period
+CIRCUITSIMULATOR_API bool periodicSteadyStateAnalysis(Circuit& circuit, double t_step, double period);
 CIRCUITSIMULATOR_API void dcSweepAnalysis(Circuit& circuit, const std::string& sourceName, double start, double end, double step);
-CIRCUITSIMULATOR_API void acSweepAnalysis(Circuit& circuit, const std::string& sourceName, double start_freq, double stop_freq, int num_points, const std::string& sweep_type);
-CIRCUITSIMULATOR_API void phaseSweepAnalysis(Circuit& circuit, const std::string& sourceName, double base_freq, double start_phase, double stop_phase, int num_points);
+CIRCUITSIMULATOR_API int acSweepAnalysis(Circuit& circuit, const std::string& sourceName, double start_freq, double stop_freq, int num_points, const std::string& sweep_type);
+CIRCUITSIMULATOR_API int phaseSweepAnalysis(Circuit& circuit, const std::string& sourceName, double base_freq, double start_phase, double stop_phase, int num_points);
+// Rational model (Circuit::transferFunction) of TransferFitSettings::outputs with respect to
+// the AC source, fitted over [start_freq, stop_freq]; order 0 picks the order automatically
+CIRCUITSIMULATOR_API bool transferFunctionAnalysis(Circuit& circuit, const std::string& sourceName, double start_freq, double stop_freq, int order);
+// Adjoint sensitivities (Circuit::sensitivity) of one output, "V(node)" or "I(name)" of a
+// source or inductor, with respect to every component value: one factorization of the system
+// and one transposed solve, however many components. AC shares the factorization with the
+// forward solve; DC factors the Jacobian at the operating point of dcAnalysis, refined to
+// round-off by full Newton steps (Circuit::sensitivity.value is the refined output).
+CIRCUITSIMULATOR_API bool dcSensitivityAnalysis(Circuit& circuit, const std::string& output);
+CIRCUITSIMULATOR_API bool acSensitivityAnalysis(Circuit& circuit, const std::string& output, double frequency);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Waveform.h"
+#include <vector>
+#include <queue>
+#include <functional>
+
+using namespace std;
+
+class Circuit;
+
+// Min-heap of upcoming source discontinuities (PULSE corners, PWL points, EXP/SIN delays).
+// Each source keeps at most one pending entry; when it is consumed the source's next
+// breakpoint is pushed, so periodic stimuli never have to be expanded over the whole run.
+class BreakpointQueue {
+public:
+    BreakpointQueue(const Circuit& circuit, double t_stop);
+
+    double next() const;
+    void consumeThrough(double time);
+    double tolerance() const { return timeTolerance; }
+
+private:
+    struct Entry {
+        double time;
+        const Waveform* waveform;
+        bool operator>(const Entry& other) const { return time > other.time; }
+    };
+
+    priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+    double stopTime;
+    double timeTolerance;
+
+    void push(const Waveform* waveform, double after);
+};
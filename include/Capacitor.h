@@ -1,15 +1,29 @@
 #pragma once
 
 #include "Component.h"
+#include <vector>
 
 class Capacitor : public Component {
 public:
     double capacitance;
     double prevVoltage;
+    double prevPrevVoltage; // v(n-1), used by GEAR2
+    double prevCurrent;     // i(n), used by TRAPEZOIDAL
+    double prevCurrentDelta; // i(n) - i(n-1), for ringing detection
+    int ringingCount;
 
-    Capacitor() : capacitance(0.0), prevVoltage(0.0) {}
+    Capacitor() : capacitance(0.0), prevVoltage(0.0), prevPrevVoltage(0.0), prevCurrent(0.0), prevCurrentDelta(0.0), ringingCount(0) {}
 
     double getCurrent() override;
     double getVoltage() override;
-    void update(double dt);
-};
\ No newline at end of file
+    void update(double dt, IntegrationMethod method = IntegrationMethod::BACKWARD_EULER, double prev_dt = 0.0);
+    void resetHistory();
+    // Integration history (prevVoltage, prevPrevVoltage, prevCurrent, prevCurrentDelta,
+    // ringingCount) for saving and restoring a transient mid-run
+    vector<double> historyState() const;
+    void restoreHistoryState(const vector<double>& state);
+
+    // Companion model i = Geq * v - Ieq for the step being solved
+    double companionConductance(IntegrationMethod method, double dt, double prev_dt) const;
+    double companionCurrent(IntegrationMethod method, double dt, double prev_dt) const;
+};
@@ -6,6 +6,7 @@
 #include <map>
 #include <memory>
 #include <complex>
+#include <cstdint>
 
 class Node;
 class Component;
@@ -18,6 +19,9 @@ class Component;
 #include "VoltageSource.h"
 #include "CurrentSource.h"
 #include "ACVoltageSource.h"
+#include "ReducedModel.h"
+#include "PhasorSweep.h"
+#include "TransferFunction.h"
 #include "Component.h"
 
 using namespace std;
@@ -28,9 +32,302 @@ enum class AnalysisType {
     AC_SWEEP
 };
 
+// Everything the DC/transient system matrix depends on besides the component values.
+// Source waveforms only enter the RHS, so an unchanged key means the factorization is still valid.
+struct MatrixStampKey {
+    IntegrationMethod method;
+    double dt;
+    double prev_dt;
+    vector<DiodeState> diodeStates;
+    double shunt; // homotopy conductance from every node to ground
+
+    bool operator==(const MatrixStampKey& other) const;
+    bool operator!=(const MatrixStampKey& other) const { return !(*this == other); }
+};
+
+// AC admittance matrix Y(jw) = G + jwC + Gamma/(jw) split into its frequency-independent
+// parts, assembled once per analysis. Entry k of the shared sparsity pattern sits at
+// (rows[k], cols[k]); inductors make up Gamma, AC sources the constant incidence entries in G.
+struct AcPencil {
+    int size = 0;
+    vector<int> rows;
+    vector<int> cols;
+    vector<double> g;
+    vector<double> c;
+    vector<double> gamma;
+
+    // Y at `frequency` (Hz) into A, one pass over the pattern. Throws runtime_error for a
+    // frequency that is not positive, where Gamma/(jw) has no value.
+    void assemble(double frequency, vector<vector<complex<double>>>& A) const;
+};
+
+// Transient step control. Fixed mode walks the t_step grid and only shortens a step to land
+// on a source breakpoint; adaptive mode starts from t_step and keeps the local truncation
+// error within relTol/absTol, growing the step in smooth regions.
+struct TransientSettings {
+    bool adaptiveStep = false;
+    double relTol = 1e-3;
+    double absTol = 1e-6;
+    double minStep = 0.0; // 0 selects 1e-9 * t_stop
+    double maxStep = 0.0; // 0 selects max(t_step, t_stop / 50)
+    // Device bypass: Shockley diodes whose junction voltage has barely moved keep their last
+    // linearization instead of being re-evaluated
+    bool deviceBypass = false;
+    double bypassTol = 1e-6; // relative change below which a junction counts as quiescent
+    // Early termination: integration stops once the solution has settled, or repeats every
+    // steadyStatePeriod (0 = the common period of the AC and periodic sources), closely enough
+    // that the drift projected over the rest of the run stays within tolerance. The output is
+    // then filled to t_stop with the settled values or the repeated last period.
+    bool steadyStateStop = false;
+    double steadyStatePeriod = 0.0;
+    double steadyStateRelTol = 1e-5;
+    double steadyStateAbsTol = 1e-8;
+    // Checkpoints: every checkpointInterval of simulated time (0 = off) transientAnalysis
+    // overwrites checkpointPath with a snapshot resumeTransientAnalysis can continue from
+    double checkpointInterval = 0.0;
+    string checkpointPath;
+    // Exponential integration of circuits without diodes: steps run from output point to output
+    // point (and source breakpoints) with the sources linear in between, so the step is limited
+    // by t_step only. exponentialTol is the Krylov tolerance relative to the propagated state.
+    bool exponentialIntegrator = false;
+    double exponentialTol = 1e-8;
+    int maxKrylovDimension = 40;
+    // LRU cache of factorizations per stamp key (diode states, step size); each entry holds
+    // two dense matrices of the MNA size, 0 turns it off
+    int factorizationCacheEntries = 8;
+};
+
+// Shockley diode linearizations evaluated versus bypassed
+struct DeviceActivity {
+    long evaluated = 0;
+    long bypassed = 0;
+};
+
+// Work done by the transient runs since the counters were last reset
+struct TransientStats {
+    long steps = 0;
+    long newtonIterations = 0;
+    long factorizations = 0;
+    long diodeEvents = 0;
+    long cacheHits = 0;   // matrix switches served from the factorization cache
+    long cacheMisses = 0; // and those that rebuilt the matrix
+    double earlyStopTime = -1.0;  // where steady-state detection ended integration (-1: ran to t_stop)
+    bool earlyStopPeriodic = false;
+};
+
+// Waveform-relaxation transient: the circuit is cut at its weakest resistive couplings into
+// partitions that are integrated separately over each time window, exchanging boundary node
+// waveforms until they agree. Jacobi sweeps run the partitions on parallel threads;
+// Gauss-Seidel sweeps run them in turn, each seeing the waveforms just computed.
+struct RelaxationSettings {
+    int partitions = 0;        // 0 selects one per hardware thread
+    double windowLength = 0.0; // 0 selects t_stop / 10
+    int maxIterations = 50;
+    double relTol = 1e-4;
+    double absTol = 1e-6;
+    bool gaussSeidel = false;
+};
+
+// Parareal transient: the interval is cut into `slices` (0 selects one per hardware thread).
+// A backward Euler coarse propagator with coarseSteps steps per slice sweeps the whole run,
+// the fine propagator (the regular transient) runs on every slice in parallel, and the
+// slice start states are corrected until they change by less than relTol/absTol.
+struct PararealSettings {
+    int slices = 0;
+    int coarseSteps = 4;
+    int maxIterations = 0; // 0 selects the slice count, where Parareal is exact
+    double relTol = 1e-4;
+    double absTol = 1e-6;
+};
+
+struct PararealStats {
+    int slices = 0;
+    int iterations = 0;
+    double wallTime = 0.0;          // seconds
+    double estimatedSpeedup = 0.0;  // serial fine time over the parallel critical path
+};
+
+// Periodic steady state by shooting-Newton: the state at the start of a period (voltages of the
+// capacitor nodes, inductor currents) is corrected until one period of transient maps it onto
+// itself. Each Newton system is solved by GMRES on finite-difference products with the
+// period's sensitivity matrix, one extra period per product.
+struct SteadyStateSettings {
+    int maxNewtonIterations = 20;
+    int maxKrylovIterations = 40;
+    double relTol = 1e-5;
+    double absTol = 1e-8;
+    double krylovTol = 1e-3;  // GMRES residual relative to the Newton residual
+    int warmupPeriods = 1;    // plain transient periods before the first Newton step (at least one)
+};
+
+struct SteadyStateStats {
+    bool converged = false;
+    int newtonIterations = 0;
+    int krylovIterations = 0;
+    long periods = 0; // periods of transient simulated in total
+};
+
+// PRIMA reduction of large linear subnetworks (see ModelReduction.h). A subnetwork is a
+// connected group of nodes touched only by resistors, capacitors and inductors; nodes touched
+// by anything else, and keepNodes, are its ports. Moments are matched about
+// 2*pi*expansionFrequency (0 keeps DC exact but needs a resistive path from every internal
+// node to a port or ground).
+struct ReductionSettings {
+    int minInternalNodes = 50;  // smaller subnetworks are left alone
+    int moments = 4;            // block moments matched per port input
+    int maxOrder = 200;         // cap on the internal states of one macromodel
+    double expansionFrequency = 0.0;
+    vector<string> keepNodes;   // nodes to keep observable
+};
+
+struct ReductionStats {
+    int subnetworks = 0;
+    int removedNodes = 0;
+    int removedComponents = 0;
+    int states = 0;             // internal states of all macromodels
+};
+
+// DC sweep: every point starts from the previous point's solution and ideal-diode states, and
+// the factorization is kept while no diode switches, so a linear circuit is factored once and
+// each point costs a solve. Sweeps of at least 2 * minSegmentPoints points are cut into up
+// to `segments` runs (0 selects one per hardware thread) on parallel threads, each starting
+// cold (diodes off) at its first point.
+struct DcSweepSettings {
+    int segments = 0;
+    int minSegmentPoints = 50;
+};
+
+struct DcSweepStats {
+    long points = 0;
+    long factorizations = 0;
+    int segments = 0;
+};
+
+// AC sweep: frequency points are independent, so sweeps of at least 2 * minThreadPoints
+// points are split over up to `threads` worker threads (0 selects one per hardware thread),
+// each assembling and solving its points in its own buffers.
+// The "Adaptive" sweep type starts from adaptiveInitialPoints log-spaced points and bisects
+// (in log frequency) every interval where straight-line interpolation between its ends is
+// off from the local quadratic through the neighbouring points by more than adaptiveTol
+// relative to the response there, until none is or the sweep's point budget is spent.
+// fastSweep evaluates Linear/Decade sweeps from a Krylov-projected model instead (see
+// fastFrequencySweep): fastSweepMoments moments per expansion point, at most
+// fastSweepMaxExpansions points, each point accepted once its backward error is within
+// fastSweepTol.
+struct AcSweepSettings {
+    int threads = 0;
+    int minThreadPoints = 32;
+    int adaptiveInitialPoints = 21;
+    double adaptiveTol = 1e-3;
+    bool fastSweep = false;
+    int fastSweepMoments = 12;
+    int fastSweepMaxExpansions = 6;
+    double fastSweepTol = 1e-10;
+};
+
+struct AcSweepStats {
+    long points = 0;
+    int threads = 0;
+    int refinementPasses = 0; // adaptive sweeps only
+    int expansionPoints = 0;  // fast sweeps only
+    int reducedOrder = 0;
+    long directPoints = 0;    // fast-sweep points the model missed, solved directly
+};
+
+// Transfer-function extraction (transferFunctionAnalysis): the outputs are solved for a unit
+// excitation of the source at `samples` log-spaced frequencies and vector-fitted with
+// `iterations` pole relocations. Without a fixed order the order rises in pairs up to
+// maxOrder until every output's RMS misfit is within tol of its largest sample.
+struct TransferFitSettings {
+    int samples = 200;
+    int iterations = 8;
+    int maxOrder = 40;
+    double tol = 1e-6;
+    vector<string> outputs; // signals named as in PhasorSweep, e.g. "V(out)" or "I(L1)"
+};
+
+// Homotopy continuation for DC operating points the plain solve cannot find. The methods are
+// tried in turn until one converges: gmin stepping (a conductance from every node to ground,
+// stepped down from gminStart to gminFinal and then removed), source stepping (every
+// independent source ramped up from zero) and pseudo-transient (the same conductance, but
+// pulling each node towards its last solution, like a node capacitance with growing time
+// steps). The continuation step grows after each success and is halved after a failure.
+struct HomotopySettings {
+    bool enabled = true;
+    double gminStart = 1e-2;
+    double gminFinal = 1e-12;
+    double pseudoTransientStart = 1.0; // initial pseudo-transient conductance
+    double minSourceStep = 1e-4;       // smallest source-stepping increment before giving up
+    int maxSteps = 200;                // continuation steps per method
+};
+
+enum class HomotopyMethod {
+    NONE,           // the plain solve converged
+    GMIN_STEPPING,
+    SOURCE_STEPPING,
+    PSEUDO_TRANSIENT,
+    FAILED
+};
+
+struct HomotopyStats {
+    HomotopyMethod method = HomotopyMethod::NONE; // of the last operating point
+    long continuations = 0; // operating points that needed homotopy
+    long steps = 0;         // converged continuation steps
+    long failedSteps = 0;
+};
+
+// Dynamic state a transient can be restarted from
+struct CircuitState {
+    vector<double> nodeVoltages; // circuit.nodes order
+    vector<double> inductorCurrents;
+    vector<DiodeState> diodeStates;
+    vector<double> diodeCurrents;
+    vector<double> junctionVoltages;
+
+    // Integration history, so a restored state continues a transient step for step
+    vector<vector<double>> capacitorHistory;
+    vector<vector<double>> inductorHistory;
+    vector<vector<double>> reducedModelHistory;
+    double prevDeltaT = 0.0;
+    int historyDepth = 0;
+    int dampingSteps = 0;
+};
+
+// Last converged DC operating point, tagged with hashes of the circuit it was solved for. An
+// unchanged circuit reuses it outright; one with the same topology but other values starts
+// Newton and the ideal-diode states from it.
+struct OperatingPoint {
+    bool valid = false;
+    uint64_t topology = 0; // nodes, components and their connections
+    uint64_t values = 0;   // component values, source settings and diode models
+    vector<double> solution; // MNA unknowns
+    vector<DiodeState> diodeStates;
+    vector<double> diodeCurrents;
+    vector<double> junctionVoltages;
+};
+
+// Adjoint sensitivities of one output (dcSensitivityAnalysis, acSensitivityAnalysis): the
+// derivative of the output with respect to the value of each resistor, capacitor, inductor
+// and independent source, by name. DC results have zero imaginary parts.
+struct SensitivityResults {
+    string output;
+    bool ac = false;
+    double frequency = 0.0;
+    complex<double> value;                // the output at the operating point / frequency
+    vector<string> components;
+    vector<complex<double>> derivatives;  // d output / d component value
+
+    void clear() { *this = SensitivityResults(); }
+};
 
 class Circuit {
 public:
+    Circuit();
+    ~Circuit();
+    // The circuit owns its nodes, so it is not copyable
+    Circuit(const Circuit&) = delete;
+    Circuit& operator=(const Circuit&) = delete;
+
     vector<Node*> nodes;
     vector<Resistor> resistors;
     vector<Capacitor> capacitors;
@@ -39,12 +336,51 @@ public:
     vector<VoltageSource> voltageSources;
     vector<ACVoltageSource> acVoltageSources;
     vector<CurrentSource> currentSources;
+    vector<ReducedModel> reducedModels;
     vector<string> groundNodeNames;
 
     double delta_t;
+    double time = 0.0; // simulation time at which source waveforms are evaluated
+    double prev_delta_t = 0.0;
+
+    IntegrationMethod integrationMethod = IntegrationMethod::BACKWARD_EULER; // requested by the user
+    IntegrationMethod stepMethod = IntegrationMethod::BACKWARD_EULER;        // used for the step being stamped
+    int historyDepth = 0;  // accepted transient steps since the reactive history was reset
+    int dampingSteps = 0;  // remaining backward Euler steps forced to damp trapezoidal ringing
+    TransientSettings transientSettings;
+    DeviceActivity deviceActivity;
+    TransientStats transientStats;
+    RelaxationSettings relaxationSettings;
+    PararealSettings pararealSettings;
+    PararealStats pararealStats;
+    SteadyStateSettings steadyStateSettings;
+    SteadyStateStats steadyStateStats;
+    ReductionSettings reductionSettings;
+    ReductionStats reductionStats;
+    DcSweepSettings dcSweepSettings;
+    DcSweepStats dcSweepStats;
+    AcSweepSettings acSweepSettings;
+    AcSweepStats acSweepStats;
+    PhasorSweep acSweepResults;
+    PhasorSweep phaseSweepResults;
+    TransferFitSettings transferFitSettings;
+    TransferFunction transferFunction;
+    SensitivityResults sensitivity;
+    HomotopySettings homotopySettings;
+    HomotopyStats homotopyStats;
+
+    // DC homotopy aids: a conductance from every node to ground pulling it towards
+    // homotopyAnchor (ground when empty), and a factor on all independent sources
+    double homotopyConductance = 0.0;
+    vector<double> homotopyAnchor;
+    double sourceScale = 1.0;
+
+    OperatingPoint operatingPoint;
+    bool reuseOperatingPoint = true;
 
     vector<vector<double>> MNA_A;
     vector<double> MNA_RHS;
+    vector<double> MNA_solution;
 
     vector<vector<complex<double>>> MNA_A_Complex;
     vector<complex<double>> MNA_RHS_Complex;
@@ -59,6 +395,7 @@ public:
     void addNode(const string& name);
     Node* findNode(const string& name);
     Node* findOrCreateNode(const string& name);
+    bool isNodeNameGround(const string& node_name) const;
 
     Resistor* findResistor(const string& name);
     Capacitor* findCapacitor(const string& name);
@@ -69,14 +406,52 @@ public:
     ACVoltageSource* findACVoltageSource(const string& name);
 
     bool deleteResistor(const string& name);
+    bool deleteCapacitor(const string& name);
+    bool deleteInductor(const string& name);
+    bool deleteDiode(const string& name);
+    bool deleteVoltageSource(const string& name);
+    bool deleteCurrentSource(const string& name);
     void set_MNA_A(AnalysisType type, double frequency = 0);
     void set_MNA_RHS(AnalysisType type, double frequency = 0);
+    void MNA_sol_size();
+    // AC system at one frequency in caller-owned buffers (set_MNA_A/RHS fill MNA_A_Complex and
+    // MNA_RHS_Complex with them); const, so sweeps can assemble on several threads at once.
+    // Sweeps build acPencil() once and assemble each frequency from it.
+    AcPencil acPencil() const;
+    void acMatrix(double frequency, vector<vector<complex<double>>>& A) const;
+    void acRHS(vector<complex<double>>& b) const;
+    // Descriptor form C x' + G x = b(t) of the linear circuit, on the transient unknowns
+    // (node voltages, then the extra variables). Branch rows are negated so that
+    // G = [G_R B; -B^T 0] and C = diag(C_C, L): the passive form MOR and exponential
+    // integration work with. Conducting ideal diodes are fixed voltage sources, Shockley
+    // diodes are left out.
+    void descriptorSystem(vector<vector<double>>& g, vector<vector<double>>& c);
+    vector<double> sourceVector(double t);
 
     void setDeltaT(double dt);
+    void setIntegrationMethod(IntegrationMethod method);
+    void selectStepMethod();
+    void requestIntegrationDamping(int steps = 2);
+    void resetIntegrationHistory();
     void updateComponentStates();
+    double bypassTolerance() const; // 0 when device bypass is off
+    MatrixStampKey matrixStampKey() const;
     void clearComponentHistory();
     int getNodeMatrixIndex(const Node* target_node_ptr) const;
     int countNonGroundNodes() const;
     int countTotalExtraVariables();
-    void assignDiodeBranchIndices();
+    int inductorBranchOffset() const;
+    void assignDiodeBranchIndices(); // and the reduced-model states, which follow the diodes
+    // MNA row/column of entry k of a reduced model's x = [v_ports; z] (-1 for a grounded
+    // port), with the model's states starting at stateBase
+    int reducedModelIndex(const ReducedModel& model, size_t k, int stateBase) const;
+
+    // Independent copy (own nodes, same components and settings, no history) for running
+    // analyses on another thread
+    unique_ptr<Circuit> clone() const;
+    CircuitState captureState();
+    // Content hashes for OperatingPoint
+    uint64_t topologyHash() const;
+    uint64_t valueHash() const;
+    void restoreState(const CircuitState& state);
 };
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Circuit.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// One piece of a circuit split for waveform relaxation. The subcircuit holds copies of the
+// components the partition owns; a resistor cut by the split is copied to both sides, and on
+// each side its far node is driven by a voltage source replaying the other side's waveform.
+struct CircuitPartition {
+    unique_ptr<Circuit> circuit;
+    vector<string> ownedNodes;    // nodes this partition solves for
+    vector<string> boundaryNodes; // nodes of other partitions seen through cut resistors
+    vector<int> boundaryOwners;   // partition solving for each boundary node
+    size_t firstDriver = 0;       // voltageSources index of the driver of boundaryNodes[0]
+
+    VoltageSource& driver(size_t boundary) { return circuit->voltageSources[firstDriver + boundary]; }
+};
+
+// Splits the circuit into at most maxPartitions pieces. Every component except a resistor keeps
+// its nodes in one piece; resistors then merge pieces strongest (smallest resistance) first until
+// maxPartitions remain, so the resistors left cut are the weakest couplings. Drivers start at
+// the boundary nodes' present voltages.
+vector<CircuitPartition> partitionCircuit(const Circuit& circuit, int maxPartitions);
@@ -15,23 +15,114 @@ extern "C" {
     CIRCUITSIMULATOR_API void AddCapacitor(void* circuit, const char* name, const char* node1, const char* node2, double value);
     CIRCUITSIMULATOR_API void AddInductor(void* circuit, const char* name, const char* node1, const char* node2, double value);
     CIRCUITSIMULATOR_API void AddVoltageSource(void* circuit, const char* name, const char* node1, const char* node2, double voltage);
+    CIRCUITSIMULATOR_API void AddDiode(void* circuit, const char* name, const char* anode, const char* cathode, double forwardVoltage);
+    CIRCUITSIMULATOR_API void AddZenerDiode(void* circuit, const char* name, const char* anode, const char* cathode, double forwardVoltage, double zenerVoltage);
     CIRCUITSIMULATOR_API void AddACVoltageSource(void* circuit, const char* name, const char* node1, const char* node2, double magnitude, double phase);
     
     CIRCUITSIMULATOR_API void SetGroundNode(void* circuit, const char* nodeName);
     
+    // Simulation Settings
+    // method: 0 = backward Euler, 1 = trapezoidal, 2 = Gear-2 (BDF2)
+    CIRCUITSIMULATOR_API void SetIntegrationMethod(void* circuit, int method);
+    // model: 0 = ideal switch, 1 = Shockley exponential (saturation current, emission coefficient)
+    CIRCUITSIMULATOR_API bool SetDiodeModel(void* circuit, const char* diodeName, int model, double saturationCurrent, double emissionCoefficient);
+    // minStep/maxStep of 0 select the defaults derived from the analysis stop time
+    CIRCUITSIMULATOR_API void SetTransientStepControl(void* circuit, bool adaptive, double relTol, double absTol, double minStep, double maxStep);
+    CIRCUITSIMULATOR_API void SetDeviceBypass(void* circuit, bool enabled, double tolerance);
+    // Factorizations kept for recurring diode conduction patterns in transient (0 = off)
+    CIRCUITSIMULATOR_API void SetFactorizationCache(void* circuit, int entries);
+    CIRCUITSIMULATOR_API void SetSteadyStateStop(void* circuit, bool enabled, double period, double relTol, double absTol);
+    // Circuits without diodes only; tolerance/maxKrylovDimension of 0 keep the defaults
+    CIRCUITSIMULATOR_API void SetExponentialIntegrator(void* circuit, bool enabled, double tolerance, int maxKrylovDimension);
+    // interval of 0 or a null path turns checkpoints off
+    CIRCUITSIMULATOR_API void SetTransientCheckpoint(void* circuit, const char* path, double interval);
+    CIRCUITSIMULATOR_API void SetWaveformRelaxation(void* circuit, int partitions, double windowLength, int maxIterations, double tolerance, bool gaussSeidel);
+    CIRCUITSIMULATOR_API void SetParareal(void* circuit, int slices, int coarseSteps, int maxIterations, double tolerance);
+    CIRCUITSIMULATOR_API void SetSteadyStateOptions(void* circuit, int maxNewtonIterations, int maxKrylovIterations, double relTol, double absTol, int warmupPeriods);
+    // Whether DC (and the initial point of transient) reuse the last converged operating point
+    CIRCUITSIMULATOR_API void SetOperatingPointReuse(void* circuit, bool enabled);
+    // Fallbacks for DC operating points that do not converge; values of 0 keep the defaults
+    CIRCUITSIMULATOR_API void SetHomotopyOptions(void* circuit, bool enabled, double gminStart, double gminFinal, int maxSteps);
+    // segments of 0 runs one sweep segment per hardware thread
+    CIRCUITSIMULATOR_API void SetDCSweepOptions(void* circuit, int segments, int minSegmentPoints);
+    // threads of 0 solves AC sweep points on one thread per hardware thread
+    CIRCUITSIMULATOR_API void SetACSweepOptions(void* circuit, int threads, int minThreadPoints);
+    // Linear/Decade AC sweeps from a Krylov reduced model; values of 0 keep the defaults
+    CIRCUITSIMULATOR_API void SetFastACSweep(void* circuit, bool enabled, int moments, int maxExpansionPoints, double tolerance);
+    // For RunACAnalysis with sweepType "Adaptive", where numPoints is the point budget; values
+    // of 0 keep the defaults
+    CIRCUITSIMULATOR_API void SetAdaptiveACSweep(void* circuit, int initialPoints, double tolerance);
+    // Nodes named here survive ReduceLinearSubnetworks as macromodel ports
+    CIRCUITSIMULATOR_API bool KeepNodeObservable(void* circuit, const char* nodeName);
+    // Outputs for RunTransferFunctionAnalysis, named as for GetSweepSignal
+    CIRCUITSIMULATOR_API bool AddTransferFunctionOutput(void* circuit, const char* signalName);
+    CIRCUITSIMULATOR_API void ClearTransferFunctionOutputs(void* circuit);
+    // Values of 0 keep the defaults
+    CIRCUITSIMULATOR_API void SetTransferFitOptions(void* circuit, int samples, int iterations, int maxOrder, double tolerance);
+
+    // Transient source waveforms (applied to a voltage or current source by name)
+    CIRCUITSIMULATOR_API bool SetSourceSinWaveform(void* circuit, const char* sourceName, double offset, double amplitude, double frequency, double delay, double damping, double phase);
+    CIRCUITSIMULATOR_API bool SetSourcePulseWaveform(void* circuit, const char* sourceName, double v1, double v2, double delay, double rise, double fall, double width, double period);
+    CIRCUITSIMULATOR_API bool SetSourceExpWaveform(void* circuit, const char* sourceName, double v1, double v2, double delay1, double tau1, double delay2, double tau2);
+    CIRCUITSIMULATOR_API bool SetSourcePwlWaveform(void* circuit, const char* sourceName, const double* times, const double* values, int count);
+    
     // Analysis Functions
     CIRCUITSIMULATOR_API bool RunDCAnalysis(void* circuit);
+    // Sweeps a voltage or current source; results go to the DC sweep histories
+    CIRCUITSIMULATOR_API bool RunDCSweepAnalysis(void* circuit, const char* sourceName, double start, double end, double step);
     CIRCUITSIMULATOR_API bool RunTransientAnalysis(void* circuit, double stepTime, double stopTime);
+    CIRCUITSIMULATOR_API bool ResumeTransientAnalysis(void* circuit, const char* checkpointPath, double stopTime);
+    CIRCUITSIMULATOR_API bool RunWaveformRelaxationAnalysis(void* circuit, double stepTime, double stopTime);
+    CIRCUITSIMULATOR_API bool RunPararealAnalysis(void* circuit, double stepTime, double stopTime);
+    CIRCUITSIMULATOR_API bool RunPeriodicSteadyStateAnalysis(void* circuit, double stepTime, double period);
     CIRCUITSIMULATOR_API bool RunACAnalysis(void* circuit, const char* sourceName, double startFreq, double stopFreq, int numPoints, const char* sweepType);
     CIRCUITSIMULATOR_API bool RunPhaseSweepAnalysis(void* circuit, const char* sourceName, double baseFreq, double startPhase, double stopPhase, int numPoints);
+    // Pole/residue model of the transfer function outputs; order 0 picks the order automatically
+    CIRCUITSIMULATOR_API bool RunTransferFunctionAnalysis(void* circuit, const char* sourceName, double startFreq, double stopFreq, int order);
+    // Derivatives of one output ("V(node)", or "I(name)" of a source or inductor) with respect
+    // to every component value, by adjoint analysis
+    CIRCUITSIMULATOR_API bool RunDCSensitivityAnalysis(void* circuit, const char* output);
+    CIRCUITSIMULATOR_API bool RunACSensitivityAnalysis(void* circuit, const char* output, double frequency);
+
+    // Model order reduction: replaces linear RLC subnetworks with at least minInternalNodes
+    // internal nodes by PRIMA macromodels and returns how many were replaced (-1 on error).
+    // Arguments of 0 keep the defaults; expansionFrequency is in Hz.
+    CIRCUITSIMULATOR_API int ReduceLinearSubnetworks(void* circuit, int minInternalNodes, int moments, int maxOrder, double expansionFrequency);
 
     // Result Retrieval
     CIRCUITSIMULATOR_API double GetNodeVoltage(void* circuit, const char* nodeName);
     CIRCUITSIMULATOR_API int GetNodeNames(void* circuit, char* nodeNamesBuffer, int bufferSize);
     CIRCUITSIMULATOR_API int GetNodeVoltageHistory(void* circuit, const char* nodeName, double* timePoints, double* voltages, int maxCount);
+    CIRCUITSIMULATOR_API int GetNodeDCSweepHistory(void* circuit, const char* nodeName, double* sweepValues, double* voltages, int maxCount);
     CIRCUITSIMULATOR_API int GetNodeSweepHistory(void* circuit, const char* nodeName, double* frequencies, double* magnitudes, int maxCount);
     CIRCUITSIMULATOR_API int GetNodePhaseSweepHistory(void* circuit, const char* nodeName, double* phases, double* magnitudes, int maxCount);
+    // Any recorded signal of the AC (analysis 0) or phase (analysis 1) sweep: "V(node)", or
+    // "I(name)" for AC sources and inductors. view 0 = magnitude, 1 = dB, 2 = phase in degrees.
+    CIRCUITSIMULATOR_API int GetSweepSignal(void* circuit, int analysis, const char* signalName, int view, double* sweepValues, double* values, int maxCount);
+    CIRCUITSIMULATOR_API int GetSweepPhasors(void* circuit, int analysis, const char* signalName, double* sweepValues, double* real, double* imag, int maxCount);
+    // From the RunTransferFunctionAnalysis model, in O(order) per call. The impulse response
+    // leaves out the d delta(t) + e delta'(t) terms, which are returned with the residues.
+    CIRCUITSIMULATOR_API bool EvaluateTransferFunction(void* circuit, const char* signalName, double frequency, double* real, double* imag);
+    CIRCUITSIMULATOR_API bool EvaluateImpulseResponse(void* circuit, const char* signalName, double time, double* value);
+    CIRCUITSIMULATOR_API int GetTransferFunctionPoles(void* circuit, double* real, double* imag, int maxCount);
+    CIRCUITSIMULATOR_API int GetTransferFunctionResidues(void* circuit, const char* signalName, double* real, double* imag, int maxCount, double* constant, double* proportional);
+    // d output / d value of one component from the last sensitivity analysis (DC: imag = 0)
+    CIRCUITSIMULATOR_API bool GetSensitivity(void* circuit, const char* componentName, double* real, double* imag);
+    CIRCUITSIMULATOR_API bool GetSensitivityOutput(void* circuit, double* real, double* imag);
+    CIRCUITSIMULATOR_API int GetSensitivityComponentNames(void* circuit, char* namesBuffer, int bufferSize);
     CIRCUITSIMULATOR_API int GetComponentCurrentHistory(void* circuit, const char* componentName, double* timePoints, double* currents, int maxCount);
     CIRCUITSIMULATOR_API int GetAllVoltageSourceNames(void* circuit, char* vsNamesBuffer, int bufferSize);
     CIRCUITSIMULATOR_API double GetVoltageSourceCurrent(void* circuit, const char* vsName);
+    CIRCUITSIMULATOR_API void GetDeviceActivity(void* circuit, int* evaluated, int* bypassed);
+    CIRCUITSIMULATOR_API void GetFactorizationCacheStats(void* circuit, int* hits, int* misses);
+    CIRCUITSIMULATOR_API bool GetTransientEarlyStop(void* circuit, double* stopTime, bool* periodic);
+    CIRCUITSIMULATOR_API void GetPararealStats(void* circuit, int* iterations, double* estimatedSpeedup, double* wallTime);
+    CIRCUITSIMULATOR_API void GetSteadyStateStats(void* circuit, int* newtonIterations, int* krylovIterations, int* periods);
+    // method: 0 = not needed, 1 = gmin stepping, 2 = source stepping, 3 = pseudo-transient, 4 = failed
+    CIRCUITSIMULATOR_API void GetHomotopyStats(void* circuit, int* method, int* steps, int* failedSteps);
+    CIRCUITSIMULATOR_API void GetDCSweepStats(void* circuit, int* points, int* factorizations, int* segments);
+    CIRCUITSIMULATOR_API void GetACSweepStats(void* circuit, int* points, int* threads, int* refinementPasses);
+    CIRCUITSIMULATOR_API void GetFastACSweepStats(void* circuit, int* expansionPoints, int* reducedOrder, int* directPoints);
+    CIRCUITSIMULATOR_API void GetTransferFunctionStats(void* circuit, int* order, double* rmsError);
+    CIRCUITSIMULATOR_API void GetReductionStats(void* circuit, int* subnetworks, int* removedNodes, int* removedComponents, int* states);
 }
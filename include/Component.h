@@ -6,6 +6,21 @@ using namespace std;
 
 class Node;
 
+// Integration formula used by the capacitor/inductor companion models in transient analysis.
+enum class IntegrationMethod {
+    BACKWARD_EULER = 0,
+    TRAPEZOIDAL = 1,
+    GEAR2 = 2
+};
+
+// Variable-step BDF2 (Gear-2) coefficients: x'(n+1) ~= (a0*x(n+1) + a1*x(n) + a2*x(n-1)) / dt
+inline void gear2Coefficients(double dt, double prev_dt, double &a0, double &a1, double &a2) {
+    double omega = dt / prev_dt;
+    a0 = (1.0 + 2.0 * omega) / (1.0 + omega);
+    a1 = -(1.0 + omega);
+    a2 = omega * omega / (1.0 + omega);
+}
+
 class Component {
 public:
     string name;
@@ -18,4 +33,4 @@ public:
     virtual double getVoltage() = 0;
     virtual void setCurrent(double c) {};
     virtual ~Component() {};
-};
\ No newline at end of file
+};
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "Component.h"
+#include "Waveform.h"
 
 class CurrentSource : public Component {
 public:
     double value;
     bool diode = false;
+    Waveform waveform;
     CurrentSource() : value(0.0) {}
 
     double getCurrent() override;
     double getVoltage() override;
+
+    double valueAt(double time) const;
 };
\ No newline at end of file
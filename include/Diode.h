@@ -11,6 +11,11 @@ enum DiodeType {
     ZENER
 };
 
+enum DiodeModel {
+    MODEL_IDEAL,    // piecewise-linear switch with forward (and zener) voltage drop
+    MODEL_SHOCKLEY  // exponential junction solved by Newton-Raphson
+};
+
 enum DiodeState {
     STATE_OFF = 0,
     STATE_FORWARD_ON = 1,
@@ -35,9 +40,34 @@ public:
     void setCurrent(double c);
     double getVoltage() override;
 
+    // Ideal model: signed distance to the next state change, negative while the present state
+    // is consistent with the terminal voltage v and branch current i, positive once it is not
+    double switchingFunction(double v, double i) const;
+    DiodeState switchedState(double v) const;
+
+    void setModel(DiodeModel model);
+    DiodeModel getModel() const;
+
+    // Shockley model i = Is * (exp(v / (n * Vt)) - 1), plus reverse breakdown for zeners
+    double shockleyCurrent(double v) const;
+    double shockleyConductance(double v) const;
+    double limitJunctionVoltage(double v_new, double v_old) const;
+
+    double saturationCurrent = 1e-14;
+    double emissionCoefficient = 1.0;
+    double junctionVoltage = 0.0; // Newton linearization point, kept between solves
+
+    // Device bypass: linearization (gd, Ieq) from the last evaluation at stampVoltage, reused
+    // while the junction voltage stays within the bypass tolerance of it
+    bool stampValid = false;
+    double stampVoltage = 0.0;
+    double stampConductance = 0.0;
+    double stampCurrent = 0.0;
+
 
 private:
     DiodeType diodeType;
+    DiodeModel diodeModel;
     DiodeState currentState;
 public:
     double forwardVoltage;
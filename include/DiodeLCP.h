@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Circuit.h"
+#include "LinearSolver.h"
+#include <vector>
+
+using namespace std;
+
+// DC states of ideal diodes as a linear complementarity problem. With every diode off, the
+// rest of the circuit is linear, and each conduction mode is a current z >= 0 injected
+// between the diode terminals whose slack w (Vf - v for forward conduction, Vz + v for zener
+// reverse conduction) must be >= 0 with w z = 0. Eliminating everything but those currents
+// leaves the small system w = q + M z, with M the Schur complement of the network at the
+// diode terminals (positive semidefinite for a passive network), which Lemke's method solves
+// in a few pivots instead of guessing states and re-solving the whole MNA system.
+class DiodeLCP {
+public:
+    // Factors the network with all diodes off. Returns false if the circuit has no ideal
+    // diodes, has Shockley diodes, or is singular with the diodes off (e.g. a node reached
+    // only through diodes). Expects the DC stamp (capacitors open); the diode states are left
+    // as they were, whatever the outcome.
+    bool prepare(Circuit& circuit);
+
+    // Sets the diode states for the present source values. Returns false (leaving the states
+    // alone) if Lemke's method terminates on a ray, i.e. the states are inconsistent whatever
+    // they are (a conducting diode across a voltage source).
+    bool solve(Circuit& circuit);
+
+    int lastPivots = 0;
+    long totalPivots = 0;
+
+private:
+    struct Mode {
+        size_t diode;
+        bool reverse;
+        double voltage;    // Vf, or Vz in reverse
+        vector<double> g;  // +-(e_anode - e_cathode) over the MNA unknowns
+    };
+    vector<Mode> modes;
+    vector<vector<double>> M;
+    LUFactorization lu;
+    bool ready = false;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "LinearSolver.h"
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct ExponentialStats {
+    long steps = 0;
+    long krylovVectors = 0; // shift-and-invert solves over all steps
+    int maxDimension = 0;
+};
+
+// Exact-in-time integrator for the linear descriptor system C x' + G x = b(t) with b linear
+// across each step. The step is split into the affine particular solution p(t) = p0 + t p1
+// (G p1 = b', G p0 = b - C p1) and the homogeneous part, which is propagated as exp(hA) e with
+// A = -C^-1 G. That product is taken from the shift-and-invert Krylov space of
+// (C + gamma G)^-1 C, which stays well defined for the singular C of MNA (algebraic rows decay
+// instantly), and the small projected exponential is evaluated by Pade. Only G and
+// C + gamma G are factored, once, whatever the step sizes.
+class ExponentialIntegrator {
+public:
+    ExponentialStats stats;
+
+    // Throws runtime_error when G or C + gamma G is singular (e.g. a node reached only through
+    // capacitors)
+    ExponentialIntegrator(const vector<vector<double>>& g, const vector<vector<double>>& c, double gamma,
+                          double tolerance, int maxDimension);
+
+    // Solution of G x = b, the operating point for a constant input b
+    vector<double> operatingPoint(const vector<double>& b) const;
+
+    // State at the end of a step of length h from x, with the input moving linearly from b0
+    // to b1 over the step
+    vector<double> step(const vector<double>& x, const vector<double>& b0, const vector<double>& b1, double h);
+
+private:
+    vector<vector<pair<int, double>>> C; // nonzeros by row
+    LUFactorization gLU;
+    LUFactorization shiftedLU;
+    double gamma;
+    double tolerance;
+    int maxDimension;
+
+    vector<double> propagate(const vector<double>& e, double h);
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Circuit.h"
+#include <complex>
+#include <vector>
+
+using namespace std;
+
+// Fast AC sweep for large linear circuits (AcSweepSettings::fastSweep). With the inductor
+// currents as extra unknowns the AC system is (G + sC) x = b, and the moments of x about an
+// expansion point s0 = j w0 span a Krylov space K0^-1 b, (K0^-1 C) K0^-1 b, ... with
+// K0 = G + s0 C. Their real and imaginary parts form a real basis V, and every frequency of
+// the sweep is solved for x = V z with z of a few dozen unknowns. The backward error of each
+// such solution in the full system decides where the next expansion point goes; points still
+// above tolerance after the last one are solved directly. solutions[i] belongs to
+// frequencies[i], as from the direct sweep.
+void fastFrequencySweep(const Circuit& circuit, const vector<double>& frequencies,
+                        vector<vector<complex<double>>>& solutions, AcSweepStats& stats);
@@ -1,17 +1,32 @@
 #pragma once
 
 #include "Component.h"
+#include <vector>
 
 class Inductor : public Component {
 public:
     double inductance;
     double current;
     double prevCurrent;
+    double prevPrevCurrent; // i(n-1), used by GEAR2
+    double prevVoltage;     // v(n), used by TRAPEZOIDAL
+    double prevVoltageDelta; // v(n) - v(n-1), for ringing detection
+    int ringingCount;
 
-    Inductor() : inductance(0.0), current(0.0), prevCurrent(0.0) {}
+    Inductor() : inductance(0.0), current(0.0), prevCurrent(0.0), prevPrevCurrent(0.0), prevVoltage(0.0), prevVoltageDelta(0.0), ringingCount(0) {}
 
     double getCurrent() override;
     double getVoltage() override;
-    void update(double dt);
+    // Same signature as Capacitor::update; the inductor history only needs the method
+    void update(double dt, IntegrationMethod method = IntegrationMethod::BACKWARD_EULER, double prev_dt = 0.0);
     void setInductorCurrent(double c);
-};
\ No newline at end of file
+    void resetHistory();
+    // Integration history (prevCurrent, prevPrevCurrent, prevVoltage, prevVoltageDelta,
+    // ringingCount) for saving and restoring a transient mid-run
+    vector<double> historyState() const;
+    void restoreHistoryState(const vector<double>& state);
+
+    // Companion model v = Req * i - Veq for the step being solved
+    double companionResistance(IntegrationMethod method, double dt, double prev_dt) const;
+    double companionVoltage(IntegrationMethod method, double dt, double prev_dt) const;
+};
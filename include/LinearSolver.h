@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <complex>
+#include <functional>
+#include <utility>
 
 using namespace std;
 
@@ -11,5 +13,86 @@ void display_vec(vector<double> a);
 
 void test_solver();
 
+// LU factorization with partial pivoting (row permutation in pivot), kept so that repeated
+// solves with an unchanged matrix only cost a forward/back substitution.
+struct LUFactorization {
+    vector<vector<double>> LU;
+    vector<int> pivot;
+};
+
+LUFactorization luFactorize(vector<vector<double>> A);
+vector<double> luSolve(const LUFactorization& lu, const vector<double>& b);
+
+struct ComplexLUFactorization {
+    vector<vector<complex<double>>> LU;
+    vector<int> pivot;
+};
+
+ComplexLUFactorization luFactorize(vector<vector<complex<double>>> A);
+vector<complex<double>> luSolve(const ComplexLUFactorization& lu, const vector<complex<double>>& b);
+
+// A^T x = b (plain transpose, no conjugation) from the factorization of A, as for the adjoint
+// systems of sensitivity analysis
+vector<double> luSolveTransposed(const LUFactorization& lu, const vector<double>& b);
+vector<complex<double>> luSolveTransposed(const ComplexLUFactorization& lu, const vector<complex<double>>& b);
+
+// Sparse LU for the large, very sparse matrices of extracted parasitic networks, which the
+// dense solver cannot even store. Pivots are chosen Markowitz-style: the column with the
+// fewest entries, and within it the sparsest row whose entry is at least a tenth of the
+// column's largest (threshold partial pivoting).
+class SparseLU {
+public:
+    // rows[i] lists the (column, value) entries of row i; duplicates are summed. Returns false
+    // if the matrix is singular.
+    bool factorize(int n, const vector<vector<pair<int, double>>>& rows);
+    vector<double> solve(const vector<double>& b) const;
+    size_t nonzeros() const; // entries of L and U together
+
+private:
+    struct Step {
+        int row;
+        int col;
+        double pivot;
+        vector<pair<int, double>> upper; // rest of the pivot row (column, value)
+        vector<pair<int, double>> lower; // multipliers (row, factor) applied below the pivot
+    };
+    vector<Step> steps;
+    int size = 0;
+};
+
+// GMRES (from x = 0, no restart) for A x = b where A is only available as a product, e.g. a
+// finite-difference Jacobian. Stops once ||b - A x|| <= tol * ||b|| or after maxIterations
+// products; the number of products used is returned through iterations.
+vector<double> gmres(const function<vector<double>(const vector<double>&)>& apply, const vector<double>& b,
+                     double tol, int maxIterations, int* iterations = nullptr);
+
+// exp(A) of a small dense matrix by the [6/6] Pade approximant with scaling and squaring
+vector<vector<double>> matrixExponential(const vector<vector<double>>& A);
+
+// Linear complementarity problem: z >= 0 with w = q + M z >= 0 and w^T z = 0, by Lemke's
+// complementary pivoting on a dense tableau. Finds a solution whenever one exists for M
+// positive semidefinite. Returns false on ray termination or after maxPivots pivots; the
+// number of pivots used is returned through pivots.
+bool solveLCP(const vector<vector<double>>& M, const vector<double>& q, vector<double>& z,
+              int maxPivots, int* pivots = nullptr);
+
+// Householder QR in place on a matrix with at least as many rows as `columns`: the first
+// `columns` columns become R (zeros below the diagonal) and any further columns are transformed
+// along, so [A b] leaves Q^T b in its last column.
+void householderQR(vector<vector<double>>& A, int columns);
+
+// min ||A x - b|| by Householder QR, with the columns scaled to unit length first; components
+// along columns that are dependent to roundoff are set to zero.
+vector<double> leastSquares(vector<vector<double>> A, const vector<double>& b);
+
+// Eigenvalues of a small dense real matrix: balancing, reduction to Hessenberg form and the
+// Francis double-shift QR iteration. Complex eigenvalues come in adjacent conjugate pairs.
+// Throws runtime_error if the iteration does not converge.
+vector<complex<double>> eigenvalues(vector<vector<double>> A);
+
 vector<complex<double>> gaussianElimination(vector<vector<complex<double>>> A, vector<complex<double>> b);
+// Same, overwriting A and b: a caller solving many systems of one size (an AC sweep) keeps
+// its buffers instead of copying them for every solve
+void gaussianEliminationInPlace(vector<vector<complex<double>>>& A, vector<complex<double>>& b,
+                                vector<complex<double>>& x);
 vector<double> gaussianElimination(vector<vector<double>> A, vector<double> b);
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Circuit.h"
+
+// Replaces every linear subnetwork with at least reductionSettings.minInternalNodes internal
+// nodes by a PRIMA macromodel (ReducedModel) and returns how many were replaced. The internal
+// unknowns x_i of a subnetwork are projected onto the block Krylov space of
+// (G_ii + s0 C_ii)^-1 C_ii started from the port inputs, and the congruence
+// V = blockdiag(I, X) keeps the port rows untouched, so the macromodel is passive and matches
+// the first `moments` block moments of the port admittance about s0. The reduced components
+// and internal nodes are removed from the circuit; nodes that must stay observable go in
+// reductionSettings.keepNodes.
+int reduceLinearSubnetworks(Circuit& circuit);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Circuit.h"
+#include "LinearSolver.h"
+#include <list>
+#include <vector>
+
+using namespace std;
+
+struct NewtonSettings {
+    int maxIterations = 100;
+    double relTol = 1e-3;
+    double voltageTol = 1e-6;  // absolute tolerance on node voltage / branch updates
+    double currentTol = 1e-12; // absolute tolerance on diode current agreement
+    double slowRatio = 0.5;    // refactor once |dx| shrinks slower than this per iteration
+    double bypassTol = 0.0;    // reuse a diode's last linearization within this relative change (0 = off)
+    int cacheEntries = 8;      // factorizations kept for recurring matrix stamp keys (0 = off)
+};
+
+struct NewtonStats {
+    long iterations = 0;
+    long factorizations = 0;
+    long solves = 0;
+    long failures = 0;
+    long cacheHits = 0;   // selectMatrix calls that found the key's factorization cached
+    long cacheMisses = 0; // and those that had to rebuild the matrix
+};
+
+// Newton-Raphson solver for the DC/transient MNA system with Shockley diodes. The linear part
+// comes from Circuit::set_MNA_A/set_MNA_RHS; each diode is linearized around its junction
+// voltage (with pnjlim limiting) and stamped on top. The factorization is kept between
+// iterations and between calls (modified Newton) and only refreshed when the linear part
+// changes or the iteration stops contracting fast enough.
+//
+// Switching circuits cycle through a few diode conduction patterns (and, with a fixed step,
+// a single step size), so the matrices of recently left stamp keys are kept in a small LRU
+// cache: returning to one restores its matrix and factorization instead of rebuilding them.
+// Each entry holds two dense n x n matrices, so settings.cacheEntries bounds the memory.
+class NewtonSolver {
+public:
+    NewtonSettings settings;
+    NewtonStats stats;
+
+    // Marks the linear matrix as stale and empties the cache (the circuit changed in a way the
+    // stamp key does not capture, or the solve must not depend on earlier factorizations)
+    void invalidate();
+
+    // Switches to the matrix of the given stamp key (step size, integration formula, ideal
+    // diode states), restoring it from the cache when it was used recently. A key selected
+    // with recurring = false (a one-off step size) is not cached when it is left, so it does
+    // not evict the entries of keys that come back.
+    void selectMatrix(const MatrixStampKey& key, bool recurring = true);
+
+    // Solves the system at the circuit's current time/step; x is the initial guess on entry and
+    // the solution on return. Returns false if the iteration did not converge.
+    bool solve(Circuit& circuit, AnalysisType type, vector<double>& x);
+
+private:
+    vector<vector<double>> linearMatrix;
+    LUFactorization lu;
+    bool linearValid = false;
+    bool factored = false;
+
+    struct CachedMatrix {
+        MatrixStampKey key;
+        vector<vector<double>> linearMatrix;
+        LUFactorization lu;
+        bool factored;
+    };
+    list<CachedMatrix> cache; // most recently left first
+    MatrixStampKey currentKey;
+    bool keyed = false;
+    bool currentRecurring = true;
+
+    void stampDiodes(Circuit& circuit, const vector<int>& n1, const vector<int>& n2,
+                     vector<vector<double>>& A, vector<double>& b) const;
+};
@@ -14,8 +14,6 @@ public:
 
     vector<pair<double, double>> voltage_history;
     vector<pair<double, double>> dc_sweep_history;
-    vector<pair<double, double>> ac_sweep_history;
-    vector<pair<double, double>> phase_sweep_history;
 
     Node();
     double getVoltage() const;
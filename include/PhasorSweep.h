@@ -0,0 +1,30 @@
+#pragma once
+
+#include <complex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Complex results of an AC or phase sweep: one row per sweep point (frequency in Hz, or source
+// phase in degrees) and one column per signal, stored row-major in a single block. Signals are
+// named "V(node)" for node voltages and "I(component)" for branch currents. Magnitude, dB and
+// phase are computed from the stored phasors when read.
+class PhasorSweep {
+public:
+    vector<double> sweep;
+    vector<string> signals;
+    vector<complex<double>> values; // sweep.size() x signals.size()
+
+    void reset(const vector<string>& signalNames);
+    void addPoint(double sweepValue, const vector<complex<double>>& point); // one value per signal
+    void clear();
+
+    size_t points() const { return sweep.size(); }
+    int signalIndex(const string& name) const; // -1 if there is no such signal
+
+    complex<double> phasor(size_t point, size_t signal) const { return values[point * signals.size() + signal]; }
+    double magnitude(size_t point, size_t signal) const;
+    double decibels(size_t point, size_t signal) const;      // 20 log10 |x|
+    double phaseDegrees(size_t point, size_t signal) const;  // arg x in (-180, 180]
+};
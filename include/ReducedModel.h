@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Component.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Passive reduced-order macromodel of a linear RC/RLC subnetwork (built by
+// reduceLinearSubnetworks). It keeps the subnetwork's port nodes and replaces everything inside
+// by a few internal states z, with C x' + G x = 0 over x = [v_ports; z]. The port rows add the
+// model's currents to the ports' KCL and the z rows become extra MNA variables. In transient, C
+// gets the same companion model as a capacitor (i = a C x(n+1) - Ieq).
+class ReducedModel {
+public:
+    string name;
+    vector<Node*> ports;
+    vector<vector<double>> G;
+    vector<vector<double>> C;
+    vector<double> states; // z at the last solution
+    int firstState = -1;   // extra-variable index of z[0], assigned with the diode branches
+
+    // Integration history over x: x(n), x(n-1) and the charge current C x'(n)
+    vector<double> prevX;
+    vector<double> prevPrevX;
+    vector<double> prevCurrent;
+
+    int stateCount() const { return static_cast<int>(G.size() - ports.size()); }
+    vector<double> unknowns() const; // x at the present port voltages and states
+
+    // Companion model i = a C x(n+1) - Ieq for the step being solved: the factor a and Ieq
+    double companionFactor(IntegrationMethod method, double dt, double prev_dt) const;
+    vector<double> companionCurrent(IntegrationMethod method, double dt, double prev_dt) const;
+    void update(double dt, IntegrationMethod method, double prev_dt);
+    void resetHistory();
+    // prevX, prevPrevX and prevCurrent back to back, for saving and restoring a transient
+    vector<double> historyState() const;
+    void restoreHistoryState(const vector<double>& state);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <complex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Rational model of some outputs with respect to one AC source, from transferFunctionAnalysis:
+// H(s) = sum_k r_k / (s - p_k) + d + s e for each output, all outputs sharing the poles p_k
+// (complex poles and their residues are stored with their conjugates, in adjacent pairs). Once
+// fitted the response at any frequency or time costs O(order) instead of a sweep.
+class TransferFunction {
+public:
+    string source;
+    vector<string> signals;
+    vector<complex<double>> poles;
+    vector<vector<complex<double>>> residues; // per signal, one per pole
+    vector<double> constants;                 // d per signal
+    vector<double> proportional;              // e per signal
+    double rmsError = 0.0; // worst output's RMS misfit over the samples, relative to its largest sample
+
+    // Vector fitting of samples[signal][i] taken at frequencies[i] (Hz) with `order` poles:
+    // starting from complex pairs spread over the band, the poles are relocated `iterations`
+    // times to the zeros of the fitted weighting function sigma(s) (unstable ones mirrored into
+    // the left half plane), then the residues are fitted to the final poles by least squares.
+    // Returns rmsError.
+    double fit(const vector<double>& frequencies, const vector<vector<complex<double>>>& samples, int order,
+               int iterations);
+    void clear();
+
+    size_t order() const { return poles.size(); }
+    int signalIndex(const string& name) const; // -1 if there is no such signal
+    complex<double> evaluate(size_t signal, double frequency) const;
+    // Impulse response at time >= 0, without the d delta(t) + e delta'(t) terms at t = 0
+    double impulseResponse(size_t signal, double time) const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Circuit.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Everything a transient needs to continue step for step from an accepted time point: the
+// circuit state, the step controller (fixed grid or adaptive step, LTE predictor history) and
+// the steady-state detector. Written at checkpoints and read back by resumeTransientAnalysis.
+struct TransientCheckpoint {
+    double time = 0.0;       // last accepted time
+    double t_step = 0.0;
+    double gridStart = 0.0;  // origin of the fixed t_step output grid
+    long gridIndex = 0;
+    double nextStep = 0.0;   // adaptive step to try next
+    double minStep = 0.0;
+    double maxStep = 0.0;
+    double nextCheckpoint = 0.0;
+
+    vector<double> solution; // last MNA solution, the Newton guess for the next step
+    vector<double> pastTimes;
+    vector<vector<double>> pastSolutions;
+    vector<double> detectorTimes;
+    vector<vector<double>> detectorSolutions;
+    double detectorSince = -1.0;
+
+    CircuitState state;
+    TransientStats stats;
+};
+
+// Compact binary snapshot in native byte order; doubles are stored bit for bit. The write goes
+// to a temporary file first, so an interrupted write leaves the previous checkpoint intact.
+// Both throw runtime_error on I/O errors or a file that is not a checkpoint.
+void writeTransientCheckpoint(const string& path, const TransientCheckpoint& checkpoint);
+TransientCheckpoint readTransientCheckpoint(const string& path);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.h"
+#include "Waveform.h"
 #include <vector>
 #include <utility>
 
@@ -9,6 +10,7 @@ public:
     double value;
     double current;
     bool diode = false;
+    Waveform waveform;
 
     vector<pair<double, double>> current_history;
     vector<pair<double, double>> dc_sweep_current_history;
@@ -21,6 +23,8 @@ public:
 
     double getVoltage() override;
 
+    double valueAt(double time) const;
+
     void addCurrentHistoryPoint(double time, double cur);
 
     void clearHistory();
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+enum class WaveformType {
+    DC,
+    SIN,
+    PULSE,
+    PWL,
+    EXP,
+    SAMPLED
+};
+
+// Time-dependent stimulus for independent sources in transient analysis (SPICE-style parameters).
+class Waveform {
+public:
+    WaveformType type;
+    vector<double> params;
+
+    Waveform() : type(WaveformType::DC), cursor(0) {}
+
+    // SIN(VO VA FREQ TD THETA PHASE)
+    static Waveform sine(double offset, double amplitude, double freq, double delay = 0.0, double damping = 0.0, double phase = 0.0);
+    // PULSE(V1 V2 TD TR TF PW PER)
+    static Waveform pulse(double v1, double v2, double delay, double rise, double fall, double width, double period);
+    // EXP(V1 V2 TD1 TAU1 TD2 TAU2)
+    static Waveform exponential(double v1, double v2, double delay1, double tau1, double delay2, double tau2);
+    // PWL(T1 V1 T2 V2 ...), times must be non-decreasing
+    static Waveform piecewiseLinear(const vector<double>& times, const vector<double>& values);
+    // Linear interpolation through simulated samples (e.g. a boundary node waveform). Unlike
+    // PWL its points are not breakpoints, since every sample would force a step and damping.
+    static Waveform sampled(const vector<double>& times, const vector<double>& values);
+
+    bool isTimeVarying() const;
+    double valueAt(double time, double dcValue) const;
+    // Earliest slope/value discontinuity strictly after the given time (infinity if none)
+    double nextBreakpoint(double after) const;
+    // Repetition period of an undamped SIN or a repeating PULSE (0 for other waveforms), and
+    // the time from which it repeats
+    double period() const;
+    double periodStart() const;
+
+private:
+    vector<double> pwlTimes;
+    vector<double> pwlValues;
+    mutable size_t cursor; // PWL segment of the last lookup; transient time only moves forward
+
+    double pwlValueAt(double time) const;
+};
@@ -1,21 +1,258 @@
 #include "Analysis.h"
 #include "LinearSolver.h"
 #include "Node.h"
+#include "BreakpointQueue.h"
+#include "NewtonSolver.h"
+#include "CircuitPartition.h"
+#include "DiodeLCP.h"
+#include "ExponentialIntegrator.h"
+#include "FastFrequencySweep.h"
+#include "TransientCheckpoint.h"
 #include <iostream>
 #include <vector>
 #include <iomanip>
 #include <cmath>
 #include <complex>
 #include <stdexcept>
+#include <algorithm>
+#include <map>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <exception>
 
 using namespace std;
 
 void result_from_vec(Circuit& circuit, const vector<double>& solvedVoltages, const vector<Node*>& nonGroundNodes);
+static bool integrateTransient(Circuit& circuit, double t_step, double t_start, double t_stop, bool detectSteadyState,
+                               const TransientCheckpoint* resume, bool checkpoints);
+
+// Newton solver kept across consecutive operating points (a DC sweep), which refactor only
+// when an ideal diode switches to a pattern not seen recently
+struct OperatingPointSolver {
+    NewtonSolver newton;
+    vector<double> x; // last solution, the initial guess of the next solve
+    bool converged = false;       // Newton and the ideal-diode states settled in the last solve
+    bool diodesConverged = false; // the ideal-diode states alone
+};
+
+// DC operating point from the present ideal-diode states. Shockley diodes are handled by
+// Newton inside each solve; the outer loop only settles the states of ideal diodes. Returns
+// false if the system is malformed; whether the solve converged is left in solver.converged.
+static bool solveOperatingPoint(Circuit& circuit, OperatingPointSolver& solver, const vector<Node*>& nonGroundNodes) {
+    const int MAX_DIODE_ITERATIONS = 100;
+    const double EPSILON_CURRENT = 1e-9;
+    bool converged = false;
+    bool newton_converged = false;
+    int iteration_count = 0;
+
+    do {
+        converged = true;
+        iteration_count++;
+
+        vector<DiodeState> previous_diode_states;
+        for (const auto& diode : circuit.diodes) {
+            previous_diode_states.push_back(diode.getState());
+        }
+
+        circuit.assignDiodeBranchIndices();
+        solver.newton.selectMatrix(circuit.matrixStampKey());
+
+        // Solve the system
+        newton_converged = solver.newton.solve(circuit, AnalysisType::DC, solver.x);
+
+        if (circuit.MNA_RHS.empty() || solver.x.size() != circuit.MNA_RHS.size()) {
+            cerr << "Error: MNA matrix is singular or malformed." << endl;
+            return false;
+        }
+        result_from_vec(circuit, solver.x, nonGroundNodes);
+
+        // Check if any diode has changed its state
+        for (size_t i = 0; i < circuit.diodes.size(); ++i) {
+            Diode& current_diode = circuit.diodes[i];
+            if (current_diode.getModel() == MODEL_SHOCKLEY) continue;
+            DiodeState old_state = previous_diode_states[i];
+            DiodeState new_state = old_state;
+
+            double v_diode_across = current_diode.node1->getVoltage() - current_diode.node2->getVoltage();
+
+            // A diode sitting exactly at its threshold stays off, so one of two parallel
+            // diodes the LCP left off is not switched on into a singular loop
+            if (old_state == STATE_OFF && v_diode_across > current_diode.getForwardVoltage() + EPSILON_CURRENT) {
+                new_state = STATE_FORWARD_ON;
+            } else if (old_state == STATE_OFF && current_diode.getDiodeType() == ZENER &&
+                       v_diode_across < -current_diode.getZenerVoltage() - EPSILON_CURRENT) {
+                new_state = STATE_REVERSE_ON;
+            } else if (old_state == STATE_FORWARD_ON && current_diode.getCurrent() < -EPSILON_CURRENT) {
+                new_state = STATE_OFF;
+            } else if (old_state == STATE_REVERSE_ON && current_diode.getCurrent() > EPSILON_CURRENT) {
+                new_state = STATE_OFF;
+            }
+
+            if (new_state != old_state) {
+                converged = false;
+                current_diode.setState(new_state);
+            }
+        }
+
+    } while (!converged && iteration_count < MAX_DIODE_ITERATIONS);
+
+    // A singular system gives non-finite voltages rather than a Newton failure
+    bool finite = all_of(solver.x.begin(), solver.x.end(), [](double v) { return isfinite(v); });
+    solver.diodesConverged = converged;
+    solver.converged = converged && newton_converged && finite;
+    return true;
+}
+
+// One homotopy method: the problem is deformed by parameter p (set through apply) and
+// followed from p = from to p = to. A converged step is passed to accepted and grows the next
+// step by half; a failed one is undone and retried with half the step. Returns true once the
+// problem at p = to has converged.
+static bool continuation(Circuit& circuit, OperatingPointSolver& solver, const vector<Node*>& nonGroundNodes,
+                         double from, double to, double step, double minStep,
+                         const function<void(double)>& apply, const function<void()>& accepted) {
+    HomotopyStats& stats = circuit.homotopyStats;
+    int budget = circuit.homotopySettings.maxSteps;
+    apply(from);
+    if (!solveOperatingPoint(circuit, solver, nonGroundNodes) || !solver.converged) {
+        stats.failedSteps++;
+        return false;
+    }
+    stats.steps++;
+    accepted();
+
+    double p = from;
+    double direction = to > from ? 1.0 : -1.0;
+    while (p != to && budget-- > 0) {
+        double next = fabs(to - p) <= step ? to : p + direction * step;
+        CircuitState state = circuit.captureState();
+        vector<double> x = solver.x;
+        apply(next);
+        if (solveOperatingPoint(circuit, solver, nonGroundNodes) && solver.converged) {
+            stats.steps++;
+            p = next;
+            step *= 1.5;
+            accepted();
+        } else {
+            stats.failedSteps++;
+            circuit.restoreState(state);
+            solver.x = x;
+            step *= 0.5;
+            if (step < minStep) {
+                return false;
+            }
+        }
+    }
+    return p == to;
+}
+
+static const char* homotopyMethodName(HomotopyMethod method) {
+    switch (method) {
+        case HomotopyMethod::GMIN_STEPPING: return "gmin stepping";
+        case HomotopyMethod::SOURCE_STEPPING: return "source stepping";
+        case HomotopyMethod::PSEUDO_TRANSIENT: return "pseudo-transient continuation";
+        default: return "plain Newton";
+    }
+}
+
+// Plain operating-point solve, falling back to homotopy continuation (HomotopySettings) when
+// it does not converge. Returns false if the system is malformed.
+static bool solveWithHomotopy(Circuit& circuit, OperatingPointSolver& solver, const vector<Node*>& nonGroundNodes) {
+    HomotopyStats& stats = circuit.homotopyStats;
+    stats.method = HomotopyMethod::NONE;
+    CircuitState start = circuit.captureState();
+    vector<double> x_start = solver.x;
+    if (!solveOperatingPoint(circuit, solver, nonGroundNodes)) {
+        return false;
+    }
+    if (solver.converged) {
+        return true;
+    }
+
+    const HomotopySettings& settings = circuit.homotopySettings;
+    if (!settings.enabled) {
+        if (!solver.diodesConverged) {
+            cerr << "Warning: DC analysis for diodes did not converge." << endl;
+        } else {
+            cerr << "Warning: Newton iteration did not converge in DC analysis." << endl;
+        }
+        return true;
+    }
+    stats.continuations++;
+
+    // Each method starts again from the state the plain solve started from
+    auto restart = [&]() {
+        circuit.restoreState(start);
+        solver.x = x_start;
+    };
+    auto finish = [&]() {
+        circuit.homotopyConductance = 0.0;
+        circuit.homotopyAnchor.clear();
+        circuit.sourceScale = 1.0;
+    };
+    auto solveTarget = [&]() {
+        finish();
+        if (!solveOperatingPoint(circuit, solver, nonGroundNodes) || !solver.converged) {
+            stats.failedSteps++;
+            return false;
+        }
+        stats.steps++;
+        return true;
+    };
+    auto nothing = []() {};
+    double decades = log10(settings.gminStart / settings.gminFinal);
+
+    // gmin stepping over log10 of the shunt conductance
+    restart();
+    auto setGmin = [&](double p) { circuit.homotopyConductance = pow(10.0, p); };
+    if (continuation(circuit, solver, nonGroundNodes, log10(settings.gminStart), log10(settings.gminFinal), 1.0,
+                     decades * 1e-3, setGmin, nothing) && solveTarget()) {
+        stats.method = HomotopyMethod::GMIN_STEPPING;
+    }
+
+    // Source stepping
+    if (stats.method == HomotopyMethod::NONE) {
+        restart();
+        finish();
+        auto setScale = [&](double p) { circuit.sourceScale = p; };
+        if (continuation(circuit, solver, nonGroundNodes, 0.0, 1.0, 0.1, settings.minSourceStep, setScale, nothing)) {
+            stats.method = HomotopyMethod::SOURCE_STEPPING;
+        }
+    }
+
+    // Pseudo-transient: the shunt pulls towards the last converged point and is relaxed
+    if (stats.method == HomotopyMethod::NONE) {
+        restart();
+        finish();
+        auto anchor = [&]() {
+            circuit.homotopyAnchor.assign(solver.x.begin(), solver.x.begin() + nonGroundNodes.size());
+        };
+        circuit.homotopyAnchor.assign(nonGroundNodes.size(), 0.0);
+        for (size_t i = 0; i < nonGroundNodes.size(); ++i) circuit.homotopyAnchor[i] = nonGroundNodes[i]->getVoltage();
+        auto setShunt = [&](double p) { circuit.homotopyConductance = pow(10.0, p); };
+        double first = log10(settings.pseudoTransientStart);
+        if (continuation(circuit, solver, nonGroundNodes, first, log10(settings.gminFinal), 0.5,
+                         (first - log10(settings.gminFinal)) * 1e-3, setShunt, anchor) && solveTarget()) {
+            stats.method = HomotopyMethod::PSEUDO_TRANSIENT;
+        }
+    }
+    finish();
+
+    if (stats.method == HomotopyMethod::NONE) {
+        stats.method = HomotopyMethod::FAILED;
+        cerr << "Warning: DC analysis did not converge, also with gmin stepping, source stepping and pseudo-transient continuation." << endl;
+    }
+    return true;
+}
 
 bool dcAnalysis(Circuit& circuit) {
     try {
         cout << "// Performing DC Analysis..." << endl;
         circuit.setDeltaT(1e12); // Treat capacitors as open, inductors as short
+        circuit.stepMethod = IntegrationMethod::BACKWARD_EULER;
+        circuit.time = 0.0; // Sources take their t=0 value at the operating point
         vector<Node*> nonGroundNodes;
         for (auto* node : circuit.nodes) {
             if (!node->isGround) {
@@ -23,124 +260,1702 @@ bool dcAnalysis(Circuit& circuit) {
             }
         }
 
-        const int MAX_DIODE_ITERATIONS = 100;
-        bool converged = false;
-        int iteration_count = 0;
-        const double EPSILON_CURRENT = 1e-9;
+        // A cached operating point of the same circuit is reused; one of the same topology
+        // with other values is the initial guess for Newton and the ideal-diode states
+        OperatingPointSolver solver;
+        circuit.homotopyStats = HomotopyStats();
+        OperatingPoint& cached = circuit.operatingPoint;
+        uint64_t topology = circuit.topologyHash();
+        uint64_t values = circuit.valueHash();
+        bool warm = circuit.reuseOperatingPoint && cached.valid && cached.topology == topology;
+        for (size_t i = 0; i < circuit.diodes.size(); ++i) {
+            Diode& diode = circuit.diodes[i];
+            diode.setState(warm ? cached.diodeStates[i] : STATE_OFF);
+            if (warm) {
+                diode.junctionVoltage = cached.junctionVoltages[i];
+                diode.setCurrent(cached.diodeCurrents[i]);
+            }
+        }
+        if (warm && cached.values == values) {
+            circuit.assignDiodeBranchIndices();
+            result_from_vec(circuit, cached.solution, nonGroundNodes);
+            cout << "// Reusing the operating point of the unchanged circuit." << endl;
+            cout << "// DC Analysis complete." << endl;
+            return true;
+        }
+        if (warm) {
+            solver.x = cached.solution;
+        }
+
+        // Ideal-diode states straight from the complementarity problem; the state loop of
+        // the solve then only confirms them
+        cached.valid = false;
+        DiodeLCP lcp;
+        if (lcp.prepare(circuit) && lcp.solve(circuit)) {
+            cout << "// Ideal diode states from the LCP in " << lcp.lastPivots << " pivots." << endl;
+        }
+        if (!solveWithHomotopy(circuit, solver, nonGroundNodes)) {
+            return false;
+        }
+        if (solver.converged) {
+            cached.valid = true;
+            cached.topology = topology;
+            cached.values = values;
+            cached.solution = solver.x;
+            cached.diodeStates.clear();
+            cached.diodeCurrents.clear();
+            cached.junctionVoltages.clear();
+            for (auto& diode : circuit.diodes) {
+                cached.diodeStates.push_back(diode.getState());
+                cached.diodeCurrents.push_back(diode.getCurrent());
+                cached.junctionVoltages.push_back(diode.junctionVoltage);
+            }
+        }
+        const HomotopyStats& homotopy = circuit.homotopyStats;
+        if (homotopy.method != HomotopyMethod::NONE && homotopy.method != HomotopyMethod::FAILED) {
+            cout << "// Operating point found by " << homotopyMethodName(homotopy.method) << " in "
+                 << homotopy.steps << " continuation steps." << endl;
+        }
+
+        cout << "// DC Analysis complete." << endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        cerr << "Critical error during DC Analysis: " << e.what() << endl;
+        return false;
+    }
+}
 
+// Local truncation error of the step just solved, estimated from the difference between the
+// corrector and a polynomial predictor through the previous accepted points. Returns the error
+// relative to relTol/absTol (<= 1 means acceptable), or 0 while there is not enough history.
+static double truncationErrorEstimate(IntegrationMethod method, double t_new, const vector<double>& x_new,
+                                      const vector<double>& past_times, const vector<vector<double>>& past_solutions,
+                                      const TransientSettings& settings) {
+    int order = (method == IntegrationMethod::BACKWARD_EULER) ? 1 : 2;
+    int points = order + 1;
+    int available = past_times.size();
+    if (available < points) {
+        return 0.0;
+    }
+    for (int j = available - points; j < available; ++j) {
+        if (past_solutions[j].size() != x_new.size()) return 0.0;
+    }
+
+    // Error constant of the corrector: BE 1/2, trapezoidal 1/12, Gear-2 2/9
+    double error_constant = 0.5;
+    if (method == IntegrationMethod::TRAPEZOIDAL) error_constant = 1.0 / 12.0;
+    if (method == IntegrationMethod::GEAR2) error_constant = 2.0 / 9.0;
+
+    // LTE ~= C * (k+1)! * h^(k+1) / prod(t_new - t_j) * (x_new - x_pred)
+    double h = t_new - past_times[available - 1];
+    double factorial = (order == 1) ? 2.0 : 6.0;
+    double denom = 1.0;
+    for (int j = available - points; j < available; ++j) {
+        denom *= (t_new - past_times[j]);
+    }
+    double scale = error_constant * factorial * pow(h, order + 1) / denom;
+
+    double err = 0.0;
+    for (size_t i = 0; i < x_new.size(); ++i) {
+        // Lagrange extrapolation of the previous points to t_new
+        double x_pred = 0.0;
+        for (int j = available - points; j < available; ++j) {
+            double w = 1.0;
+            for (int k = available - points; k < available; ++k) {
+                if (k != j) w *= (t_new - past_times[k]) / (past_times[j] - past_times[k]);
+            }
+            x_pred += w * past_solutions[j][i];
+        }
+        double tol = settings.relTol * max(fabs(x_new[i]), fabs(past_solutions[available - 1][i])) + settings.absTol;
+        err = max(err, scale * fabs(x_new[i] - x_pred) / tol);
+    }
+    return err;
+}
+
+// Switching function of an ideal diode evaluated on a solution vector of the current topology
+static double diodeSwitchingAt(const Circuit& circuit, const Diode& d, const vector<double>& x, size_t nodeCount) {
+    int a = circuit.getNodeMatrixIndex(d.node1);
+    int c = circuit.getNodeMatrixIndex(d.node2);
+    double v = (a != -1 ? x[a] : 0.0) - (c != -1 ? x[c] : 0.0);
+    double i = 0.0;
+    int b = d.getBranchIndex();
+    if (b != -1 && nodeCount + b < x.size()) {
+        i = x[nodeCount + b];
+    }
+    return d.switchingFunction(v, i);
+}
+
+// Fraction of the step at which the first ideal diode crosses its switching threshold, by
+// linear interpolation between the accepted state (still held by the nodes/diodes), or the
+// solution `from` when given, and x. Returns 2 if no diode crosses.
+static double earliestDiodeCrossing(Circuit& circuit, const vector<double>& x, size_t nodeCount,
+                                    const vector<double>* from = nullptr) {
+    const double SWITCH_TOL = 1e-9;
+    double theta = 2.0;
+    for (auto& d : circuit.diodes) {
+        if (d.getModel() != MODEL_IDEAL) continue;
+        double s1 = diodeSwitchingAt(circuit, d, x, nodeCount);
+        if (s1 <= SWITCH_TOL) continue;
+        double s0 = from ? diodeSwitchingAt(circuit, d, *from, nodeCount)
+                         : d.switchingFunction(d.node1->getVoltage() - d.node2->getVoltage(), d.getCurrent());
+        theta = min(theta, s0 < 0.0 ? s0 / (s0 - s1) : 0.0);
+    }
+    return theta;
+}
+
+static void switchCrossedDiodes(Circuit& circuit, const vector<double>& x, size_t nodeCount) {
+    const double SWITCH_TOL = 1e-9;
+    vector<DiodeState> next_states;
+    for (auto& d : circuit.diodes) {
+        DiodeState state = d.getState();
+        if (d.getModel() == MODEL_IDEAL && diodeSwitchingAt(circuit, d, x, nodeCount) > SWITCH_TOL) {
+            int a = circuit.getNodeMatrixIndex(d.node1);
+            int c = circuit.getNodeMatrixIndex(d.node2);
+            state = d.switchedState((a != -1 ? x[a] : 0.0) - (c != -1 ? x[c] : 0.0));
+        }
+        next_states.push_back(state);
+    }
+    for (size_t i = 0; i < circuit.diodes.size(); ++i) {
+        circuit.diodes[i].setState(next_states[i]);
+    }
+    circuit.assignDiodeBranchIndices();
+}
+
+// Common period of the periodic sources (AC sources, undamped SIN, repeating PULSE) and the
+// time from which all of them repeat. Returns 0 if there are none and -1 if their periods are
+// not all divisors of the longest one.
+static double commonSourcePeriod(const Circuit& circuit, double& start) {
+    vector<double> periods;
+    for (const auto& ac : circuit.acVoltageSources) {
+        if (ac.frequency > 0.0 && ac.magnitude != 0.0) periods.push_back(1.0 / ac.frequency);
+    }
+    auto add = [&](const Waveform& w) {
+        if (w.period() > 0.0) {
+            periods.push_back(w.period());
+            start = max(start, w.periodStart());
+        }
+    };
+    for (const auto& vs : circuit.voltageSources) add(vs.waveform);
+    for (const auto& cs : circuit.currentSources) add(cs.waveform);
+    if (periods.empty()) {
+        return 0.0;
+    }
+    double longest = *max_element(periods.begin(), periods.end());
+    for (double p : periods) {
+        double ratio = longest / p;
+        if (fabs(ratio - round(ratio)) > 1e-9 * ratio) return -1.0;
+    }
+    return longest;
+}
+
+// True once no non-periodic source has a breakpoint left in (t, t_stop] (it may still decay
+// smoothly, which the drift test covers)
+static bool aperiodicSourcesSettled(const Circuit& circuit, double t, double t_stop) {
+    auto settled = [&](const Waveform& w) {
+        return !w.isTimeVarying() || w.period() > 0.0 || w.nextBreakpoint(t) > t_stop;
+    };
+    for (const auto& vs : circuit.voltageSources) {
+        if (!settled(vs.waveform)) return false;
+    }
+    for (const auto& cs : circuit.currentSources) {
+        if (!settled(cs.waveform)) return false;
+    }
+    return true;
+}
+
+// Linear interpolation of accepted solutions (time ordered) at time; false if the solution
+// size changes across the bracket (ideal diodes switched)
+static bool interpolateSolution(const deque<pair<double, vector<double>>>& points, double time, vector<double>& x) {
+    for (size_t k = 0; k + 1 < points.size(); ++k) {
+        const auto& a = points[k];
+        const auto& b = points[k + 1];
+        if (b.first < time) continue;
+        if (a.second.size() != b.second.size()) return false;
+        double w = (b.first > a.first) ? (time - a.first) / (b.first - a.first) : 1.0;
+        x.resize(a.second.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] = a.second[i] + w * (b.second[i] - a.second[i]);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Change between two solutions, scaled by how often it would recur over the rest of the run,
+// relative to the steady-state tolerance (<= 1 means steady)
+static double steadyStateDrift(const vector<double>& x, const vector<double>& x_ref, double factor, const TransientSettings& settings) {
+    if (x.size() != x_ref.size()) {
+        return numeric_limits<double>::infinity();
+    }
+    double drift = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        double tol = settings.steadyStateRelTol * max(fabs(x[i]), fabs(x_ref[i])) + settings.steadyStateAbsTol;
+        drift = max(drift, factor * fabs(x[i] - x_ref[i]) / tol);
+    }
+    return drift;
+}
+
+// Completes the node histories after an early stop at t_end: the last period is repeated, or
+// the settled values are held, on the t_step grid (one final point in adaptive mode)
+static void fillSteadyStateOutput(Circuit& circuit, double t_end, double t_stop, double period, double t_step, double t_start) {
+    const double time_tol = 1e-9 * t_stop;
+    for (auto* node : circuit.nodes) {
+        if (node->isGround || node->voltage_history.empty()) continue;
+        auto& history = node->voltage_history;
+        if (period > 0.0) {
+            // Points of the last period (t_end - period, t_end], repeated shifted by k periods
+            size_t last = history.size();
+            size_t first = last - 1;
+            while (first > 0 && history[first - 1].first > t_end - period + time_tol) {
+                first--;
+            }
+            for (int k = 1; t_end + (k - 1) * period < t_stop - time_tol; ++k) {
+                for (size_t i = first; i < last; ++i) {
+                    double time = history[i].first + k * period;
+                    if (time > t_stop + time_tol) break;
+                    if (t_step > 0.0) {
+                        // Grid points stay exactly on the grid a full run would produce
+                        double grid = t_start + floor((time - t_start) / t_step + 0.5) * t_step;
+                        if (fabs(time - grid) <= time_tol) time = grid;
+                    }
+                    history.push_back({time, history[i].second});
+                }
+            }
+            if (history.back().first < t_stop - time_tol) {
+                // Close on t_stop, interpolated within the repeated period
+                double time = t_stop;
+                while (time > t_end) time -= period;
+                size_t i = first;
+                while (i + 1 < last && history[i + 1].first < time) ++i;
+                double value = history[i].second;
+                if (i + 1 < last && history[i + 1].first > history[i].first) {
+                    value += (history[i + 1].second - history[i].second) * (time - history[i].first) /
+                             (history[i + 1].first - history[i].first);
+                }
+                history.push_back({t_stop, value});
+            }
+        } else {
+            double value = history.back().second;
+            if (t_step > 0.0) {
+                for (long g = static_cast<long>(floor((t_end - t_start) / t_step + 0.5)) + 1; t_start + g * t_step < t_stop - time_tol; ++g) {
+                    history.push_back({t_start + g * t_step, value});
+                }
+            }
+            history.push_back({t_stop, value});
+        }
+        node->setVoltage(history.back().second);
+    }
+}
+
+// Transient of a linear circuit by exponential integration from the operating point at t = 0.
+// Steps end on the t_step grid and on source breakpoints, and the sources are taken as linear
+// across each step: exact for PWL and PULSE stimuli, while SIN/EXP/AC sources are sampled at
+// the output resolution. Returns false, with nothing recorded, if the circuit has no DC solution.
+static bool exponentialTransient(Circuit& circuit, double t_step, double t_stop) {
+    vector<Node*> nonGroundNodes;
+    for (auto* node : circuit.nodes) {
+        if (!node->isGround) nonGroundNodes.push_back(node);
+    }
+    const TransientSettings& settings = circuit.transientSettings;
+    circuit.assignDiodeBranchIndices();
+
+    vector<vector<double>> g, c;
+    circuit.descriptorSystem(g, c);
+    unique_ptr<ExponentialIntegrator> integrator;
+    try {
+        integrator.reset(new ExponentialIntegrator(g, c, t_step, settings.exponentialTol, settings.maxKrylovDimension));
+    } catch (const std::exception& e) {
+        cerr << "Warning: " << e.what() << " Using companion models." << endl;
+        return false;
+    }
+
+    BreakpointQueue breakpoints(circuit, t_stop);
+    const double time_tol = breakpoints.tolerance();
+    breakpoints.consumeThrough(0.0);
+
+    vector<double> b0 = circuit.sourceVector(0.0);
+    vector<double> x = integrator->operatingPoint(b0);
+    double t = 0.0;
+    long grid_index = 0;
+    while (t < t_stop - time_tol) {
+        double t_next = min((grid_index + 1) * t_step, t_stop);
+        if (t_next - t <= time_tol) {
+            grid_index++;
+            continue;
+        }
+        bool on_breakpoint = false;
+        if (breakpoints.next() <= t_next + time_tol) {
+            t_next = breakpoints.next();
+            on_breakpoint = true;
+        }
+        vector<double> b1 = circuit.sourceVector(t_next);
+        x = integrator->step(x, b0, b1, t_next - t);
+        b0 = b1;
+        t = t_next;
+        if (fabs(t - (grid_index + 1) * t_step) <= time_tol) {
+            t = (grid_index + 1) * t_step;
+            grid_index++;
+        }
+        if (on_breakpoint) {
+            breakpoints.consumeThrough(t);
+        }
+
+        circuit.time = t;
+        result_from_vec(circuit, x, nonGroundNodes);
+        for (auto* node : nonGroundNodes) {
+            node->addVoltageHistoryPoint(t, node->getVoltage());
+        }
+    }
+
+    const ExponentialStats& stats = integrator->stats;
+    circuit.transientStats.steps += stats.steps;
+    circuit.transientStats.factorizations += 2;
+    cout << "// Exponential integrator: " << stats.steps << " steps, " << stats.krylovVectors
+         << " Krylov vectors (dimension up to " << stats.maxDimension << ")." << endl;
+    return true;
+}
+
+// Work summary printed at the end of a transient run
+static void reportTransientRun(const Circuit& circuit) {
+    cout << "// Newton: " << circuit.transientStats.newtonIterations << " iterations, "
+         << circuit.transientStats.factorizations << " factorizations." << endl;
+    if (circuit.transientStats.cacheHits > 0) {
+        cout << "// Factorization cache: " << circuit.transientStats.cacheHits << " hits, "
+             << circuit.transientStats.cacheMisses << " misses." << endl;
+    }
+    if (circuit.transientStats.diodeEvents > 0) {
+        cout << "// Diode switching events: " << circuit.transientStats.diodeEvents << endl;
+    }
+    if (circuit.transientSettings.deviceBypass) {
+        cout << "// Device bypass: " << circuit.deviceActivity.bypassed << " of "
+             << circuit.deviceActivity.evaluated + circuit.deviceActivity.bypassed
+             << " Shockley diode evaluations skipped." << endl;
+    }
+    cout << "// Transient Analysis complete." << endl;
+}
+
+bool transientAnalysis(Circuit& circuit, double t_step, double t_stop) {
+    try {
+        cout << "// Performing Transient Analysis..." << endl;
+        circuit.clearComponentHistory();
+
+        // Run DC analysis to get initial conditions at t=0
+        if (!dcAnalysis(circuit)) {
+            cerr << "Initial DC analysis failed. Aborting transient analysis." << endl;
+            return false;
+        }
+
+        for (auto* node : circuit.nodes) {
+            if (!node->isGround) node->addVoltageHistoryPoint(0.0, node->getVoltage());
+        }
+
+        circuit.deviceActivity = DeviceActivity();
+        circuit.transientStats = TransientStats();
+        if (circuit.transientSettings.exponentialIntegrator) {
+            if (circuit.diodes.empty() && exponentialTransient(circuit, t_step, t_stop)) {
+                cout << "// Transient Analysis complete." << endl;
+                return true;
+            }
+            if (!circuit.diodes.empty()) {
+                cerr << "Warning: exponential integration needs a circuit without diodes; using companion models." << endl;
+            }
+        }
+        circuit.assignDiodeBranchIndices();
+        circuit.resetIntegrationHistory();
+        if (!integrateTransient(circuit, t_step, 0.0, t_stop, circuit.transientSettings.steadyStateStop, nullptr, true)) {
+            return false;
+        }
+        reportTransientRun(circuit);
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Transient Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool resumeTransientAnalysis(Circuit& circuit, const string& checkpointPath, double t_stop) {
+    try {
+        TransientCheckpoint checkpoint = readTransientCheckpoint(checkpointPath);
+        const CircuitState& state = checkpoint.state;
+        if (state.nodeVoltages.size() != circuit.nodes.size() ||
+            state.capacitorHistory.size() != circuit.capacitors.size() ||
+            state.inductorHistory.size() != circuit.inductors.size() ||
+            state.reducedModelHistory.size() != circuit.reducedModels.size() ||
+            state.diodeStates.size() != circuit.diodes.size()) {
+            cerr << "Checkpoint " << checkpointPath << " does not match the circuit." << endl;
+            return false;
+        }
+        if (t_stop <= checkpoint.time) {
+            cerr << "Checkpoint at t = " << checkpoint.time << " is already past t_stop = " << t_stop << "." << endl;
+            return false;
+        }
+        cout << "// Resuming Transient Analysis from t = " << checkpoint.time << "..." << endl;
+
+        circuit.restoreState(state);
+        circuit.deviceActivity = DeviceActivity();
+        circuit.transientStats = checkpoint.stats;
+        for (auto* node : circuit.nodes) {
+            if (node->isGround) continue;
+            auto& history = node->voltage_history;
+            while (!history.empty() && history.back().first > checkpoint.time) {
+                history.pop_back();
+            }
+            if (history.empty() || history.back().first < checkpoint.time) {
+                node->addVoltageHistoryPoint(checkpoint.time, node->getVoltage());
+            }
+        }
+
+        if (!integrateTransient(circuit, checkpoint.t_step, checkpoint.gridStart, t_stop,
+                                circuit.transientSettings.steadyStateStop, &checkpoint, true)) {
+            return false;
+        }
+        reportTransientRun(circuit);
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Transient Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool transientSegment(Circuit& circuit, double t_step, double t_start, double t_stop, bool keepHistory, bool detectSteadyState) {
+    // Without kept history the reactive history restarts from the present state, like the
+    // first step after DC
+    circuit.assignDiodeBranchIndices();
+    if (!keepHistory) {
+        circuit.resetIntegrationHistory();
+    }
+    return integrateTransient(circuit, t_step, t_start, t_stop, detectSteadyState, nullptr, false);
+}
+
+// Integrates from the circuit's present state at t_start, or from a checkpoint whose circuit
+// state has already been restored. With checkpoints, the run is written out every
+// TransientSettings::checkpointInterval of simulated time. Writing one drops the kept
+// factorization and diode linearizations, exactly as a resumed run starts without them, so a
+// run resumed from any checkpoint reproduces the original bit for bit.
+static bool integrateTransient(Circuit& circuit, double t_step, double t_start, double t_stop, bool detectSteadyState,
+                               const TransientCheckpoint* resume, bool checkpoints) {
+    try {
+        vector<Node*> nonGroundNodes;
+        for (auto* node : circuit.nodes) {
+            if (!node->isGround) {
+                nonGroundNodes.push_back(node);
+            }
+        }
+
+        const TransientSettings& settings = circuit.transientSettings;
+        const bool adaptive = settings.adaptiveStep;
+        double max_step = settings.maxStep > 0.0 ? settings.maxStep : max(t_step, t_stop / 50.0);
+        double min_step = settings.minStep > 0.0 ? settings.minStep : 1e-9 * t_stop;
+        if (resume) {
+            // A continuation keeps the original run's step limits and output grid
+            max_step = resume->maxStep;
+            min_step = resume->minStep;
+            t_step = resume->t_step;
+            t_start = resume->gridStart;
+        }
+
+        BreakpointQueue breakpoints(circuit, t_stop);
+        const double time_tol = breakpoints.tolerance();
+        breakpoints.consumeThrough(resume ? resume->time : t_start);
+
+        // Source waveforms only change the RHS, so the factorization is reused until the
+        // step size, integration formula or diode states change the matrix itself, and a
+        // recurring conduction pattern gets its factorization back from the solver's cache.
+        // With Shockley diodes each step is a Newton solve that keeps reusing it (modified Newton).
+        NewtonSolver newton;
+        newton.settings.bypassTol = circuit.bypassTolerance();
+        newton.settings.cacheEntries = settings.factorizationCacheEntries;
         for (auto& diode : circuit.diodes) {
-            diode.setState(STATE_OFF);
+            diode.stampValid = false;
         }
+        vector<double> solved_solution;
 
-        do {
-            converged = true;
-            iteration_count++;
+        // Accepted solutions since the last breakpoint, newest last, for the LTE predictor
+        vector<double> past_times;
+        vector<vector<double>> past_solutions;
+
+        double t = t_start;
+        double h = adaptive ? min(t_step, max_step) : t_step;
+        long grid_index = 0;
+        bool warned_min_step = false;
+        if (resume) {
+            t = resume->time;
+            h = resume->nextStep;
+            grid_index = resume->gridIndex;
+            solved_solution = resume->solution;
+            past_times = resume->pastTimes;
+            past_solutions = resume->pastSolutions;
+        }
+
+        const int MAX_EVENT_RESTARTS = 10;
+        const int MAX_EVENT_ITERATIONS = 8;
+        const double event_tol = 1e-4; // crossing located to this fraction of the step
+        int event_restarts = 0;
+        long diode_events = 0;
+
+        // Steady-state detection: with periodic sources the state is compared one period back,
+        // otherwise step to step; in both cases the drift is projected over the rest of the run
+        double ss_period = 0.0;
+        double ss_from = t_start;
+        bool ss_enabled = detectSteadyState;
+        if (ss_enabled) {
+            ss_period = commonSourcePeriod(circuit, ss_from);
+            if (settings.steadyStatePeriod > 0.0) ss_period = settings.steadyStatePeriod;
+            if (ss_period < 0.0) {
+                cerr << "Warning: sources have no common period; steady-state detection disabled." << endl;
+                ss_enabled = false;
+            }
+        }
+        deque<pair<double, vector<double>>> ss_points;  // accepted solutions over the last period
+        double ss_since = -1.0;                        // start of the current run of matching steps
+        bool stopped_early = false;
+        if (resume) {
+            for (size_t i = 0; i < resume->detectorTimes.size() && i < resume->detectorSolutions.size(); ++i) {
+                ss_points.push_back({resume->detectorTimes[i], resume->detectorSolutions[i]});
+            }
+            ss_since = resume->detectorSince;
+        }
+
+        const double checkpoint_interval = settings.checkpointInterval;
+        checkpoints = checkpoints && checkpoint_interval > 0.0 && !settings.checkpointPath.empty();
+        double next_checkpoint = resume ? resume->nextCheckpoint : t + checkpoint_interval;
+
+        // Solves the step t -> t + h_step from the last accepted state
+        auto solve_step = [&](double t_from, double h_step, vector<double>& x) {
+            circuit.setDeltaT(h_step);
+            circuit.selectStepMethod();
+            circuit.time = t_from + h_step;
+
+            // At a fixed step only the grid step recurs; event location, breakpoints and the
+            // rest of a grid interval give one-off step sizes that are kept out of the cache
+            newton.selectMatrix(circuit.matrixStampKey(), adaptive || h_step == t_step);
+            return newton.solve(circuit, AnalysisType::TRANSIENT, x);
+        };
+
+        while (t < t_stop - time_tol) {
+            // Fixed mode steps to the next grid point; both modes stop exactly on breakpoints
+            double h_try;
+            if (adaptive) {
+                h_try = min(h, t_stop - t);
+            } else {
+                h_try = min(t_start + (grid_index + 1) * t_step, t_stop) - t;
+                if (h_try <= time_tol) {
+                    grid_index++;
+                    continue;
+                }
+                if (fabs(h_try - t_step) <= time_tol) {
+                    h_try = t_step; // Keep the step bit-identical so the factorization stays valid
+                }
+            }
+            bool on_breakpoint = false;
+            double next_bp = breakpoints.next();
+            if (t + h_try >= next_bp - time_tol) {
+                h_try = next_bp - t;
+                on_breakpoint = true;
+            } else if (adaptive && next_bp - t < 2.0 * h_try) {
+                h_try = 0.5 * (next_bp - t); // Avoid leaving a sliver step in front of the breakpoint
+            }
 
-            vector<DiodeState> previous_diode_states;
+            vector<double> previous_solution = solved_solution;
+            vector<double> junction_voltages;
             for (const auto& diode : circuit.diodes) {
-                previous_diode_states.push_back(diode.getState());
+                junction_voltages.push_back(diode.junctionVoltage);
             }
+            auto restore_step_state = [&]() {
+                solved_solution = previous_solution;
+                for (size_t i = 0; i < circuit.diodes.size(); ++i) {
+                    circuit.diodes[i].junctionVoltage = junction_voltages[i];
+                }
+            };
 
-            circuit.assignDiodeBranchIndices();
-            circuit.set_MNA_A(AnalysisType::DC);
-            circuit.set_MNA_RHS(AnalysisType::DC);
+            if (!solve_step(t, h_try, solved_solution)) {
+                if (adaptive && h_try > min_step) {
+                    // Retry from the last accepted state with a quarter of the step
+                    restore_step_state();
+                    h = max(min_step, 0.25 * h_try);
+                    continue;
+                }
+                cerr << "Warning: Newton iteration did not converge at t = " << t + h_try << "." << endl;
+            }
+
+            // Ideal diodes: when one crosses its switching threshold inside the step, pin down
+            // the crossing and end the step there instead of shrinking the step globally
+            bool diode_event = false;
+            double theta = earliestDiodeCrossing(circuit, solved_solution, nonGroundNodes.size());
+            if (theta <= 1.0) {
+                if (theta * h_try <= time_tol) {
+                    if (event_restarts < MAX_EVENT_RESTARTS) {
+                        // Crossing right at the start: switch now and redo the step in the new topology
+                        switchCrossedDiodes(circuit, solved_solution, nonGroundNodes.size());
+                        restore_step_state();
+                        circuit.requestIntegrationDamping();
+                        event_restarts++;
+                        diode_events++;
+                        continue;
+                    }
+                    // Chattering between states: accept the step as solved
+                } else {
+                    // Regula falsi on the bracket [lo, hi]: the next trial is the crossing
+                    // interpolated between the bracket's solutions, moved event_margin past it
+                    // towards the end the last trial did not move, so that each trial tends to
+                    // close the bracket from the other side; bisection when that leaves it
+                    const double event_margin = 0.4 * event_tol;
+                    double lo = 0.0, hi = 1.0;
+                    vector<double> lo_solution, hi_solution = solved_solution;
+                    double frac = theta;
+                    for (int it = 0; it < MAX_EVENT_ITERATIONS && (hi - lo) * h_try > event_tol * h_try; ++it) {
+                        restore_step_state();
+                        solve_step(t, frac * h_try, solved_solution);
+                        bool crossed = earliestDiodeCrossing(circuit, solved_solution, nonGroundNodes.size(),
+                                                             lo_solution.empty() ? nullptr : &lo_solution) <= 1.0;
+                        if (crossed) {
+                            hi = frac;
+                            hi_solution = solved_solution;
+                        } else {
+                            lo = frac;
+                            lo_solution = solved_solution;
+                        }
+                        double sub = earliestDiodeCrossing(circuit, hi_solution, nonGroundNodes.size(),
+                                                           lo_solution.empty() ? nullptr : &lo_solution);
+                        frac = lo + min(sub, 1.0) * (hi - lo) + (crossed ? -event_margin : event_margin);
+                        if (frac <= lo || frac >= hi) frac = 0.5 * (lo + hi);
+                    }
+                    if (frac != hi) {
+                        restore_step_state();
+                        solve_step(t, hi * h_try, solved_solution);
+                    }
+                    h_try = hi * h_try;
+                    on_breakpoint = on_breakpoint && hi == 1.0;
+                    diode_event = true;
+                }
+            }
+
+            double err = 0.0;
+            int order = (circuit.stepMethod == IntegrationMethod::BACKWARD_EULER) ? 1 : 2;
+            if (adaptive && !diode_event) {
+                err = truncationErrorEstimate(circuit.stepMethod, t + h_try, solved_solution, past_times, past_solutions, settings);
+                if (err > 1.0 && h_try > min_step) {
+                    h = max(min_step, h_try * max(0.1, 0.9 * pow(err, -1.0 / (order + 1))));
+                    restore_step_state();
+                    continue; // Reject; component history is untouched until updateComponentStates()
+                }
+                if (err > 1.0 && !warned_min_step) {
+                    cerr << "Warning: transient step reached the minimum step at t = " << t << ", accepting error." << endl;
+                    warned_min_step = true;
+                }
+            }
+
+            t += h_try;
+            circuit.transientStats.steps++;
+            if (!adaptive && fabs(t - (t_start + (grid_index + 1) * t_step)) <= time_tol) {
+                t = t_start + (grid_index + 1) * t_step;
+            }
+            result_from_vec(circuit, solved_solution, nonGroundNodes);
+
+            for (auto* node : circuit.nodes) {
+                if (!node->isGround) node->addVoltageHistoryPoint(t, node->getVoltage());
+            }
+
+            circuit.updateComponentStates(); // Update prevVoltage/prevCurrent for next step
+
+            past_times.push_back(t);
+            past_solutions.push_back(solved_solution);
+            if (past_times.size() > 3) {
+                past_times.erase(past_times.begin());
+                past_solutions.erase(past_solutions.begin());
+            }
+            if (!adaptive && t == t_start + (grid_index + 1) * t_step) {
+                grid_index++;
+            }
+            event_restarts = 0;
+
+            if (diode_event) {
+                // Switch at the located crossing; the step size itself is kept
+                switchCrossedDiodes(circuit, solved_solution, nonGroundNodes.size());
+                diode_events++;
+                circuit.requestIntegrationDamping();
+                past_times.assign(1, t);
+                past_solutions.assign(1, solved_solution);
+            }
+
+            if (on_breakpoint) {
+                // The waveform has a corner here: restart the predictor, damp trapezoidal
+                // ringing and cut the step so the new slope is resolved before growing again
+                breakpoints.consumeThrough(t);
+                circuit.requestIntegrationDamping();
+                past_times.assign(1, t);
+                past_solutions.assign(1, solved_solution);
+                if (adaptive) {
+                    double gap = breakpoints.next() - t;
+                    h = max(min_step, 0.1 * min(h, gap));
+                }
+            } else if (adaptive) {
+                double growth = (err > 0.0) ? min(2.0, 0.9 * pow(err, -1.0 / (order + 1))) : 2.0;
+                h = min(max_step, max(min_step, h_try * growth));
+            }
+
+            if (ss_enabled && ss_period > 0.0) {
+                ss_points.push_back({t, solved_solution});
+                while (ss_points.size() > 2 && ss_points[1].first <= t - ss_period) {
+                    ss_points.pop_front();
+                }
+            }
+            // Steps ending on a breakpoint or a diode event neither confirm nor break a match
+            if (ss_enabled && !on_breakpoint && !diode_event) {
+                bool matches = false;
+                if (!aperiodicSourcesSettled(circuit, t, t_stop)) {
+                    matches = false;
+                } else if (ss_period > 0.0) {
+                    vector<double> x_back;
+                    if (t - ss_period >= ss_from && ss_points.front().first <= t - ss_period &&
+                        interpolateSolution(ss_points, t - ss_period, x_back)) {
+                        matches = steadyStateDrift(solved_solution, x_back, max(1.0, (t_stop - t) / ss_period), settings) <= 1.0;
+                    }
+                } else if (!previous_solution.empty()) {
+                    matches = steadyStateDrift(solved_solution, previous_solution, (t_stop - t) / h_try, settings) <= 1.0;
+                }
+                if (!matches) {
+                    ss_since = -1.0;
+                } else if (ss_since < 0.0) {
+                    ss_since = t;
+                }
+                // A periodic match must hold for a whole period, a settled one for a few steps
+                double hold = ss_period > 0.0 ? ss_period : 2.0 * h_try;
+                if (ss_since >= 0.0 && t - ss_since >= hold - time_tol && t < t_stop - time_tol) {
+                    stopped_early = true;
+                    break;
+                }
+            }
+
+            if (checkpoints && t >= next_checkpoint - time_tol && t < t_stop - time_tol) {
+                while (next_checkpoint <= t + time_tol) {
+                    next_checkpoint += checkpoint_interval;
+                }
+                TransientCheckpoint checkpoint;
+                checkpoint.time = t;
+                checkpoint.t_step = t_step;
+                checkpoint.gridStart = t_start;
+                checkpoint.gridIndex = grid_index;
+                checkpoint.nextStep = h;
+                checkpoint.minStep = min_step;
+                checkpoint.maxStep = max_step;
+                checkpoint.nextCheckpoint = next_checkpoint;
+                checkpoint.solution = solved_solution;
+                checkpoint.pastTimes = past_times;
+                checkpoint.pastSolutions = past_solutions;
+                for (const auto& point : ss_points) {
+                    checkpoint.detectorTimes.push_back(point.first);
+                    checkpoint.detectorSolutions.push_back(point.second);
+                }
+                checkpoint.detectorSince = ss_since;
+                checkpoint.state = circuit.captureState();
+                checkpoint.stats = circuit.transientStats;
+                checkpoint.stats.newtonIterations += newton.stats.iterations;
+                checkpoint.stats.factorizations += newton.stats.factorizations;
+                checkpoint.stats.cacheHits += newton.stats.cacheHits;
+                checkpoint.stats.cacheMisses += newton.stats.cacheMisses;
+                checkpoint.stats.diodeEvents += diode_events;
+                writeTransientCheckpoint(settings.checkpointPath, checkpoint);
+
+                newton.invalidate();
+                for (auto& diode : circuit.diodes) {
+                    diode.stampValid = false;
+                }
+            }
+        }
+
+        if (stopped_early) {
+            circuit.transientStats.earlyStopTime = t;
+            circuit.transientStats.earlyStopPeriodic = ss_period > 0.0;
+            fillSteadyStateOutput(circuit, t, t_stop, ss_period, adaptive ? 0.0 : t_step, t_start);
+            cout << "// Steady state (" << (ss_period > 0.0 ? "periodic" : "settled") << ") reached at t = " << t
+                 << "; output filled to t = " << t_stop << "." << endl;
+        }
+        circuit.transientStats.newtonIterations += newton.stats.iterations;
+        circuit.transientStats.factorizations += newton.stats.factorizations;
+        circuit.transientStats.cacheHits += newton.stats.cacheHits;
+        circuit.transientStats.cacheMisses += newton.stats.cacheMisses;
+        circuit.transientStats.diodeEvents += diode_events;
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Transient Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+
+// State a waveform-relaxation partition restarts from at the beginning of every sweep
+struct PartitionState {
+    CircuitState state;
+    vector<size_t> historySizes;
+};
+
+static PartitionState capturePartitionState(Circuit& circuit) {
+    PartitionState start;
+    start.state = circuit.captureState();
+    for (const auto* node : circuit.nodes) {
+        start.historySizes.push_back(node->voltage_history.size());
+    }
+    return start;
+}
+
+static void restorePartitionState(Circuit& circuit, const PartitionState& start) {
+    circuit.restoreState(start.state);
+    for (size_t i = 0; i < circuit.nodes.size(); ++i) {
+        circuit.nodes[i]->voltage_history.resize(start.historySizes[i]);
+    }
+}
+
+// Waveform of a node over the current window: the window start point followed by the points
+// the partition solved since then
+static Waveform windowWaveform(const Node* node, size_t historySize) {
+    vector<double> times, values;
+    for (size_t i = historySize - 1; i < node->voltage_history.size(); ++i) {
+        times.push_back(node->voltage_history[i].first);
+        values.push_back(node->voltage_history[i].second);
+    }
+    return Waveform::sampled(times, values);
+}
+
+bool waveformRelaxationAnalysis(Circuit& circuit, double t_step, double t_stop) {
+    try {
+        const RelaxationSettings& settings = circuit.relaxationSettings;
+        int requested = settings.partitions > 0 ? settings.partitions : static_cast<int>(thread::hardware_concurrency());
+
+        cout << "// Performing Waveform Relaxation Transient Analysis..." << endl;
+        circuit.clearComponentHistory();
+        if (!dcAnalysis(circuit)) {
+            cerr << "Initial DC analysis failed. Aborting transient analysis." << endl;
+            return false;
+        }
+        for (auto* node : circuit.nodes) {
+            if (!node->isGround) node->addVoltageHistoryPoint(0.0, node->getVoltage());
+        }
+
+        vector<CircuitPartition> parts = partitionCircuit(circuit, requested);
+        if (parts.size() < 2) {
+            cout << "// Circuit does not split into partitions; running a single transient." << endl;
+            return transientAnalysis(circuit, t_step, t_stop);
+        }
+        size_t cut = 0;
+        for (const auto& part : parts) {
+            cut += part.boundaryNodes.size();
+        }
+        cout << "// Waveform relaxation: " << parts.size() << " partitions, " << cut << " boundary waveforms." << endl;
+
+        circuit.deviceActivity = DeviceActivity();
+        circuit.transientStats = TransientStats();
+        for (auto& part : parts) {
+            for (auto* node : part.circuit->nodes) {
+                if (!node->isGround) node->addVoltageHistoryPoint(0.0, node->getVoltage());
+            }
+        }
+
+        // Which partition solves each node, so boundary waveforms can be read from the owner
+        map<string, int> ownerOf;
+        for (size_t p = 0; p < parts.size(); ++p) {
+            for (const string& name : parts[p].ownedNodes) {
+                ownerOf[name] = p;
+            }
+        }
+
+        double window = settings.windowLength > 0.0 ? settings.windowLength : t_stop / 10.0;
+        if (!circuit.transientSettings.adaptiveStep) {
+            window = max(1.0, round(window / t_step)) * t_step; // Windows end on the t_step grid
+        }
+        const double time_tol = 1e-9 * t_stop;
+        long sweeps = 0;
+        int unconverged_windows = 0;
+
+        double t0 = 0.0;
+        while (t0 < t_stop - time_tol) {
+            double t1 = (t_stop - (t0 + window) <= time_tol) ? t_stop : t0 + window;
+
+            vector<PartitionState> start;
+            for (auto& part : parts) {
+                start.push_back(capturePartitionState(*part.circuit));
+            }
+
+            // Initial guess: every boundary node holds its value from the start of the window
+            map<string, Waveform> waves;
+            for (auto& part : parts) {
+                for (const string& name : part.boundaryNodes) {
+                    if (waves.count(name)) continue;
+                    const Node* node = parts[ownerOf[name]].circuit->findNode(name);
+                    waves[name] = Waveform::sampled({t0}, {node->getVoltage()});
+                }
+            }
+
+            // Replaces the waveforms of the nodes partition p owns, returning the largest
+            // change relative to the tolerance (<= 1 means converged)
+            auto exchange = [&](size_t p) {
+                double change = 0.0;
+                Circuit& sub = *parts[p].circuit;
+                for (size_t i = 0; i < sub.nodes.size(); ++i) {
+                    const Node* node = sub.nodes[i];
+                    auto it = waves.find(node->name);
+                    if (node->isGround || it == waves.end() || ownerOf[node->name] != static_cast<int>(p)) continue;
+                    for (size_t k = start[p].historySizes[i]; k < node->voltage_history.size(); ++k) {
+                        const auto& point = node->voltage_history[k];
+                        double old_value = it->second.valueAt(point.first, 0.0);
+                        double tol = settings.relTol * max(fabs(point.second), fabs(old_value)) + settings.absTol;
+                        change = max(change, fabs(point.second - old_value) / tol);
+                    }
+                    it->second = windowWaveform(node, start[p].historySizes[i]);
+                }
+                return change;
+            };
+
+            // Runs on the Jacobi worker threads, which share waves: read it through a const
+            // reference only (operator[] may insert)
+            const map<string, Waveform>& boundary_waves = waves;
+            auto integrate = [&](size_t p, char& ok) {
+                CircuitPartition& part = parts[p];
+                restorePartitionState(*part.circuit, start[p]);
+                for (size_t i = 0; i < part.boundaryNodes.size(); ++i) {
+                    part.driver(i).waveform = boundary_waves.at(part.boundaryNodes[i]);
+                }
+                ok = transientSegment(*part.circuit, t_step, t0, t1);
+            };
+
+            bool converged = false;
+            for (int iteration = 0; iteration < settings.maxIterations && !converged; ++iteration) {
+                sweeps++;
+                vector<char> ok(parts.size(), 1);
+                double change = 0.0;
+                if (settings.gaussSeidel) {
+                    for (size_t p = 0; p < parts.size(); ++p) {
+                        integrate(p, ok[p]);
+                        change = max(change, exchange(p));
+                    }
+                } else {
+                    vector<thread> workers;
+                    for (size_t p = 0; p < parts.size(); ++p) {
+                        workers.emplace_back(integrate, p, ref(ok[p]));
+                    }
+                    for (auto& worker : workers) {
+                        worker.join();
+                    }
+                    for (size_t p = 0; p < parts.size(); ++p) {
+                        change = max(change, exchange(p));
+                    }
+                }
+                for (char partition_ok : ok) {
+                    if (!partition_ok) {
+                        cerr << "Error: partition transient failed in window [" << t0 << ", " << t1 << "]." << endl;
+                        return false;
+                    }
+                }
+                converged = change <= 1.0;
+            }
+            if (!converged) {
+                unconverged_windows++;
+            }
+
+            // Each node's waveform comes from the partition that solved it
+            for (size_t p = 0; p < parts.size(); ++p) {
+                Circuit& sub = *parts[p].circuit;
+                for (size_t i = 0; i < sub.nodes.size(); ++i) {
+                    const Node* node = sub.nodes[i];
+                    if (node->isGround || ownerOf[node->name] != static_cast<int>(p)) continue;
+                    Node* target = circuit.findNode(node->name);
+                    for (size_t k = start[p].historySizes[i]; k < node->voltage_history.size(); ++k) {
+                        target->addVoltageHistoryPoint(node->voltage_history[k].first, node->voltage_history[k].second);
+                    }
+                    target->setVoltage(node->getVoltage());
+                }
+            }
+            t0 = t1;
+        }
+
+        for (auto& part : parts) {
+            Circuit& sub = *part.circuit;
+            for (const auto& ind : sub.inductors) {
+                if (Inductor* target = circuit.findInductor(ind.name)) target->setInductorCurrent(ind.current);
+            }
+            for (auto& d : sub.diodes) {
+                if (Diode* target = circuit.findDiode(d.name)) {
+                    target->setState(d.getState());
+                    target->setCurrent(d.getCurrent());
+                }
+            }
+            circuit.transientStats.steps += sub.transientStats.steps;
+            circuit.transientStats.newtonIterations += sub.transientStats.newtonIterations;
+            circuit.transientStats.factorizations += sub.transientStats.factorizations;
+            circuit.transientStats.diodeEvents += sub.transientStats.diodeEvents;
+            circuit.deviceActivity.evaluated += sub.deviceActivity.evaluated;
+            circuit.deviceActivity.bypassed += sub.deviceActivity.bypassed;
+        }
+        circuit.assignDiodeBranchIndices();
+
+        cout << "// Waveform relaxation: " << sweeps << " sweeps, " << circuit.transientStats.steps
+             << " partition steps." << endl;
+        if (unconverged_windows > 0) {
+            cerr << "Warning: boundary waveforms did not converge in " << unconverged_windows << " window(s) within "
+                 << settings.maxIterations << " sweeps." << endl;
+        }
+        cout << "// Transient Analysis complete." << endl;
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Waveform Relaxation Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+// Parareal correction U = G(new) + F(old) - G(old) on the continuous state; discrete diode
+// states and linearization points are taken from the fine solution
+static CircuitState pararealCorrection(const CircuitState& coarse_new, const CircuitState& fine, const CircuitState& coarse_old) {
+    CircuitState corrected = fine;
+    for (size_t i = 0; i < corrected.nodeVoltages.size(); ++i) {
+        corrected.nodeVoltages[i] = coarse_new.nodeVoltages[i] + fine.nodeVoltages[i] - coarse_old.nodeVoltages[i];
+    }
+    for (size_t i = 0; i < corrected.inductorCurrents.size(); ++i) {
+        corrected.inductorCurrents[i] = coarse_new.inductorCurrents[i] + fine.inductorCurrents[i] - coarse_old.inductorCurrents[i];
+    }
+    return corrected;
+}
+
+// Largest change between two states relative to the tolerance (<= 1 means converged)
+static double stateChange(const CircuitState& a, const CircuitState& b, double relTol, double absTol) {
+    double change = 0.0;
+    for (size_t i = 0; i < a.nodeVoltages.size(); ++i) {
+        double tol = relTol * max(fabs(a.nodeVoltages[i]), fabs(b.nodeVoltages[i])) + absTol;
+        change = max(change, fabs(a.nodeVoltages[i] - b.nodeVoltages[i]) / tol);
+    }
+    for (size_t i = 0; i < a.inductorCurrents.size(); ++i) {
+        double tol = relTol * max(fabs(a.inductorCurrents[i]), fabs(b.inductorCurrents[i])) + absTol;
+        change = max(change, fabs(a.inductorCurrents[i] - b.inductorCurrents[i]) / tol);
+    }
+    return change;
+}
+
+bool pararealAnalysis(Circuit& circuit, double t_step, double t_stop) {
+    try {
+        const PararealSettings& settings = circuit.pararealSettings;
+        int slices = settings.slices > 0 ? settings.slices : static_cast<int>(thread::hardware_concurrency());
+        slices = max(1, min(slices, static_cast<int>(ceil(t_stop / t_step - 1e-9))));
+        int max_iterations = settings.maxIterations > 0 ? min(settings.maxIterations, slices) : slices;
+
+        cout << "// Performing Parareal Transient Analysis..." << endl;
+        auto wall_start = chrono::steady_clock::now();
+        circuit.clearComponentHistory();
+        if (!dcAnalysis(circuit)) {
+            cerr << "Initial DC analysis failed. Aborting transient analysis." << endl;
+            return false;
+        }
+        for (auto* node : circuit.nodes) {
+            if (!node->isGround) node->addVoltageHistoryPoint(0.0, node->getVoltage());
+        }
+        circuit.deviceActivity = DeviceActivity();
+        circuit.transientStats = TransientStats();
 
-            if (circuit.MNA_A.empty() || circuit.MNA_RHS.empty() || circuit.MNA_A.size() != circuit.MNA_RHS.size()) {
-                cerr << "Error: MNA matrix is singular or malformed." << endl;
-                return false;
-            }
+        // Slice boundaries on the t_step grid so the fine runs reproduce the serial grid
+        vector<double> bounds(slices + 1, t_stop);
+        for (int n = 0; n < slices; ++n) {
+            bounds[n] = round(n * t_stop / slices / t_step) * t_step;
+        }
 
-            // Solve the system
-            vector<double> solved_solution = gaussianElimination(circuit.MNA_A, circuit.MNA_RHS);
-            result_from_vec(circuit, solved_solution, nonGroundNodes);
+        vector<unique_ptr<Circuit>> fine;
+        for (int n = 0; n < slices; ++n) {
+            fine.push_back(circuit.clone());
+        }
+        unique_ptr<Circuit> coarse = circuit.clone();
+        coarse->setIntegrationMethod(IntegrationMethod::BACKWARD_EULER);
+        coarse->transientSettings.adaptiveStep = false;
+        coarse->transientSettings.deviceBypass = false;
 
-            // Check if any diode has changed its state
-            for (size_t i = 0; i < circuit.diodes.size(); ++i) {
-                Diode& current_diode = circuit.diodes[i];
-                DiodeState old_state = previous_diode_states[i];
-                DiodeState new_state = old_state;
+        auto propagateCoarse = [&](const CircuitState& from, int n) {
+            coarse->restoreState(from);
+            double h = (bounds[n + 1] - bounds[n]) / max(1, settings.coarseSteps);
+            if (!transientSegment(*coarse, h, bounds[n], bounds[n + 1])) {
+                throw runtime_error("coarse propagator failed");
+            }
+            for (auto* node : coarse->nodes) {
+                node->voltage_history.clear();
+            }
+            return coarse->captureState();
+        };
 
-                double v_diode_across = current_diode.node1->getVoltage() - current_diode.node2->getVoltage();
+        // U[n]: state at the start of slice n. The initial guess is a coarse sweep.
+        vector<CircuitState> start(slices + 1), coarse_end(slices);
+        start[0] = circuit.captureState();
+        double coarse_time = 0.0;
+        auto sweep_start = chrono::steady_clock::now();
+        for (int n = 0; n < slices; ++n) {
+            coarse_end[n] = propagateCoarse(start[n], n);
+            start[n + 1] = coarse_end[n];
+        }
+        coarse_time += chrono::duration<double>(chrono::steady_clock::now() - sweep_start).count();
 
-                if (old_state == STATE_OFF && v_diode_across >= current_diode.getForwardVoltage() - EPSILON_CURRENT) {
-                    new_state = STATE_FORWARD_ON;
-                } else if (old_state == STATE_FORWARD_ON && current_diode.getCurrent() < -EPSILON_CURRENT) {
-                    new_state = STATE_OFF;
+        vector<CircuitState> fine_end(slices);
+        vector<double> fine_time(slices, 0.0);
+        double critical_path = coarse_time;
+        int iterations = 0;
+        bool converged = false;
+        while (!converged && iterations < max_iterations) {
+            iterations++;
+            // Slices before the iteration count are already exact; only the rest are re-run
+            int first = iterations - 1;
+            vector<char> ok(slices, 1);
+            auto runFine = [&](int n) {
+                auto slice_start = chrono::steady_clock::now();
+                Circuit& c = *fine[n];
+                c.restoreState(start[n]);
+                for (auto* node : c.nodes) {
+                    node->voltage_history.clear();
                 }
-                
-                if (new_state != old_state) {
-                    converged = false;
-                    current_diode.setState(new_state);
+                ok[n] = transientSegment(c, t_step, bounds[n], bounds[n + 1]);
+                fine_end[n] = c.captureState();
+                fine_time[n] = chrono::duration<double>(chrono::steady_clock::now() - slice_start).count();
+            };
+            vector<thread> workers;
+            for (int n = first; n < slices; ++n) {
+                workers.emplace_back(runFine, n);
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            for (int n = first; n < slices; ++n) {
+                if (!ok[n]) {
+                    cerr << "Error: fine propagator failed on slice [" << bounds[n] << ", " << bounds[n + 1] << "]." << endl;
+                    return false;
                 }
             }
+            critical_path += *max_element(fine_time.begin() + first, fine_time.end());
 
-        } while (!converged && iteration_count < MAX_DIODE_ITERATIONS);
+            // Sequential correction sweep
+            converged = true;
+            sweep_start = chrono::steady_clock::now();
+            for (int n = first; n < slices; ++n) {
+                // start[first] is exact, so the first slice passes its fine result on unchanged
+                CircuitState next = fine_end[n];
+                if (n + 1 < slices && n > first) {
+                    CircuitState coarse_new = propagateCoarse(start[n], n);
+                    next = pararealCorrection(coarse_new, fine_end[n], coarse_end[n]);
+                    coarse_end[n] = coarse_new;
+                }
+                if (n + 1 < slices) {
+                    if (stateChange(next, start[n + 1], settings.relTol, settings.absTol) > 1.0) {
+                        converged = false;
+                    }
+                    start[n + 1] = next;
+                }
+            }
+            double sweep_time = chrono::duration<double>(chrono::steady_clock::now() - sweep_start).count();
+            coarse_time += sweep_time;
+            critical_path += sweep_time;
+        }
 
         if (!converged) {
-            cerr << "Warning: DC analysis for diodes did not converge after " << MAX_DIODE_ITERATIONS << " iterations." << endl;
+            cerr << "Warning: Parareal did not converge within " << max_iterations << " iterations." << endl;
         }
 
-        cout << "// DC Analysis complete." << endl;
-        return true;
+        // The fine slices of the last iteration start from the converged states
+        double serial_time = 0.0;
+        for (int n = 0; n < slices; ++n) {
+            Circuit& c = *fine[n];
+            for (size_t i = 0; i < c.nodes.size(); ++i) {
+                if (c.nodes[i]->isGround) continue;
+                for (const auto& point : c.nodes[i]->voltage_history) {
+                    circuit.nodes[i]->addVoltageHistoryPoint(point.first, point.second);
+                }
+            }
+            circuit.transientStats.steps += c.transientStats.steps;
+            circuit.transientStats.newtonIterations += c.transientStats.newtonIterations;
+            circuit.transientStats.factorizations += c.transientStats.factorizations;
+            circuit.transientStats.diodeEvents += c.transientStats.diodeEvents;
+            serial_time += fine_time[n];
+        }
+        circuit.restoreState(fine_end[slices - 1]);
 
+        PararealStats& stats = circuit.pararealStats;
+        stats.slices = slices;
+        stats.iterations = iterations;
+        stats.wallTime = chrono::duration<double>(chrono::steady_clock::now() - wall_start).count();
+        stats.estimatedSpeedup = critical_path > 0.0 ? serial_time / critical_path : 0.0;
+        cout << "// Parareal: " << slices << " slices, " << iterations << " iterations, estimated speedup "
+             << fixed << setprecision(2) << stats.estimatedSpeedup << defaultfloat << " on " << slices << " threads." << endl;
+        cout << "// Transient Analysis complete." << endl;
+        return true;
     } catch (const std::exception& e) {
-        cerr << "Critical error during DC Analysis: " << e.what() << endl;
+        cerr << "Critical error during Parareal Analysis: " << e.what() << endl;
         return false;
     }
 }
 
-bool transientAnalysis(Circuit& circuit, double t_step, double t_stop) {
+bool periodicSteadyStateAnalysis(Circuit& circuit, double t_step, double period) {
     try {
-        cout << "// Performing Transient Analysis..." << endl;
-        circuit.clearComponentHistory();
+        const SteadyStateSettings& settings = circuit.steadyStateSettings;
+        SteadyStateStats& stats = circuit.steadyStateStats;
+        stats = SteadyStateStats();
 
-        // Run DC analysis to get initial conditions at t=0
+        cout << "// Performing Periodic Steady-State Analysis..." << endl;
+        circuit.clearComponentHistory();
         if (!dcAnalysis(circuit)) {
-            cerr << "Initial DC analysis failed. Aborting transient analysis." << endl;
+            cerr << "Initial DC analysis failed. Aborting steady-state analysis." << endl;
             return false;
         }
+        circuit.deviceActivity = DeviceActivity();
+        circuit.transientStats = TransientStats();
 
-        for (auto& cap : circuit.capacitors) {
-            cap.prevVoltage = cap.getVoltage();
+        // Shooting unknowns: capacitor voltages and inductor currents together with the rest of
+        // the integration history (capacitor current / inductor voltage for the trapezoidal
+        // rule, the older point for Gear-2), so the fixed point is that of the integration
+        // formula itself rather than of a period restarted with backward Euler
+        const int HISTORY_VALUES = 3;
+        size_t size = HISTORY_VALUES * (circuit.capacitors.size() + circuit.inductors.size());
+        for (const auto& model : circuit.reducedModels) {
+            size += HISTORY_VALUES * model.G.size();
         }
-        for (auto& ind : circuit.inductors) {
-            ind.prevCurrent = ind.getCurrent();
+        if (size == 0) {
+            cout << "// Circuit has no reactive state; the steady state is a single period of transient." << endl;
         }
-        
-        vector<Node*> nonGroundNodes;
-        for (auto* node : circuit.nodes) {
-            if (!node->isGround) {
-                nonGroundNodes.push_back(node);
+
+        unique_ptr<Circuit> work = circuit.clone();
+        CircuitState base;
+        auto toVector = [&](const CircuitState& state) {
+            vector<double> x;
+            for (const auto& history : state.capacitorHistory) x.insert(x.end(), history.begin(), history.begin() + HISTORY_VALUES);
+            for (const auto& history : state.inductorHistory) x.insert(x.end(), history.begin(), history.begin() + HISTORY_VALUES);
+            for (const auto& history : state.reducedModelHistory) x.insert(x.end(), history.begin(), history.end());
+            return x;
+        };
+        auto fromVector = [&](const vector<double>& x) {
+            CircuitState state = base;
+            size_t k = 0;
+            for (auto& history : state.capacitorHistory) {
+                for (int j = 0; j < HISTORY_VALUES; ++j) history[j] = x[k++];
+            }
+            for (size_t i = 0; i < state.inductorHistory.size(); ++i) {
+                for (int j = 0; j < HISTORY_VALUES; ++j) state.inductorHistory[i][j] = x[k++];
+                state.inductorCurrents[i] = state.inductorHistory[i][0];
+            }
+            for (auto& history : state.reducedModelHistory) {
+                for (double& value : history) value = x[k++];
+            }
+            return state;
+        };
+        // One period of transient continuing from the state x: the shooting map Phi(x)
+        auto shoot = [&](const vector<double>& x, CircuitState* end) {
+            work->restoreState(fromVector(x));
+            for (auto* node : work->nodes) {
+                node->voltage_history.clear();
+            }
+            if (!transientSegment(*work, t_step, 0.0, period, true)) {
+                throw runtime_error("transient over one period failed");
             }
+            stats.periods++;
+            CircuitState state = work->captureState();
+            if (end) *end = state;
+            return toVector(state);
+        };
+        auto norm = [](const vector<double>& v) {
+            double sum = 0.0;
+            for (double x : v) sum += x * x;
+            return sqrt(sum);
+        };
+
+        // Warm-up from the operating point; the first period builds the integration history
+        if (!transientSegment(*work, t_step, 0.0, period)) {
+            throw runtime_error("transient over one period failed");
+        }
+        stats.periods++;
+        base = work->captureState();
+        vector<double> x = toVector(base);
+        for (int i = 1; i < settings.warmupPeriods; ++i) {
+            x = shoot(x, &base);
+        }
+
+        CircuitState steady_start;
+        while (size > 0 && stats.newtonIterations < settings.maxNewtonIterations) {
+            CircuitState end;
+            vector<double> fx = shoot(x, &end);
+            vector<double> r(size);
+            double err = 0.0;
+            for (size_t i = 0; i < size; ++i) {
+                r[i] = fx[i] - x[i];
+                double tol = settings.relTol * max(fabs(x[i]), fabs(fx[i])) + settings.absTol;
+                err = max(err, fabs(r[i]) / tol);
+            }
+            if (err <= 1.0) {
+                // The end of a periodic period is also its start, node voltages included
+                stats.converged = true;
+                steady_start = end;
+                break;
+            }
+            stats.newtonIterations++;
+
+            // (M - I) dx = -r with M = dPhi/dx applied as a forward difference
+            double eps = 1e-7 * (1.0 + norm(x));
+            auto apply = [&](const vector<double>& v) {
+                vector<double> xp(size);
+                for (size_t i = 0; i < size; ++i) xp[i] = x[i] + eps * v[i];
+                vector<double> fp = shoot(xp, nullptr);
+                vector<double> product(size);
+                for (size_t i = 0; i < size; ++i) product[i] = (fp[i] - fx[i]) / eps - v[i];
+                return product;
+            };
+            vector<double> rhs(size);
+            for (size_t i = 0; i < size; ++i) rhs[i] = -r[i];
+            int products = 0;
+            vector<double> dx = gmres(apply, rhs, settings.krylovTol, settings.maxKrylovIterations, &products);
+            stats.krylovIterations += products;
+            for (size_t i = 0; i < size; ++i) x[i] += dx[i];
+            base = end; // Diode states at the end of the period seed the next start
+        }
+        if (size == 0) {
+            stats.converged = true;
+            steady_start = base;
+        } else if (!stats.converged) {
+            steady_start = fromVector(x);
         }
 
+        // Record the steady-state period on the circuit itself
+        circuit.restoreState(steady_start);
         for (auto* node : circuit.nodes) {
             if (!node->isGround) node->addVoltageHistoryPoint(0.0, node->getVoltage());
         }
+        if (!transientSegment(circuit, t_step, 0.0, period, true)) {
+            return false;
+        }
+        stats.periods++;
 
-        circuit.setDeltaT(t_step);
-
-        for (double t = t_step; t <= t_stop; t += t_step) {
-            circuit.set_MNA_A(AnalysisType::TRANSIENT);
-            circuit.set_MNA_RHS(AnalysisType::TRANSIENT);
+        if (stats.converged) {
+            cout << "// Periodic steady state: " << stats.newtonIterations << " Newton iterations, "
+                 << stats.krylovIterations << " Krylov products, " << stats.periods << " periods simulated." << endl;
+        } else {
+            cerr << "Warning: shooting-Newton did not reach a periodic steady state within "
+                 << settings.maxNewtonIterations << " iterations." << endl;
+        }
+        cout << "// Periodic Steady-State Analysis complete." << endl;
+        return stats.converged;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Periodic Steady-State Analysis: " << e.what() << endl;
+        return false;
+    }
+}
 
-            vector<double> solved_solution = gaussianElimination(circuit.MNA_A, circuit.MNA_RHS);
-            result_from_vec(circuit, solved_solution, nonGroundNodes);
+// Solves the sweep points `values` of the named source on one circuit, each warm-started from
+// the one before, and appends them to the circuit's DC sweep histories. Returns false on failure.
+static bool sweepSegment(Circuit& circuit, const string& sourceName, const vector<double>& values) {
+    try {
+        VoltageSource* vs = circuit.findVoltageSource(sourceName);
+        CurrentSource* cs = vs ? nullptr : circuit.findCurrentSource(sourceName);
+        double& value = vs ? vs->value : cs->value;
+        circuit.setDeltaT(1e12);
+        circuit.stepMethod = IntegrationMethod::BACKWARD_EULER;
+        circuit.time = 0.0;
+        vector<Node*> nonGroundNodes;
+        for (auto* node : circuit.nodes) {
+            if (!node->isGround) nonGroundNodes.push_back(node);
+        }
+        for (auto& diode : circuit.diodes) {
+            diode.setState(STATE_OFF);
+        }
 
-            for (auto* node : circuit.nodes) {
-                if (!node->isGround) node->addVoltageHistoryPoint(t, node->getVoltage());
+        // The swept value only changes the RHS, so the LCP matrix is built once per segment
+        OperatingPointSolver solver;
+        DiodeLCP lcp;
+        bool lcpReady = lcp.prepare(circuit);
+        for (double v : values) {
+            value = v;
+            if (lcpReady) {
+                lcp.solve(circuit);
+            }
+            if (!solveWithHomotopy(circuit, solver, nonGroundNodes)) {
+                return false;
+            }
+            for (auto* node : nonGroundNodes) {
+                node->dc_sweep_history.push_back({v, node->getVoltage()});
+            }
+            for (auto& source : circuit.voltageSources) {
+                if (!source.diode) source.dc_sweep_current_history.push_back({v, source.getCurrent()});
             }
-
-            circuit.updateComponentStates(); // Update prevVoltage/prevCurrent for next step
         }
-        cout << "// Transient Analysis complete." << endl;
+        circuit.dcSweepStats.factorizations += solver.newton.stats.factorizations;
         return true;
     } catch (const std::exception& e) {
-        cerr << "Critical error during Transient Analysis: " << e.what() << endl;
+        cerr << "Error during DC sweep: " << e.what() << endl;
         return false;
     }
 }
 
+void dcSweepAnalysis(Circuit& circuit, const std::string& sourceName, double start, double end, double step) {
+    try {
+        cout << "// Performing DC Sweep Analysis..." << endl;
+        circuit.clearComponentHistory();
+        circuit.dcSweepStats = DcSweepStats();
+        circuit.homotopyStats = HomotopyStats();
+        VoltageSource* vs = circuit.findVoltageSource(sourceName);
+        CurrentSource* cs = vs ? nullptr : circuit.findCurrentSource(sourceName);
+        if (!vs && !cs) {
+            cerr << "Error: source '" << sourceName << "' not found." << endl;
+            return;
+        }
+        if (step <= 0.0) {
+            cerr << "Error: Sweep step must be positive." << endl;
+            return;
+        }
+
+        // Points from start towards end; the last one lands on end within roundoff
+        double direction = end >= start ? 1.0 : -1.0;
+        long count = static_cast<long>(floor(fabs(end - start) / step + 1e-9)) + 1;
+        vector<double> values(count);
+        for (long i = 0; i < count; ++i) {
+            values[i] = start + direction * i * step;
+        }
+
+        // The swept value stands in for the source's waveform during the sweep
+        double& value = vs ? vs->value : cs->value;
+        Waveform& waveform = vs ? vs->waveform : cs->waveform;
+        double saved_value = value;
+        Waveform saved_waveform = waveform;
+        waveform = Waveform();
+
+        const DcSweepSettings& settings = circuit.dcSweepSettings;
+        long segments = settings.segments > 0 ? settings.segments : static_cast<long>(thread::hardware_concurrency());
+        segments = max(1L, min(segments, count / max(1, settings.minSegmentPoints)));
+
+        bool ok = true;
+        if (segments == 1) {
+            ok = sweepSegment(circuit, sourceName, values);
+        } else {
+            vector<unique_ptr<Circuit>> parts;
+            vector<vector<double>> chunks;
+            for (long k = 0; k < segments; ++k) {
+                parts.push_back(circuit.clone());
+                chunks.emplace_back(values.begin() + k * count / segments, values.begin() + (k + 1) * count / segments);
+            }
+            vector<char> results(segments, 1);
+            vector<thread> workers;
+            for (long k = 0; k < segments; ++k) {
+                workers.emplace_back([&, k] { results[k] = sweepSegment(*parts[k], sourceName, chunks[k]); });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            for (long k = 0; k < segments; ++k) {
+                ok = ok && results[k];
+                const Circuit& part = *parts[k];
+                for (size_t i = 0; i < part.nodes.size(); ++i) {
+                    const auto& history = part.nodes[i]->dc_sweep_history;
+                    auto& target = circuit.nodes[i]->dc_sweep_history;
+                    target.insert(target.end(), history.begin(), history.end());
+                }
+                for (size_t i = 0; i < part.voltageSources.size(); ++i) {
+                    const auto& history = part.voltageSources[i].dc_sweep_current_history;
+                    auto& target = circuit.voltageSources[i].dc_sweep_current_history;
+                    target.insert(target.end(), history.begin(), history.end());
+                }
+                circuit.dcSweepStats.factorizations += part.dcSweepStats.factorizations;
+                circuit.homotopyStats.continuations += part.homotopyStats.continuations;
+                circuit.homotopyStats.steps += part.homotopyStats.steps;
+                circuit.homotopyStats.failedSteps += part.homotopyStats.failedSteps;
+            }
+            // Leave the circuit at the last point, as the serial sweep does
+            circuit.restoreState(parts.back()->captureState());
+            for (size_t i = 0; i < circuit.voltageSources.size(); ++i) {
+                circuit.voltageSources[i].setCurrent(parts.back()->voltageSources[i].getCurrent());
+            }
+        }
+        value = saved_value;
+        waveform = saved_waveform;
+
+        DcSweepStats& stats = circuit.dcSweepStats;
+        stats.points = ok ? count : 0;
+        stats.segments = segments;
+        if (!ok) {
+            cerr << "Error: DC sweep of " << sourceName << " failed." << endl;
+            return;
+        }
+        cout << "// DC sweep: " << count << " points, " << stats.factorizations << " factorizations on "
+             << segments << (segments == 1 ? " thread." : " threads.") << endl;
+        cout << "// DC Sweep Analysis complete." << endl;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during DC Sweep: " << e.what() << endl;
+    }
+}
+
+// Signals recorded by the AC and phase sweeps: every node voltage, then the branch currents
+// of the AC sources (MNA unknowns) and of the inductors (from their terminal voltages)
+struct PhasorSignals {
+    vector<string> names;
+    size_t nodes = 0;
+    size_t sources = 0;
+    vector<pair<int, int>> inductorNodes;
+    vector<double> inductances;
+
+    explicit PhasorSignals(const Circuit& circuit) {
+        for (const auto* node : circuit.nodes) {
+            if (!node->isGround) names.push_back("V(" + node->name + ")");
+        }
+        nodes = names.size();
+        for (const auto& source : circuit.acVoltageSources) names.push_back("I(" + source.name + ")");
+        sources = circuit.acVoltageSources.size();
+        for (const auto& inductor : circuit.inductors) {
+            names.push_back("I(" + inductor.name + ")");
+            inductorNodes.push_back({circuit.getNodeMatrixIndex(inductor.node1), circuit.getNodeMatrixIndex(inductor.node2)});
+            inductances.push_back(inductor.inductance);
+        }
+    }
+
+    void point(double frequency, const vector<complex<double>>& solution, vector<complex<double>>& out) const {
+        out.assign(solution.begin(), solution.begin() + min(solution.size(), nodes + sources));
+        out.resize(nodes + sources, {0.0, 0.0});
+        complex<double> jw(0.0, 2.0 * M_PI * frequency);
+        for (size_t k = 0; k < inductances.size(); ++k) {
+            complex<double> v1 = inductorNodes[k].first != -1 ? solution[inductorNodes[k].first] : 0.0;
+            complex<double> v2 = inductorNodes[k].second != -1 ? solution[inductorNodes[k].second] : 0.0;
+            out.push_back((v1 - v2) / (jw * inductances[k]));
+        }
+    }
+};
+
+// Solves the AC system at every frequency, solutions[i] belonging to frequencies[i]. The
+// points are split into contiguous blocks over AcSweepSettings::threads workers, each
+// assembling and solving in its own buffers; the circuit is only read. The right-hand side
+// comes from the AC sources unless an excitation is given. Returns the number of threads used.
+static int solveACPoints(const Circuit& circuit, const vector<double>& frequencies,
+                         vector<vector<complex<double>>>& solutions,
+                         const vector<complex<double>>* excitation = nullptr) {
+    const AcSweepSettings& settings = circuit.acSweepSettings;
+    long count = frequencies.size();
+    long threads = settings.threads > 0 ? settings.threads : static_cast<long>(thread::hardware_concurrency());
+    threads = max(1L, min(threads, count / max(1, settings.minThreadPoints)));
+    solutions.assign(count, {});
+
+    // Only the pencil's frequency weights change from point to point, and the phasors not at all
+    const AcPencil pencil = circuit.acPencil();
+    vector<complex<double>> rhs;
+    if (excitation) {
+        rhs = *excitation;
+    } else {
+        circuit.acRHS(rhs);
+    }
+    auto solveRange = [&](long first, long last) {
+        vector<vector<complex<double>>> A;
+        vector<complex<double>> b;
+        for (long i = first; i < last; ++i) {
+            pencil.assemble(frequencies[i], A);
+            b = rhs;
+            gaussianEliminationInPlace(A, b, solutions[i]);
+        }
+    };
+
+    if (threads == 1) {
+        solveRange(0, count);
+        return 1;
+    }
+    vector<exception_ptr> errors(threads);
+    vector<thread> workers;
+    for (long k = 0; k < threads; ++k) {
+        workers.emplace_back([&, k] {
+            try {
+                solveRange(k * count / threads, (k + 1) * count / threads);
+            } catch (...) {
+                errors[k] = current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+    return threads;
+}
+
+// Adaptive sampling of [start_freq, stop_freq] with at most budget points (AcSweepSettings).
+// Each pass estimates, for every interval, how far the straight line between its end points is
+// from the quadratic (in log frequency) through them and a neighbour, for every node voltage,
+// relative to the larger end value (with a floor of 1e-6 of the largest response anywhere so
+// that negligible signals do not drive the refinement). The worst intervals are bisected in
+// one batch of parallel solves. Returns the threads used; frequencies come out sorted and the
+// number of refinement passes goes to passes.
+static int adaptiveACPoints(const Circuit& circuit, double start_freq, double stop_freq, int budget,
+                            vector<double>& frequencies, vector<vector<complex<double>>>& solutions, int& passes) {
+    const AcSweepSettings& settings = circuit.acSweepSettings;
+    int initial = max(2, min(settings.adaptiveInitialPoints, budget));
+    double x0 = log10(start_freq), x1 = log10(stop_freq);
+    frequencies.clear();
+    for (int i = 0; i < initial; ++i) {
+        frequencies.push_back(pow(10.0, x0 + i * (x1 - x0) / (initial - 1)));
+    }
+    int threads = solveACPoints(circuit, frequencies, solutions);
+    size_t nodes = circuit.countNonGroundNodes();
+    const double MIN_WIDTH = 1e-9; // decades; intervals this narrow are not split further
+
+    passes = 0;
+    while (static_cast<int>(frequencies.size()) < budget) {
+        size_t count = frequencies.size();
+        vector<double> x(count);
+        for (size_t i = 0; i < count; ++i) x[i] = log10(frequencies[i]);
+        double peak = 0.0;
+        for (const auto& solution : solutions) {
+            for (size_t s = 0; s < nodes && s < solution.size(); ++s) peak = max(peak, abs(solution[s]));
+        }
+        double floor = 1e-6 * peak;
+
+        // Quadratic through points a, a+1, a+2 evaluated at xm
+        auto quadratic = [&](size_t a, size_t s, double xm) {
+            complex<double> sum = 0.0;
+            for (size_t k = a; k < a + 3; ++k) {
+                double weight = 1.0;
+                for (size_t l = a; l < a + 3; ++l) {
+                    if (l != k) weight *= (xm - x[l]) / (x[k] - x[l]);
+                }
+                sum += weight * solutions[k][s];
+            }
+            return sum;
+        };
+        vector<pair<double, size_t>> refine; // (error, interval)
+        for (size_t i = 0; i + 1 < count; ++i) {
+            if (x[i + 1] - x[i] < MIN_WIDTH || count < 3) continue;
+            double xm = 0.5 * (x[i] + x[i + 1]);
+            double error = 0.0;
+            for (size_t s = 0; s < nodes && s < solutions[i].size(); ++s) {
+                complex<double> line = 0.5 * (solutions[i][s] + solutions[i + 1][s]);
+                double scale = max(abs(solutions[i][s]), abs(solutions[i + 1][s])) + floor;
+                if (scale <= 0.0) continue;
+                if (i > 0) error = max(error, abs(quadratic(i - 1, s, xm) - line) / scale);
+                if (i + 2 < count) error = max(error, abs(quadratic(i, s, xm) - line) / scale);
+            }
+            if (error > settings.adaptiveTol) refine.push_back({error, i});
+        }
+        if (refine.empty()) break;
+
+        size_t room = budget - count;
+        if (refine.size() > room) {
+            partial_sort(refine.begin(), refine.begin() + room, refine.end(), greater<pair<double, size_t>>());
+            refine.resize(room);
+        }
+        vector<double> added;
+        for (const auto& entry : refine) {
+            size_t i = entry.second;
+            added.push_back(sqrt(frequencies[i] * frequencies[i + 1]));
+        }
+        vector<vector<complex<double>>> added_solutions;
+        solveACPoints(circuit, added, added_solutions);
+        passes++;
+
+        vector<size_t> order(count + added.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        auto frequency = [&](size_t k) { return k < count ? frequencies[k] : added[k - count]; };
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return frequency(a) < frequency(b); });
+        vector<double> merged;
+        vector<vector<complex<double>>> merged_solutions;
+        for (size_t k : order) {
+            merged.push_back(frequency(k));
+            merged_solutions.push_back(std::move(k < count ? solutions[k] : added_solutions[k - count]));
+        }
+        frequencies = std::move(merged);
+        solutions = std::move(merged_solutions);
+    }
+    return threads;
+}
 
 // --- Wrapped in a safety block ---
 int acSweepAnalysis(Circuit& circuit, const std::string& sourceName, double start_freq, double stop_freq, int num_points, const std::string& sweep_type) {
@@ -153,13 +1968,20 @@ int acSweepAnalysis(Circuit& circuit, const std::string& sourceName, double star
             return 0;
         }
 
-        vector<Node*> nonGroundNodes;
-        for (auto* node : circuit.nodes) {
-            if (!node->isGround) nonGroundNodes.push_back(node);
+        circuit.acSweepStats = AcSweepStats();
+        vector<double> frequencies;
+        vector<vector<complex<double>>> solutions;
+        int threads = 1;
+        bool adaptive = sweep_type == "Adaptive";
+        if (adaptive && (start_freq <= 0.0 || stop_freq <= start_freq)) {
+            cerr << "Error: Adaptive AC sweep needs 0 < start frequency < stop frequency." << endl;
+            return 0;
         }
-        
-        int pointsCalculated = 0;
-        for (int i = 0; i < num_points; ++i) {
+        if (!adaptive && sweep_type != "Linear" && num_points > 1 && (start_freq <= 0.0 || stop_freq <= 0.0)) {
+            cerr << "Error: Decade AC sweep needs positive start and stop frequencies." << endl;
+            return 0;
+        }
+        for (int i = 0; i < num_points && !adaptive; ++i) {
             double current_freq;
             if (num_points == 1) {
                 current_freq = start_freq;
@@ -168,20 +1990,45 @@ int acSweepAnalysis(Circuit& circuit, const std::string& sourceName, double star
             } else { // Logarithmic (Decade)
                 current_freq = start_freq * pow(10.0, i / (double)(num_points - 1) * log10(stop_freq / start_freq));
             }
-            
-            if (current_freq <= 0) continue;
-
-            circuit.set_MNA_A(AnalysisType::AC_SWEEP, current_freq);
-            circuit.set_MNA_RHS(AnalysisType::AC_SWEEP, current_freq);
 
-            vector<complex<double>> solution = gaussianElimination(circuit.MNA_A_Complex, circuit.MNA_RHS_Complex);
+            // Inductors have no AC admittance at 0 Hz, so a linear sweep from DC skips it
+            if (current_freq <= 0) continue;
+            frequencies.push_back(current_freq);
+        }
 
-            for (size_t j = 0; j < nonGroundNodes.size(); ++j) {
-                if(j < solution.size()) {
-                    nonGroundNodes[j]->ac_sweep_history.push_back({current_freq, abs(solution[j])});
-                }
-            }
-            pointsCalculated++;
+        // Points are solved concurrently and recorded in frequency order afterwards
+        if (adaptive) {
+            threads = adaptiveACPoints(circuit, start_freq, stop_freq, num_points, frequencies, solutions,
+                                       circuit.acSweepStats.refinementPasses);
+        } else if (circuit.acSweepSettings.fastSweep) {
+            fastFrequencySweep(circuit, frequencies, solutions, circuit.acSweepStats);
+        } else {
+            threads = solveACPoints(circuit, frequencies, solutions);
+        }
+        PhasorSignals signals(circuit);
+        PhasorSweep& results = circuit.acSweepResults;
+        results.reset(signals.names);
+        results.sweep.reserve(frequencies.size());
+        results.values.reserve(frequencies.size() * signals.names.size());
+        vector<complex<double>> point;
+        for (size_t i = 0; i < frequencies.size(); ++i) {
+            signals.point(frequencies[i], solutions[i], point);
+            results.addPoint(frequencies[i], point);
+        }
+        int pointsCalculated = frequencies.size();
+        circuit.acSweepStats.points = pointsCalculated;
+        circuit.acSweepStats.threads = threads;
+        cout << "// AC sweep: " << pointsCalculated << " points on " << threads
+             << (threads == 1 ? " thread" : " threads");
+        if (adaptive) {
+            cout << ", " << circuit.acSweepStats.refinementPasses << " refinement passes";
+        }
+        cout << "." << endl;
+        if (!adaptive && circuit.acSweepSettings.fastSweep) {
+            const AcSweepStats& stats = circuit.acSweepStats;
+            cout << "// Fast sweep: reduced model of order " << stats.reducedOrder << " from "
+                 << stats.expansionPoints << " expansion points; " << stats.directPoints
+                 << " points solved directly." << endl;
         }
         cout << "// AC Sweep Analysis complete." << endl;
         return pointsCalculated;
@@ -201,28 +2048,30 @@ int phaseSweepAnalysis(Circuit& circuit, const std::string& sourceName, double b
             return 0;
         }
 
-        vector<Node*> nonGroundNodes;
-        for (auto* node : circuit.nodes) {
-            if (!node->isGround) nonGroundNodes.push_back(node);
+        if (base_freq <= 0.0) {
+            cerr << "Error: Phase sweep needs a positive frequency." << endl;
+            return 0;
         }
 
         double originalPhase = acSource->phase; // Save original phase
         int pointsCalculated = 0;
+        PhasorSignals signals(circuit);
+        PhasorSweep& results = circuit.phaseSweepResults;
+        results.reset(signals.names);
+        vector<complex<double>> point;
 
+        // The frequency is fixed, so the matrix is assembled once and only the RHS follows the phase
+        circuit.set_MNA_A(AnalysisType::AC_SWEEP, base_freq);
         for (int i = 0; i < num_points; ++i) {
             double current_phase = (num_points == 1) ? start_phase : start_phase + i * (stop_phase - start_phase) / (num_points - 1);
             acSource->phase = current_phase;
 
-            circuit.set_MNA_A(AnalysisType::AC_SWEEP, base_freq);
             circuit.set_MNA_RHS(AnalysisType::AC_SWEEP, base_freq);
 
             vector<complex<double>> solution = gaussianElimination(circuit.MNA_A_Complex, circuit.MNA_RHS_Complex);
 
-            for (size_t j = 0; j < nonGroundNodes.size(); ++j) {
-                 if(j < solution.size()) {
-                    nonGroundNodes[j]->phase_sweep_history.push_back({current_phase, abs(solution[j])});
-                }
-            }
+            signals.point(base_freq, solution, point);
+            results.addPoint(current_phase, point);
             pointsCalculated++;
         }
         
@@ -235,6 +2084,345 @@ int phaseSweepAnalysis(Circuit& circuit, const std::string& sourceName, double b
     }
 }
 
+bool transferFunctionAnalysis(Circuit& circuit, const std::string& sourceName, double start_freq, double stop_freq, int order) {
+    try {
+        cout << "// Performing Transfer Function Analysis..." << endl;
+        const TransferFitSettings& settings = circuit.transferFitSettings;
+        circuit.transferFunction.clear();
+        const ACVoltageSource* acSource = circuit.findACVoltageSource(sourceName);
+        if (!acSource) {
+            cerr << "Error: AC source '" << sourceName << "' not found." << endl;
+            return false;
+        }
+        if (start_freq <= 0.0 || stop_freq <= start_freq) {
+            cerr << "Error: Transfer function analysis needs 0 < start frequency < stop frequency." << endl;
+            return false;
+        }
+        PhasorSignals signals(circuit);
+        vector<size_t> columns;
+        for (const auto& output : settings.outputs) {
+            auto it = find(signals.names.begin(), signals.names.end(), output);
+            if (it == signals.names.end()) {
+                cerr << "Error: transfer function output '" << output << "' not found." << endl;
+                return false;
+            }
+            columns.push_back(it - signals.names.begin());
+        }
+        if (columns.empty()) {
+            cerr << "Error: no transfer function outputs selected." << endl;
+            return false;
+        }
+
+        // The outputs for a unit phasor on this source with every other AC source off
+        int max_order = order > 0 ? order : max(2, settings.maxOrder);
+        int samples = max(settings.samples, max_order + 2);
+        vector<double> frequencies;
+        for (int i = 0; i < samples; ++i) {
+            frequencies.push_back(start_freq * pow(stop_freq / start_freq, i / static_cast<double>(samples - 1)));
+        }
+        vector<complex<double>> excitation;
+        circuit.acRHS(excitation);
+        fill(excitation.begin(), excitation.end(), complex<double>(0.0, 0.0));
+        excitation[circuit.countNonGroundNodes() + (acSource - circuit.acVoltageSources.data())] = 1.0;
+        vector<vector<complex<double>>> solutions;
+        solveACPoints(circuit, frequencies, solutions, &excitation);
+        vector<vector<complex<double>>> data(columns.size(), vector<complex<double>>(samples));
+        vector<complex<double>> point;
+        for (int i = 0; i < samples; ++i) {
+            signals.point(frequencies[i], solutions[i], point);
+            for (size_t m = 0; m < columns.size(); ++m) data[m][i] = point[columns[m]];
+        }
+
+        TransferFunction best;
+        for (int n = order > 0 ? order : 2; n <= max_order; n += 2) {
+            TransferFunction candidate;
+            candidate.fit(frequencies, data, n, settings.iterations);
+            if (best.order() == 0 || candidate.rmsError < best.rmsError) best = candidate;
+            if (order > 0 || best.rmsError <= settings.tol) break;
+        }
+        best.source = sourceName;
+        best.signals = settings.outputs;
+        circuit.transferFunction = best;
+        cout << "// Transfer function: " << best.signals.size() << " outputs, order " << best.order()
+             << ", RMS error " << best.rmsError << " over " << samples << " samples." << endl;
+        if (best.rmsError > settings.tol) {
+            cerr << "Warning: transfer function fit is above tolerance; raise the order or narrow the band." << endl;
+        }
+        cout << "// Transfer Function Analysis complete." << endl;
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during Transfer Function Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+// Adjoint sensitivity: with A x = b and the output y = c^T x, A^T lambda = c gives
+// dy/dp = -lambda^T (dA/dp x - db/dp) for every parameter p at once. An admittance Y between
+// nodes a and c contributes dY/dp (lambda_a - lambda_c)(x_a - x_c) to lambda^T (dA/dp) x.
+template <typename T>
+static T branchProduct(const Circuit& circuit, const Node* node1, const Node* node2, const vector<T>& lambda,
+                       const vector<T>& x) {
+    int a = circuit.getNodeMatrixIndex(node1);
+    int c = circuit.getNodeMatrixIndex(node2);
+    T dl = (a != -1 ? lambda[a] : T(0.0)) - (c != -1 ? lambda[c] : T(0.0));
+    T dx = (a != -1 ? x[a] : T(0.0)) - (c != -1 ? x[c] : T(0.0));
+    return dl * dx;
+}
+
+// Splits "V(name)" / "I(name)" into the kind and the name; false if the output is neither
+static bool parseSignal(const string& output, char& kind, string& name) {
+    if (output.size() < 4 || (output[0] != 'V' && output[0] != 'I') || output[1] != '(' || output.back() != ')') {
+        return false;
+    }
+    kind = output[0];
+    name = output.substr(2, output.size() - 3);
+    return true;
+}
+
+bool dcSensitivityAnalysis(Circuit& circuit, const std::string& output) {
+    try {
+        cout << "// Performing DC Sensitivity Analysis..." << endl;
+        circuit.sensitivity.clear();
+        if (!dcAnalysis(circuit) || !circuit.operatingPoint.valid) {
+            cerr << "Error: DC sensitivity analysis needs a converged operating point." << endl;
+            return false;
+        }
+        vector<double> x = circuit.operatingPoint.solution;
+
+        // The Jacobian at the operating point: the DC matrix for the present ideal-diode states
+        // plus the small-signal conductance of each Shockley diode. It is factored here once
+        // more: the operating-point Newton iteration is a modified Newton, so its last
+        // factorization may belong to an earlier iterate (or carry the homotopy shunt), and an
+        // operating point reused from the cache comes with none at all
+        circuit.set_MNA_A(AnalysisType::DC);
+        circuit.set_MNA_RHS(AnalysisType::DC);
+        const vector<vector<double>> G = circuit.MNA_A;
+        const vector<double> rhs = circuit.MNA_RHS;
+        if (G.size() != x.size() || rhs.size() != x.size()) {
+            cerr << "Error: malformed MNA system in DC sensitivity analysis." << endl;
+            return false;
+        }
+        auto at = [&](int i) { return i != -1 ? x[i] : 0.0; };
+        vector<vector<double>> A;
+        vector<double> residual;
+        auto linearize = [&] {
+            A = G;
+            residual.assign(x.size(), 0.0);
+            for (size_t i = 0; i < x.size(); ++i) {
+                for (size_t j = 0; j < x.size(); ++j) residual[i] += G[i][j] * x[j];
+                residual[i] -= rhs[i];
+            }
+            bool shockley = false;
+            for (const auto& diode : circuit.diodes) {
+                if (diode.getModel() != MODEL_SHOCKLEY) continue;
+                shockley = true;
+                int a = circuit.getNodeMatrixIndex(diode.node1);
+                int c = circuit.getNodeMatrixIndex(diode.node2);
+                double vd = at(a) - at(c);
+                double gd = diode.shockleyConductance(vd);
+                double id = diode.shockleyCurrent(vd);
+                if (a != -1) {
+                    A[a][a] += gd;
+                    residual[a] += id;
+                }
+                if (c != -1) {
+                    A[c][c] += gd;
+                    residual[c] -= id;
+                }
+                if (a != -1 && c != -1) {
+                    A[a][c] -= gd;
+                    A[c][a] -= gd;
+                }
+            }
+            return shockley;
+        };
+
+        // The operating point only meets the Newton tolerances, and the diode conductances
+        // follow its junction voltages exponentially; a few full Newton steps bring it to
+        // round-off so the derivatives are those of the exact solution
+        const int MAX_POLISH_STEPS = 5;
+        for (int step = 0; linearize() && step < MAX_POLISH_STEPS; ++step) {
+            vector<double> dx = luSolve(luFactorize(A), residual);
+            double change = 0.0;
+            for (size_t i = 0; i < x.size(); ++i) {
+                x[i] -= dx[i];
+                change = max(change, fabs(dx[i]) / (1.0 + fabs(x[i])));
+            }
+            if (!all_of(x.begin(), x.end(), [](double v) { return isfinite(v); })) {
+                cerr << "Error: DC sensitivity analysis could not refine the operating point." << endl;
+                return false;
+            }
+            if (change <= 1e-14) {
+                linearize();
+                break;
+            }
+        }
+
+        // Output: node voltage or the branch current unknown of a source or inductor
+        int n = circuit.countNonGroundNodes();
+        int index = -1;
+        char kind = 0;
+        string name;
+        if (parseSignal(output, kind, name) && kind == 'V') {
+            Node* node = circuit.findNode(name);
+            index = node ? circuit.getNodeMatrixIndex(node) : -1;
+        } else if (kind == 'I') {
+            for (size_t k = 0; k < circuit.voltageSources.size(); ++k) {
+                if (circuit.voltageSources[k].name == name) index = n + k;
+            }
+            for (size_t k = 0; k < circuit.acVoltageSources.size(); ++k) {
+                if (circuit.acVoltageSources[k].name == name) index = n + circuit.voltageSources.size() + k;
+            }
+            for (size_t k = 0; k < circuit.inductors.size(); ++k) {
+                if (circuit.inductors[k].name == name) index = n + circuit.inductorBranchOffset() + k;
+            }
+        }
+        if (index < 0 || index >= static_cast<int>(x.size())) {
+            cerr << "Error: sensitivity output '" << output << "' not found." << endl;
+            return false;
+        }
+        vector<double> c(x.size(), 0.0);
+        c[index] = 1.0;
+        vector<double> lambda = luSolveTransposed(luFactorize(std::move(A)), c);
+
+        // Capacitors and inductors do not enter the DC solution; sources only enter b, each
+        // voltage source through its own row and each current source through its two nodes
+        SensitivityResults& results = circuit.sensitivity;
+        results.output = output;
+        results.value = x[index];
+        auto record = [&](const string& component, double derivative) {
+            results.components.push_back(component);
+            results.derivatives.push_back(derivative);
+        };
+        for (const auto& res : circuit.resistors) {
+            record(res.name, branchProduct(circuit, res.node1, res.node2, lambda, x) / (res.resistance * res.resistance));
+        }
+        for (const auto& cap : circuit.capacitors) record(cap.name, 0.0);
+        for (const auto& ind : circuit.inductors) record(ind.name, 0.0);
+        for (size_t k = 0; k < circuit.voltageSources.size(); ++k) {
+            record(circuit.voltageSources[k].name, lambda[n + k]);
+        }
+        for (const auto& cs : circuit.currentSources) {
+            int a = circuit.getNodeMatrixIndex(cs.node1);
+            int b = circuit.getNodeMatrixIndex(cs.node2);
+            record(cs.name, (a != -1 ? lambda[a] : 0.0) - (b != -1 ? lambda[b] : 0.0));
+        }
+        for (size_t k = 0; k < circuit.acVoltageSources.size(); ++k) {
+            ACVoltageSource unit = circuit.acVoltageSources[k];
+            unit.magnitude = 1.0;
+            record(unit.name, lambda[n + circuit.voltageSources.size() + k] * unit.getValue(circuit.time));
+        }
+        cout << "// DC sensitivity of " << output << " to " << results.components.size() << " components." << endl;
+        cout << "// DC Sensitivity Analysis complete." << endl;
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during DC Sensitivity Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool acSensitivityAnalysis(Circuit& circuit, const std::string& output, double frequency) {
+    try {
+        cout << "// Performing AC Sensitivity Analysis..." << endl;
+        circuit.sensitivity.clear();
+        if (frequency <= 0.0) {
+            cerr << "Error: AC sensitivity analysis needs a positive frequency." << endl;
+            return false;
+        }
+        vector<vector<complex<double>>> Y;
+        circuit.acPencil().assemble(frequency, Y);
+        vector<complex<double>> b;
+        circuit.acRHS(b);
+        if (Y.empty() || Y.size() != b.size()) {
+            cerr << "Error: malformed MNA system in AC sensitivity analysis." << endl;
+            return false;
+        }
+        ComplexLUFactorization lu = luFactorize(std::move(Y));
+        vector<complex<double>> x = luSolve(lu, b);
+
+        // Output functional c^T x; an inductor current is (v1 - v2) / (jwL), which also depends
+        // on L directly
+        const complex<double> jw(0.0, 2.0 * M_PI * frequency);
+        int n = circuit.countNonGroundNodes();
+        vector<complex<double>> c(x.size(), {0.0, 0.0});
+        const Inductor* outputInductor = nullptr;
+        char kind = 0;
+        string name;
+        bool found = false;
+        if (parseSignal(output, kind, name) && kind == 'V') {
+            Node* node = circuit.findNode(name);
+            int index = node ? circuit.getNodeMatrixIndex(node) : -1;
+            if (index != -1) {
+                c[index] = 1.0;
+                found = true;
+            }
+        } else if (kind == 'I') {
+            for (size_t k = 0; k < circuit.acVoltageSources.size() && !found; ++k) {
+                if (circuit.acVoltageSources[k].name != name) continue;
+                c[n + k] = 1.0;
+                found = true;
+            }
+            for (size_t k = 0; k < circuit.inductors.size() && !found; ++k) {
+                if (circuit.inductors[k].name != name) continue;
+                outputInductor = &circuit.inductors[k];
+                int a = circuit.getNodeMatrixIndex(outputInductor->node1);
+                int d = circuit.getNodeMatrixIndex(outputInductor->node2);
+                if (a != -1) c[a] += 1.0 / (jw * outputInductor->inductance);
+                if (d != -1) c[d] -= 1.0 / (jw * outputInductor->inductance);
+                found = true;
+            }
+        }
+        if (!found) {
+            cerr << "Error: sensitivity output '" << output << "' not found." << endl;
+            return false;
+        }
+        vector<complex<double>> lambda = luSolveTransposed(lu, c);
+
+        SensitivityResults& results = circuit.sensitivity;
+        results.output = output;
+        results.ac = true;
+        results.frequency = frequency;
+        results.value = 0.0;
+        for (size_t i = 0; i < x.size(); ++i) results.value += c[i] * x[i];
+        auto record = [&](const string& component, complex<double> derivative) {
+            results.components.push_back(component);
+            results.derivatives.push_back(derivative);
+        };
+        for (const auto& res : circuit.resistors) {
+            record(res.name, branchProduct(circuit, res.node1, res.node2, lambda, x) / (res.resistance * res.resistance));
+        }
+        for (const auto& cap : circuit.capacitors) {
+            record(cap.name, -jw * branchProduct(circuit, cap.node1, cap.node2, lambda, x));
+        }
+        for (const auto& ind : circuit.inductors) {
+            double L = ind.inductance;
+            complex<double> derivative = branchProduct(circuit, ind.node1, ind.node2, lambda, x) / (jw * L * L);
+            if (&ind == outputInductor) {
+                int a = circuit.getNodeMatrixIndex(ind.node1);
+                int d = circuit.getNodeMatrixIndex(ind.node2);
+                complex<double> v = (a != -1 ? x[a] : 0.0) - (d != -1 ? x[d] : 0.0);
+                derivative -= v / (jw * L * L);
+            }
+            record(ind.name, derivative);
+        }
+        // DC sources and current sources are not part of the AC system
+        for (const auto& vs : circuit.voltageSources) record(vs.name, 0.0);
+        for (const auto& cs : circuit.currentSources) record(cs.name, 0.0);
+        for (size_t k = 0; k < circuit.acVoltageSources.size(); ++k) {
+            ACVoltageSource unit = circuit.acVoltageSources[k];
+            unit.magnitude = 1.0;
+            record(unit.name, lambda[n + k] * unit.getPhasor());
+        }
+        cout << "// AC sensitivity of " << output << " at " << frequency << " Hz to "
+             << results.components.size() << " components." << endl;
+        cout << "// AC Sensitivity Analysis complete." << endl;
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Critical error during AC Sensitivity Analysis: " << e.what() << endl;
+        return false;
+    }
+}
+
 void result_from_vec(Circuit& circuit, const vector<double>& solvedVoltages, const vector<Node*>& nonGroundNodes) {
     if (solvedVoltages.empty()) {
         throw std::runtime_error("Solver returned an empty solution vector.");
@@ -254,6 +2442,7 @@ void result_from_vec(Circuit& circuit, const vector<double>& solvedVoltages, con
         }
     }
     current_idx_offset += circuit.voltageSources.size();
+    current_idx_offset += circuit.acVoltageSources.size();
 
     for(size_t i = 0; i < circuit.inductors.size(); ++i) {
         if (current_idx_offset + i < solvedVoltages.size()) {
@@ -263,14 +2452,26 @@ void result_from_vec(Circuit& circuit, const vector<double>& solvedVoltages, con
     current_idx_offset += circuit.inductors.size();
 
     for (auto& diode : circuit.diodes) {
+        if (diode.getModel() == MODEL_SHOCKLEY) {
+            continue; // Current was set from the junction model by the Newton solver
+        }
         if (diode.getState() != STATE_OFF) {
+            // Branch indices are relative to the extra variables, which follow the node voltages
             int idx = diode.getBranchIndex();
-             if (idx != -1 && static_cast<size_t>(idx) < solvedVoltages.size()) {
-                diode.setCurrent(solvedVoltages[idx]);
+            if (idx != -1 && nonGroundNodes.size() + idx < solvedVoltages.size()) {
+                diode.setCurrent(solvedVoltages[nonGroundNodes.size() + idx]);
             }
         } else {
             diode.setCurrent(0.0);
         }
     }
+
+    for (auto& model : circuit.reducedModels) {
+        model.states.assign(model.stateCount(), 0.0);
+        for (int k = 0; k < model.stateCount(); ++k) {
+            size_t idx = nonGroundNodes.size() + model.firstState + k;
+            if (idx < solvedVoltages.size()) model.states[k] = solvedVoltages[idx];
+        }
+    }
 }
 
@@ -0,0 +1,39 @@
+#include "BreakpointQueue.h"
+#include "Circuit.h"
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+BreakpointQueue::BreakpointQueue(const Circuit& circuit, double t_stop)
+    : stopTime(t_stop), timeTolerance(1e-9 * t_stop) {
+    for (const auto& vs : circuit.voltageSources) {
+        push(&vs.waveform, 0.0);
+    }
+    for (const auto& cs : circuit.currentSources) {
+        push(&cs.waveform, 0.0);
+    }
+}
+
+double BreakpointQueue::next() const {
+    if (heap.empty()) {
+        return numeric_limits<double>::infinity();
+    }
+    return heap.top().time;
+}
+
+// Drops every breakpoint at or before time and refills from the sources they came from
+void BreakpointQueue::consumeThrough(double time) {
+    while (!heap.empty() && heap.top().time <= time + timeTolerance) {
+        Entry entry = heap.top();
+        heap.pop();
+        push(entry.waveform, max(entry.time, time + timeTolerance));
+    }
+}
+
+void BreakpointQueue::push(const Waveform* waveform, double after) {
+    double t = waveform->nextBreakpoint(after);
+    if (t <= stopTime) {
+        heap.push({t, waveform});
+    }
+}
@@ -5,7 +5,7 @@
 using namespace std;
 
 double Capacitor::getCurrent() {
-    return 0.0;
+    return prevCurrent;
 }
 
 double Capacitor::getVoltage() {
@@ -13,7 +13,67 @@ double Capacitor::getVoltage() {
     return fabs(node1->getVoltage() - node2->getVoltage());
 }
 
-void Capacitor::update(double dt) {
+double Capacitor::companionConductance(IntegrationMethod method, double dt, double prev_dt) const {
+    if (method == IntegrationMethod::TRAPEZOIDAL) {
+        return 2.0 * capacitance / dt;
+    }
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        return a0 * capacitance / dt;
+    }
+    return capacitance / dt;
+}
+
+double Capacitor::companionCurrent(IntegrationMethod method, double dt, double prev_dt) const {
+    if (method == IntegrationMethod::TRAPEZOIDAL) {
+        return 2.0 * capacitance / dt * prevVoltage + prevCurrent;
+    }
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        return -capacitance / dt * (a1 * prevVoltage + a2 * prevPrevVoltage);
+    }
+    return capacitance / dt * prevVoltage;
+}
+
+void Capacitor::update(double dt, IntegrationMethod method, double prev_dt) {
     if (!node1 || !node2) return;
-    prevVoltage = node1->getVoltage() - node2->getVoltage();
-}
\ No newline at end of file
+    double v = node1->getVoltage() - node2->getVoltage();
+    double i = companionConductance(method, dt, prev_dt) * v - companionCurrent(method, dt, prev_dt);
+
+    // Trapezoidal ringing shows up as a current that zig-zags every step without decaying
+    double delta = i - prevCurrent;
+    if (method == IntegrationMethod::TRAPEZOIDAL && delta * prevCurrentDelta < 0.0 && fabs(delta) > 1e-12 &&
+        fabs(delta) > 0.5 * fabs(prevCurrentDelta)) {
+        ringingCount++;
+    } else {
+        ringingCount = 0;
+    }
+
+    prevPrevVoltage = prevVoltage;
+    prevVoltage = v;
+    prevCurrent = i;
+    prevCurrentDelta = delta;
+}
+
+void Capacitor::resetHistory() {
+    double v = (node1 && node2) ? node1->getVoltage() - node2->getVoltage() : 0.0;
+    prevVoltage = v;
+    prevPrevVoltage = v;
+    prevCurrent = 0.0;
+    prevCurrentDelta = 0.0;
+    ringingCount = 0;
+}
+
+vector<double> Capacitor::historyState() const {
+    return {prevVoltage, prevPrevVoltage, prevCurrent, prevCurrentDelta, static_cast<double>(ringingCount)};
+}
+
+void Capacitor::restoreHistoryState(const vector<double>& state) {
+    prevVoltage = state[0];
+    prevPrevVoltage = state[1];
+    prevCurrent = state[2];
+    prevCurrentDelta = state[3];
+    ringingCount = static_cast<int>(state[4]);
+}
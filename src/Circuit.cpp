@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <complex>
+#include <stdexcept>
 
 Circuit::Circuit() : delta_t(0) {}
 
@@ -70,6 +71,11 @@ VoltageSource *Circuit::findVoltageSource(const string &find_from_name) {
     return nullptr;
 }
 
+ACVoltageSource *Circuit::findACVoltageSource(const string &find_from_name) {
+    for (auto &vs: acVoltageSources) { if (vs.name == find_from_name) return &vs; }
+    return nullptr;
+}
+
 bool Circuit::deleteResistor(const string &name) {
     auto it = remove_if(resistors.begin(), resistors.end(), [&](const Resistor &r) { return r.name == name; });
     if (it != resistors.end()) {
@@ -127,17 +133,24 @@ bool Circuit::deleteCurrentSource(const string &name) {
 }
 
 int Circuit::countTotalExtraVariables() {
-    int m_vars = voltageSources.size() + inductors.size();
+    int m_vars = inductorBranchOffset() + inductors.size();
     for (const auto& diode : diodes) {
         if (diode.getState() == STATE_FORWARD_ON || diode.getState() == STATE_REVERSE_ON) {
             m_vars++;
         }
     }
+    for (const auto& model : reducedModels) {
+        m_vars += model.stateCount();
+    }
     return m_vars;
 }
 
+int Circuit::inductorBranchOffset() const {
+    return voltageSources.size() + acVoltageSources.size();
+}
+
 void Circuit::assignDiodeBranchIndices() {
-    int current_branch_idx = voltageSources.size() + inductors.size();
+    int current_branch_idx = inductorBranchOffset() + inductors.size();
     for (auto& diode : diodes) {
         if (diode.getState() == STATE_FORWARD_ON || diode.getState() == STATE_REVERSE_ON) {
             diode.setBranchIndex(current_branch_idx++);
@@ -145,6 +158,17 @@ void Circuit::assignDiodeBranchIndices() {
             diode.setBranchIndex(-1);
         }
     }
+    for (auto& model : reducedModels) {
+        model.firstState = current_branch_idx;
+        current_branch_idx += model.stateCount();
+    }
+}
+
+int Circuit::reducedModelIndex(const ReducedModel& model, size_t k, int stateBase) const {
+    if (k < model.ports.size()) {
+        return getNodeMatrixIndex(model.ports[k]);
+    }
+    return stateBase + static_cast<int>(k - model.ports.size());
 }
 
 vector<vector<double>> Circuit::G() {
@@ -156,20 +180,37 @@ vector<vector<double>> Circuit::G() {
         int n1_index = getNodeMatrixIndex(res.node1);
         int n2_index = getNodeMatrixIndex(res.node2);
         
+        double g = 1.0 / res.resistance;
+        if (n1_index == n2_index) continue; // Skip if both terminals on same node
+        
+        if (n1_index != -1) {
+            result[n1_index][n1_index] += g;
+        }
+        if (n2_index != -1) {
+            result[n2_index][n2_index] += g;
+        }
         if (n1_index != -1 && n2_index != -1) {
-            double g = 1.0 / res.resistance;
-            if (n1_index == n2_index) continue; // Skip if both terminals on same node
-            
-            if (n1_index != -1) {
-                result[n1_index][n1_index] += g;
-            }
-            if (n2_index != -1) {
-                result[n2_index][n2_index] += g;
-            }
-            if (n1_index != -1 && n2_index != -1) {
-                result[n1_index][n2_index] -= g;
-                result[n2_index][n1_index] -= g;
-            }
+            result[n1_index][n2_index] -= g;
+            result[n2_index][n1_index] -= g;
+        }
+    }
+    
+    // Capacitor companion conductances
+    for (const auto& cap : capacitors) {
+        int n1_index = getNodeMatrixIndex(cap.node1);
+        int n2_index = getNodeMatrixIndex(cap.node2);
+        if (n1_index == n2_index) continue;
+
+        double g = cap.companionConductance(stepMethod, delta_t, prev_delta_t);
+        if (n1_index != -1) {
+            result[n1_index][n1_index] += g;
+        }
+        if (n2_index != -1) {
+            result[n2_index][n2_index] += g;
+        }
+        if (n1_index != -1 && n2_index != -1) {
+            result[n1_index][n2_index] -= g;
+            result[n2_index][n1_index] -= g;
         }
     }
     
@@ -196,12 +237,27 @@ vector<vector<double>> Circuit::B() {
         }
     }
     
+    // AC voltage sources follow the DC sources (time-domain value in transient)
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        const auto& ac_vs = acVoltageSources[i];
+        int n1_index = getNodeMatrixIndex(ac_vs.node1);
+        int n2_index = getNodeMatrixIndex(ac_vs.node2);
+        int vs_index = voltageSources.size() + i;
+        
+        if (n1_index != -1) {
+            result[n1_index][vs_index] = 1.0;
+        }
+        if (n2_index != -1) {
+            result[n2_index][vs_index] = -1.0;
+        }
+    }
+    
     // Inductors contribute to B matrix
     for (size_t i = 0; i < inductors.size(); ++i) {
         const auto& ind = inductors[i];
         int n1_index = getNodeMatrixIndex(ind.node1);
         int n2_index = getNodeMatrixIndex(ind.node2);
-        int ind_index = voltageSources.size() + i;
+        int ind_index = inductorBranchOffset() + i;
         
         if (n1_index != -1) {
             result[n1_index][ind_index] = 1.0;
@@ -211,6 +267,21 @@ vector<vector<double>> Circuit::B() {
         }
     }
     
+    // Conducting ideal diodes are voltage sources on their own branch current
+    for (const auto& d : diodes) {
+        int branch_index = d.getBranchIndex();
+        if (branch_index < 0 || branch_index >= extra_vars) continue;
+        int n1_index = getNodeMatrixIndex(d.node1);
+        int n2_index = getNodeMatrixIndex(d.node2);
+        
+        if (n1_index != -1) {
+            result[n1_index][branch_index] = 1.0;
+        }
+        if (n2_index != -1) {
+            result[n2_index][branch_index] = -1.0;
+        }
+    }
+    
     return result;
 }
 
@@ -234,12 +305,26 @@ vector<vector<double>> Circuit::C() {
         }
     }
     
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        const auto& ac_vs = acVoltageSources[i];
+        int n1_index = getNodeMatrixIndex(ac_vs.node1);
+        int n2_index = getNodeMatrixIndex(ac_vs.node2);
+        int vs_index = voltageSources.size() + i;
+        
+        if (n1_index != -1) {
+            result[vs_index][n1_index] = 1.0;
+        }
+        if (n2_index != -1) {
+            result[vs_index][n2_index] = -1.0;
+        }
+    }
+    
     // Inductors contribute to C matrix (transpose of B)
     for (size_t i = 0; i < inductors.size(); ++i) {
         const auto& ind = inductors[i];
         int n1_index = getNodeMatrixIndex(ind.node1);
         int n2_index = getNodeMatrixIndex(ind.node2);
-        int ind_index = voltageSources.size() + i;
+        int ind_index = inductorBranchOffset() + i;
         
         if (n1_index != -1) {
             result[ind_index][n1_index] = 1.0;
@@ -249,6 +334,20 @@ vector<vector<double>> Circuit::C() {
         }
     }
     
+    for (const auto& d : diodes) {
+        int branch_index = d.getBranchIndex();
+        if (branch_index < 0 || branch_index >= extra_vars) continue;
+        int n1_index = getNodeMatrixIndex(d.node1);
+        int n2_index = getNodeMatrixIndex(d.node2);
+        
+        if (n1_index != -1) {
+            result[branch_index][n1_index] = 1.0;
+        }
+        if (n2_index != -1) {
+            result[branch_index][n2_index] = -1.0;
+        }
+    }
+    
     return result;
 }
 
@@ -256,13 +355,13 @@ vector<vector<double>> Circuit::D() {
     int extra_vars = countTotalExtraVariables();
     vector<vector<double>> result(extra_vars, vector<double>(extra_vars, 0.0));
     
-    // Diodes in forward or reverse conducting state contribute to D matrix
-    for (const auto& d : diodes) {
-        if (d.getState() == DiodeState::STATE_FORWARD_ON || d.getState() == DiodeState::STATE_REVERSE_ON) {
-            int branch_index = d.getBranchIndex();
-            if (branch_index >= 0 && branch_index < extra_vars) {
-                result[branch_index][branch_index] = 1.0; // Diode current unknown, so placeholder
-            }
+    // Conducting ideal diodes are plain voltage sources, so they add nothing to D
+    
+    // Inductor branch equation: v1 - v2 - Req * i = -Veq
+    for (size_t i = 0; i < inductors.size(); ++i) {
+        int ind_index = inductorBranchOffset() + i;
+        if (ind_index < extra_vars) {
+            result[ind_index][ind_index] = -inductors[i].companionResistance(stepMethod, delta_t, prev_delta_t);
         }
     }
     
@@ -273,22 +372,32 @@ vector<double> Circuit::J() {
     int extra_vars = countTotalExtraVariables();
     vector<double> result(extra_vars, 0.0);
     
-    // Voltage sources contribute to J vector
+    // Voltage sources contribute to J vector; waveforms are evaluated at the current time so
+    // a time-varying stimulus only changes the RHS, never the matrix
     for (size_t i = 0; i < voltageSources.size(); ++i) {
-        result[i] = voltageSources[i].value;
+        result[i] = sourceScale * voltageSources[i].valueAt(time);
+    }
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        result[voltageSources.size() + i] = sourceScale * acVoltageSources[i].getValue(time);
     }
     
     // Inductors contribute to J vector
     for (size_t i = 0; i < inductors.size(); ++i) {
-        int ind_index = voltageSources.size() + i;
+        int ind_index = inductorBranchOffset() + i;
         if (ind_index < extra_vars) {
-            // For backward Euler: v_L(n+1) = L/dt * (i_L(n+1) - i_L(n))
-            // Rearranging: -L/dt * i_L(n+1) = -L/dt * i_L(n) - v_L(n+1)
-            // So the term added to RHS is -L/dt * i_L(n)
-            result[ind_index] = -inductors[i].inductance / delta_t * inductors[i].prevCurrent;
+            // Companion model v_L(n+1) = Req * i_L(n+1) - Veq, e.g. for backward Euler
+            // Req = L/dt and Veq = L/dt * i_L(n), so the term added to RHS is -Veq
+            result[ind_index] = -inductors[i].companionVoltage(stepMethod, delta_t, prev_delta_t);
         }
     }
     
+    // Conducting ideal diodes hold their forward (or zener) voltage
+    for (const auto& d : diodes) {
+        int branch_index = d.getBranchIndex();
+        if (branch_index < 0 || branch_index >= extra_vars) continue;
+        result[branch_index] = (d.getState() == STATE_REVERSE_ON) ? -d.getZenerVoltage() : d.getForwardVoltage();
+    }
+    
     return result;
 }
 
@@ -301,19 +410,21 @@ vector<double> Circuit::E() {
         int n1_index = getNodeMatrixIndex(cs.node1);
         int n2_index = getNodeMatrixIndex(cs.node2);
         
+        double value = sourceScale * cs.valueAt(time);
+        
         if (n1_index != -1) {
-            result[n1_index] += cs.value;
+            result[n1_index] += value;
         }
         if (n2_index != -1) {
-            result[n2_index] -= cs.value;
+            result[n2_index] -= value;
         }
     }
     
-    // Capacitors contribute to E vector
+    // Capacitor companion history currents (i = Geq * v - Ieq)
     for (const auto& cap : capacitors) {
         int n1_index = getNodeMatrixIndex(cap.node1);
         int n2_index = getNodeMatrixIndex(cap.node2);
-        double i_cap = cap.capacitance / delta_t * (cap.node1->getVoltage() - cap.node2->getVoltage() - cap.prevVoltage);
+        double i_cap = cap.companionCurrent(stepMethod, delta_t, prev_delta_t);
         
         if (n1_index != -1) {
             result[n1_index] += i_cap;
@@ -326,73 +437,102 @@ vector<double> Circuit::E() {
     return result;
 }
 
-// --- MODIFIED ---
-// This function is now a dispatcher. It builds the correct MNA matrix
-// based on the analysis type.
-void Circuit::set_MNA_A(AnalysisType type, double frequency) {
-    if (type == AnalysisType::AC_SWEEP) {
-        // --- NEW LOGIC FOR AC ANALYSIS ---
-        int n = countNonGroundNodes();
-        // For simplicity, this example assumes only voltage sources add extra variables in AC
-        int m = acVoltageSources.size();
-        MNA_A_Complex.assign(n + m, vector<complex<double>>(n + m, {0.0, 0.0}));
-
-        // G Matrix (Resistors)
-        for (const auto &res : resistors) {
-            double conductance = 1.0 / res.resistance;
-            int idx1 = getNodeMatrixIndex(res.node1);
-            int idx2 = getNodeMatrixIndex(res.node2);
-            if (idx1 != -1) MNA_A_Complex[idx1][idx1] += conductance;
-            if (idx2 != -1) MNA_A_Complex[idx2][idx2] += conductance;
-            if (idx1 != -1 && idx2 != -1) {
-                MNA_A_Complex[idx1][idx2] -= conductance;
-                MNA_A_Complex[idx2][idx1] -= conductance;
-            }
-        }
+void AcPencil::assemble(double frequency, vector<vector<complex<double>>>& A) const {
+    if (!(frequency > 0.0)) {
+        throw runtime_error("AC matrix needs a positive frequency");
+    }
+    // assign() keeps the rows' storage, so a buffer reused across frequencies is not reallocated
+    A.assign(size, vector<complex<double>>(size, {0.0, 0.0}));
+    double w = 2.0 * M_PI * frequency;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        A[rows[k]][cols[k]] = {g[k], w * c[k] - gamma[k] / w};
+    }
+}
 
-        // Impedances for L and C
-        const complex<double> j(0.0, 1.0);
-        for (const auto &cap : capacitors) {
-            complex<double> impedance = 1.0 / (j * 2.0 * M_PI * frequency * cap.capacitance);
-            complex<double> admittance = 1.0 / impedance;
-            int idx1 = getNodeMatrixIndex(cap.node1);
-            int idx2 = getNodeMatrixIndex(cap.node2);
-            if (idx1 != -1) MNA_A_Complex[idx1][idx1] += admittance;
-            if (idx2 != -1) MNA_A_Complex[idx2][idx2] += admittance;
-            if (idx1 != -1 && idx2 != -1) {
-                MNA_A_Complex[idx1][idx2] -= admittance;
-                MNA_A_Complex[idx2][idx1] -= admittance;
-            }
+AcPencil Circuit::acPencil() const {
+    int n = countNonGroundNodes();
+    // Unknowns: node voltages, then the AC source currents, then the reduced-model states
+    // (inductor currents are not unknowns; inductors enter as Gamma/(jw) admittances)
+    int m = acVoltageSources.size();
+    int states = 0;
+    for (const auto& model : reducedModels) states += model.stateCount();
+
+    AcPencil pencil;
+    pencil.size = n + m + states;
+    map<pair<int, int>, size_t> entries;
+    auto add = [&](int row, int col, double g, double c, double gamma) {
+        auto inserted = entries.insert({{row, col}, pencil.rows.size()});
+        if (inserted.second) {
+            pencil.rows.push_back(row);
+            pencil.cols.push_back(col);
+            pencil.g.push_back(0.0);
+            pencil.c.push_back(0.0);
+            pencil.gamma.push_back(0.0);
+        }
+        size_t k = inserted.first->second;
+        pencil.g[k] += g;
+        pencil.c[k] += c;
+        pencil.gamma[k] += gamma;
+    };
+    // Two-terminal element with admittance g + jwc + gamma/(jw)
+    auto stamp = [&](const Node* node1, const Node* node2, double g, double c, double gamma) {
+        int idx1 = getNodeMatrixIndex(node1);
+        int idx2 = getNodeMatrixIndex(node2);
+        if (idx1 != -1) add(idx1, idx1, g, c, gamma);
+        if (idx2 != -1) add(idx2, idx2, g, c, gamma);
+        if (idx1 != -1 && idx2 != -1) {
+            add(idx1, idx2, -g, -c, -gamma);
+            add(idx2, idx1, -g, -c, -gamma);
         }
+    };
 
-        for (const auto &ind : inductors) {
-            complex<double> impedance = j * 2.0 * M_PI * frequency * ind.inductance;
-            complex<double> admittance = 1.0 / impedance;
-            int idx1 = getNodeMatrixIndex(ind.node1);
-            int idx2 = getNodeMatrixIndex(ind.node2);
-            if (idx1 != -1) MNA_A_Complex[idx1][idx1] += admittance;
-            if (idx2 != -1) MNA_A_Complex[idx2][idx2] += admittance;
-            if (idx1 != -1 && idx2 != -1) {
-                MNA_A_Complex[idx1][idx2] -= admittance;
-                MNA_A_Complex[idx2][idx1] -= admittance;
+    for (const auto &res : resistors) stamp(res.node1, res.node2, 1.0 / res.resistance, 0.0, 0.0);
+    for (const auto &cap : capacitors) stamp(cap.node1, cap.node2, 0.0, cap.capacitance, 0.0);
+    for (const auto &ind : inductors) stamp(ind.node1, ind.node2, 0.0, 0.0, 1.0 / ind.inductance);
+
+    // Reduced models: G + jwC over their ports and states, which follow the AC sources
+    int state_base = n + m;
+    for (const auto& model : reducedModels) {
+        for (size_t r = 0; r < model.G.size(); ++r) {
+            int row = reducedModelIndex(model, r, state_base);
+            if (row == -1) continue;
+            for (size_t c = 0; c < model.G.size(); ++c) {
+                int col = reducedModelIndex(model, c, state_base);
+                if (col != -1 && (model.G[r][c] != 0.0 || model.C[r][c] != 0.0)) {
+                    add(row, col, model.G[r][c], model.C[r][c], 0.0);
+                }
             }
         }
+        state_base += model.stateCount();
+    }
 
-        // B, C, D matrices for AC sources
-        for (size_t i = 0; i < acVoltageSources.size(); ++i) {
-            int idx1 = getNodeMatrixIndex(acVoltageSources[i].node1);
-            int idx2 = getNodeMatrixIndex(acVoltageSources[i].node2);
-            int var_idx = n + i;
-            if (idx1 != -1) {
-                MNA_A_Complex[idx1][var_idx] += 1.0;
-                MNA_A_Complex[var_idx][idx1] += 1.0;
-            }
-            if (idx2 != -1) {
-                MNA_A_Complex[idx2][var_idx] -= 1.0;
-                MNA_A_Complex[var_idx][idx2] -= 1.0;
-            }
+    // B, C, D matrices for AC sources
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        int idx1 = getNodeMatrixIndex(acVoltageSources[i].node1);
+        int idx2 = getNodeMatrixIndex(acVoltageSources[i].node2);
+        int var_idx = n + i;
+        if (idx1 != -1) {
+            add(idx1, var_idx, 1.0, 0.0, 0.0);
+            add(var_idx, idx1, 1.0, 0.0, 0.0);
+        }
+        if (idx2 != -1) {
+            add(idx2, var_idx, -1.0, 0.0, 0.0);
+            add(var_idx, idx2, -1.0, 0.0, 0.0);
         }
+    }
+    return pencil;
+}
+
+void Circuit::acMatrix(double frequency, vector<vector<complex<double>>>& A) const {
+    acPencil().assemble(frequency, A);
+}
 
+// --- MODIFIED ---
+// This function is now a dispatcher. It builds the correct MNA matrix
+// based on the analysis type.
+void Circuit::set_MNA_A(AnalysisType type, double frequency) {
+    if (type == AnalysisType::AC_SWEEP) {
+        acMatrix(frequency, MNA_A_Complex);
     } else {
         // --- EXISTING LOGIC FOR DC/TRANSIENT ---
         // (This is the original implementation using real numbers)
@@ -438,33 +578,152 @@ void Circuit::set_MNA_A(AnalysisType type, double frequency) {
                 }
             }
         }
+
+        // Reduced models: G plus the companion conductance of C over their ports and states
+        for (const auto& model : reducedModels) {
+            double factor = model.companionFactor(stepMethod, delta_t, prev_delta_t);
+            for (size_t r = 0; r < model.G.size(); ++r) {
+                int row = reducedModelIndex(model, r, n + model.firstState);
+                if (row == -1) continue;
+                for (size_t c = 0; c < model.G.size(); ++c) {
+                    int col = reducedModelIndex(model, c, n + model.firstState);
+                    if (col != -1) MNA_A[row][col] += model.G[r][c] + factor * model.C[r][c];
+                }
+            }
+        }
+
+        for (int i = 0; i < n && homotopyConductance > 0.0; ++i) {
+            MNA_A[i][i] += homotopyConductance;
+        }
     }
 }
 
+void Circuit::acRHS(vector<complex<double>>& b) const {
+    int n = countNonGroundNodes();
+    int m = acVoltageSources.size();
+    int states = 0;
+    for (const auto& model : reducedModels) states += model.stateCount();
+    b.assign(n + m + states, {0.0, 0.0}); // reduced-model states last
+
+    // E vector for AC sources
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        b[n + i] = acVoltageSources[i].getPhasor();
+    }
+    // Note: AC current sources would contribute to the 'J' part of the vector
+}
+
 // The set_MNA_RHS function would be similarly modified to handle complex values for AC sources.
 void Circuit::set_MNA_RHS(AnalysisType type, double frequency) {
     if (type == AnalysisType::AC_SWEEP) {
-        int n = countNonGroundNodes();
-        int m = acVoltageSources.size();
-        MNA_RHS_Complex.assign(n + m, {0.0, 0.0});
-
-        // E vector for AC sources
-        for (size_t i = 0; i < acVoltageSources.size(); ++i) {
-            MNA_RHS_Complex[n + i] = acVoltageSources[i].getPhasor();
-        }
-        // Note: AC current sources would contribute to the 'J' part of the vector
+        acRHS(MNA_RHS_Complex);
     } else {
         // Original implementation for DC/Transient
-        vector<double> j_vec = J();
+        // Node equations take the current injections (E), extra variables the source values (J)
         vector<double> e_vec = E();
-        int n = j_vec.size();
-        int m = countTotalExtraVariables();
+        vector<double> j_vec = J();
+        int n = e_vec.size();
+        int m = j_vec.size();
         MNA_RHS.assign(n + m, 0.0);
-        for (int i = 0; i < n; i++) MNA_RHS[i] = j_vec[i];
-        for (int i = 0; i < m; i++) MNA_RHS[n + i] = e_vec[i];
+        for (int i = 0; i < n; i++) MNA_RHS[i] = e_vec[i];
+        for (int i = 0; i < m; i++) MNA_RHS[n + i] = j_vec[i];
+        for (const auto& model : reducedModels) {
+            vector<double> history = model.companionCurrent(stepMethod, delta_t, prev_delta_t);
+            for (size_t r = 0; r < history.size(); ++r) {
+                int row = reducedModelIndex(model, r, n + model.firstState);
+                if (row != -1) MNA_RHS[row] += history[r];
+            }
+        }
+        if (homotopyConductance > 0.0 && homotopyAnchor.size() == static_cast<size_t>(n)) {
+            for (int i = 0; i < n; i++) MNA_RHS[i] += homotopyConductance * homotopyAnchor[i];
+        }
+    }
+}
+
+void Circuit::descriptorSystem(vector<vector<double>>& g, vector<vector<double>>& c) {
+    int n = countNonGroundNodes();
+    int m = countTotalExtraVariables();
+    g.assign(n + m, vector<double>(n + m, 0.0));
+    c.assign(n + m, vector<double>(n + m, 0.0));
+
+    auto stamp = [&](vector<vector<double>>& a, const Node* node1, const Node* node2, double value) {
+        int i = getNodeMatrixIndex(node1);
+        int j = getNodeMatrixIndex(node2);
+        if (i == j) return;
+        if (i != -1) a[i][i] += value;
+        if (j != -1) a[j][j] += value;
+        if (i != -1 && j != -1) {
+            a[i][j] -= value;
+            a[j][i] -= value;
+        }
+    };
+    auto branch = [&](const Node* node1, const Node* node2, int k) {
+        int i = getNodeMatrixIndex(node1);
+        int j = getNodeMatrixIndex(node2);
+        if (i != -1) {
+            g[i][n + k] += 1.0;
+            g[n + k][i] -= 1.0;
+        }
+        if (j != -1) {
+            g[j][n + k] -= 1.0;
+            g[n + k][j] += 1.0;
+        }
+    };
+
+    for (const auto& res : resistors) stamp(g, res.node1, res.node2, 1.0 / res.resistance);
+    for (const auto& cap : capacitors) stamp(c, cap.node1, cap.node2, cap.capacitance);
+    for (size_t i = 0; i < voltageSources.size(); ++i) {
+        branch(voltageSources[i].node1, voltageSources[i].node2, i);
+    }
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        branch(acVoltageSources[i].node1, acVoltageSources[i].node2, voltageSources.size() + i);
+    }
+    for (size_t i = 0; i < inductors.size(); ++i) {
+        int k = inductorBranchOffset() + i;
+        branch(inductors[i].node1, inductors[i].node2, k);
+        c[n + k][n + k] = inductors[i].inductance;
+    }
+    for (const auto& d : diodes) {
+        int k = d.getBranchIndex();
+        if (k >= 0 && k < m) branch(d.node1, d.node2, k);
+    }
+    for (const auto& model : reducedModels) {
+        for (size_t r = 0; r < model.G.size(); ++r) {
+            int row = reducedModelIndex(model, r, n + model.firstState);
+            if (row == -1) continue;
+            for (size_t col = 0; col < model.G.size(); ++col) {
+                int k = reducedModelIndex(model, col, n + model.firstState);
+                if (k == -1) continue;
+                g[row][k] += model.G[r][col];
+                c[row][k] += model.C[r][col];
+            }
+        }
     }
 }
 
+vector<double> Circuit::sourceVector(double t) {
+    int n = countNonGroundNodes();
+    int m = countTotalExtraVariables();
+    vector<double> b(n + m, 0.0);
+    for (const auto& cs : currentSources) {
+        int i = getNodeMatrixIndex(cs.node1);
+        int j = getNodeMatrixIndex(cs.node2);
+        double value = cs.valueAt(t);
+        if (i != -1) b[i] += value;
+        if (j != -1) b[j] -= value;
+    }
+    for (size_t i = 0; i < voltageSources.size(); ++i) {
+        b[n + i] = -voltageSources[i].valueAt(t);
+    }
+    for (size_t i = 0; i < acVoltageSources.size(); ++i) {
+        b[n + voltageSources.size() + i] = -acVoltageSources[i].getValue(t);
+    }
+    for (const auto& d : diodes) {
+        int k = d.getBranchIndex();
+        if (k < 0 || k >= m) continue;
+        b[n + k] = -((d.getState() == STATE_REVERSE_ON) ? -d.getZenerVoltage() : d.getForwardVoltage());
+    }
+    return b;
+}
 
 void Circuit::MNA_sol_size() {
     MNA_solution.resize(MNA_A.size());
@@ -474,15 +733,180 @@ void Circuit::setDeltaT(double dt) {
     this->delta_t = dt;
 }
 
+void Circuit::setIntegrationMethod(IntegrationMethod method) {
+    integrationMethod = method;
+}
+
+unique_ptr<Circuit> Circuit::clone() const {
+    unique_ptr<Circuit> copy(new Circuit());
+    for (const Node *node: nodes) {
+        Node *n = copy->findOrCreateNode(node->name);
+        n->setGround(node->isGround);
+        n->setVoltage(node->getVoltage());
+    }
+    auto remap = [&](auto component) {
+        component.node1 = component.node1 ? copy->findNode(component.node1->name) : nullptr;
+        component.node2 = component.node2 ? copy->findNode(component.node2->name) : nullptr;
+        return component;
+    };
+    for (const auto &r: resistors) copy->resistors.push_back(remap(r));
+    for (const auto &c: capacitors) copy->capacitors.push_back(remap(c));
+    for (const auto &l: inductors) copy->inductors.push_back(remap(l));
+    for (const auto &d: diodes) copy->diodes.push_back(remap(d));
+    for (const auto &v: voltageSources) copy->voltageSources.push_back(remap(v));
+    for (const auto &v: acVoltageSources) copy->acVoltageSources.push_back(remap(v));
+    for (const auto &s: currentSources) copy->currentSources.push_back(remap(s));
+    for (const auto &model: reducedModels) {
+        ReducedModel m = model;
+        for (auto &port: m.ports) port = copy->findNode(port->name);
+        copy->reducedModels.push_back(m);
+    }
+    copy->groundNodeNames = groundNodeNames;
+    copy->delta_t = delta_t;
+    copy->integrationMethod = integrationMethod;
+    copy->transientSettings = transientSettings;
+    copy->relaxationSettings = relaxationSettings;
+    copy->pararealSettings = pararealSettings;
+    copy->steadyStateSettings = steadyStateSettings;
+    copy->reductionSettings = reductionSettings;
+    copy->dcSweepSettings = dcSweepSettings;
+    copy->acSweepSettings = acSweepSettings;
+    copy->transferFitSettings = transferFitSettings;
+    copy->homotopySettings = homotopySettings;
+    copy->assignDiodeBranchIndices();
+    return copy;
+}
+
+CircuitState Circuit::captureState() {
+    CircuitState state;
+    for (const Node *node: nodes) {
+        state.nodeVoltages.push_back(node->getVoltage());
+    }
+    for (const auto &ind: inductors) {
+        state.inductorCurrents.push_back(ind.current);
+    }
+    for (auto &d: diodes) {
+        state.diodeStates.push_back(d.getState());
+        state.diodeCurrents.push_back(d.getCurrent());
+        state.junctionVoltages.push_back(d.junctionVoltage);
+    }
+    for (const auto &cap: capacitors) {
+        state.capacitorHistory.push_back(cap.historyState());
+    }
+    for (const auto &ind: inductors) {
+        state.inductorHistory.push_back(ind.historyState());
+    }
+    for (const auto &model: reducedModels) {
+        state.reducedModelHistory.push_back(model.historyState());
+    }
+    state.prevDeltaT = prev_delta_t;
+    state.historyDepth = historyDepth;
+    state.dampingSteps = dampingSteps;
+    return state;
+}
+
+void Circuit::restoreState(const CircuitState &state) {
+    for (size_t i = 0; i < nodes.size() && i < state.nodeVoltages.size(); ++i) {
+        nodes[i]->setVoltage(state.nodeVoltages[i]);
+    }
+    for (size_t i = 0; i < inductors.size() && i < state.inductorCurrents.size(); ++i) {
+        inductors[i].setInductorCurrent(state.inductorCurrents[i]);
+    }
+    for (size_t i = 0; i < diodes.size() && i < state.diodeStates.size(); ++i) {
+        diodes[i].setState(state.diodeStates[i]);
+        diodes[i].setCurrent(state.diodeCurrents[i]);
+        diodes[i].junctionVoltage = state.junctionVoltages[i];
+    }
+    for (size_t i = 0; i < capacitors.size() && i < state.capacitorHistory.size(); ++i) {
+        capacitors[i].restoreHistoryState(state.capacitorHistory[i]);
+    }
+    for (size_t i = 0; i < inductors.size() && i < state.inductorHistory.size(); ++i) {
+        inductors[i].restoreHistoryState(state.inductorHistory[i]);
+    }
+    for (size_t i = 0; i < reducedModels.size() && i < state.reducedModelHistory.size(); ++i) {
+        reducedModels[i].restoreHistoryState(state.reducedModelHistory[i]);
+    }
+    prev_delta_t = state.prevDeltaT;
+    historyDepth = state.historyDepth;
+    dampingSteps = state.dampingSteps;
+    assignDiodeBranchIndices();
+}
+
+// Picks the formula for the next transient step. Backward Euler is used for the first
+// step after a history reset (GEAR2 has no v(n-1) yet) and while damping is requested.
+void Circuit::selectStepMethod() {
+    stepMethod = integrationMethod;
+    if (historyDepth == 0 || dampingSteps > 0) {
+        stepMethod = IntegrationMethod::BACKWARD_EULER;
+    }
+}
+
+void Circuit::requestIntegrationDamping(int steps) {
+    if (integrationMethod == IntegrationMethod::TRAPEZOIDAL) {
+        dampingSteps = max(dampingSteps, steps);
+    }
+}
+
+void Circuit::resetIntegrationHistory() {
+    for (auto &cap: capacitors) {
+        cap.resetHistory();
+    }
+    for (auto &ind: inductors) {
+        ind.resetHistory();
+    }
+    for (auto &model: reducedModels) {
+        model.resetHistory();
+    }
+    prev_delta_t = 0.0;
+    historyDepth = 0;
+    dampingSteps = 0;
+}
+
+bool MatrixStampKey::operator==(const MatrixStampKey& other) const {
+    return method == other.method && dt == other.dt && prev_dt == other.prev_dt && diodeStates == other.diodeStates &&
+           shunt == other.shunt;
+}
+
+MatrixStampKey Circuit::matrixStampKey() const {
+    MatrixStampKey key;
+    key.method = stepMethod;
+    key.dt = delta_t;
+    // Only the variable-step Gear-2 coefficients depend on the previous step
+    key.prev_dt = (stepMethod == IntegrationMethod::GEAR2) ? prev_delta_t : 0.0;
+    for (const auto& diode : diodes) {
+        key.diodeStates.push_back(diode.getState());
+    }
+    key.shunt = homotopyConductance;
+    return key;
+}
+
 void Circuit::updateComponentStates() {
+    bool ringing = false;
     for (auto &cap: capacitors) {
-        cap.update(delta_t);
+        cap.update(delta_t, stepMethod, prev_delta_t);
+        if (cap.ringingCount >= 2) ringing = true;
     }
     for (auto &ind: inductors) {
-        ind.update(delta_t);
+        ind.update(delta_t, stepMethod, prev_delta_t);
+        if (ind.ringingCount >= 2) ringing = true;
+    }
+    for (auto &model: reducedModels) {
+        model.update(delta_t, stepMethod, prev_delta_t);
+    }
+    prev_delta_t = delta_t;
+    historyDepth++;
+    if (dampingSteps > 0) {
+        dampingSteps--;
+    }
+    if (ringing) {
+        requestIntegrationDamping();
     }
 }
 
+double Circuit::bypassTolerance() const {
+    return transientSettings.deviceBypass ? transientSettings.bypassTol : 0.0;
+}
+
 void Circuit::clearComponentHistory() {
     for (Node *node: nodes) {
         node->clearHistory();
@@ -490,6 +914,8 @@ void Circuit::clearComponentHistory() {
     for (auto &vs: voltageSources) {
         vs.clearHistory();
     }
+    acSweepResults.clear();
+    phaseSweepResults.clear();
 }
 
 bool Circuit::isNodeNameGround(const string &node_name) const {
@@ -528,3 +954,92 @@ int Circuit::countNonGroundNodes() const {
 }
 
 
+
+namespace {
+
+// 64-bit FNV-1a over the bytes fed in
+struct ContentHash {
+    uint64_t value = 14695981039346656037ull;
+
+    void bytes(const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            value ^= p[i];
+            value *= 1099511628211ull;
+        }
+    }
+    void add(double v) { bytes(&v, sizeof(v)); }
+    void add(int v) { bytes(&v, sizeof(v)); }
+    void add(const string& s) {
+        add(static_cast<int>(s.size()));
+        bytes(s.data(), s.size());
+    }
+    void add(const Node* node) { add(node ? node->name : string()); }
+};
+
+} // namespace
+
+uint64_t Circuit::topologyHash() const {
+    ContentHash h;
+    for (const Node* node : nodes) {
+        h.add(node->name);
+        h.add(node->isGround ? 1 : 0);
+    }
+    auto connections = [&](const auto& components, int kind) {
+        h.add(kind);
+        h.add(static_cast<int>(components.size()));
+        for (const auto& c : components) {
+            h.add(c.name);
+            h.add(c.node1);
+            h.add(c.node2);
+        }
+    };
+    connections(resistors, 0);
+    connections(capacitors, 1);
+    connections(inductors, 2);
+    connections(diodes, 3);
+    connections(voltageSources, 4);
+    connections(acVoltageSources, 5);
+    connections(currentSources, 6);
+    h.add(7);
+    for (const auto& model : reducedModels) {
+        h.add(model.name);
+        for (const Node* port : model.ports) h.add(port);
+        h.add(static_cast<int>(model.G.size()));
+    }
+    return h.value;
+}
+
+uint64_t Circuit::valueHash() const {
+    ContentHash h;
+    for (const auto& r : resistors) h.add(r.resistance);
+    for (const auto& c : capacitors) h.add(c.capacitance);
+    for (const auto& l : inductors) h.add(l.inductance);
+    for (const auto& d : diodes) {
+        h.add(static_cast<int>(d.getDiodeType()));
+        h.add(static_cast<int>(d.getModel()));
+        h.add(d.getForwardVoltage());
+        h.add(d.getZenerVoltage());
+        h.add(d.saturationCurrent);
+        h.add(d.emissionCoefficient);
+    }
+    auto waveform = [&](const Waveform& w, double value) {
+        h.add(value);
+        h.add(static_cast<int>(w.type));
+        for (double p : w.params) h.add(p);
+        // PWL points are private; the t = 0 value is what the operating point sees
+        h.add(w.valueAt(0.0, value));
+    };
+    for (const auto& v : voltageSources) waveform(v.waveform, v.value);
+    for (const auto& s : currentSources) waveform(s.waveform, s.value);
+    for (const auto& v : acVoltageSources) {
+        h.add(v.magnitude);
+        h.add(v.frequency);
+        h.add(v.phase);
+    }
+    for (const auto& model : reducedModels) {
+        for (const auto& row : model.G) for (double g : row) h.add(g);
+        for (const auto& row : model.C) for (double c : row) h.add(c);
+    }
+    return h.value;
+}
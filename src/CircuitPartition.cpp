@@ -0,0 +1,197 @@
+#include "CircuitPartition.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+// Union-find over the non-ground node indices
+struct NodeSets {
+    vector<int> parent;
+    int count;
+
+    explicit NodeSets(int n) : parent(n), count(n) {
+        iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void join(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) {
+            parent[b] = a;
+            count--;
+        }
+    }
+};
+
+template <typename T>
+void copyInto(Circuit& target, const T& source, vector<T>& components) {
+    T copy = source;
+    copy.node1 = target.findOrCreateNode(source.node1->name);
+    copy.node2 = target.findOrCreateNode(source.node2->name);
+    components.push_back(copy);
+}
+
+} // namespace
+
+vector<CircuitPartition> partitionCircuit(const Circuit& circuit, int maxPartitions) {
+    map<const Node*, int> index;
+    vector<const Node*> nodes;
+    const Node* ground = nullptr;
+    for (const Node* node : circuit.nodes) {
+        if (node->isGround) {
+            if (!ground) ground = node;
+            continue;
+        }
+        index[node] = nodes.size();
+        nodes.push_back(node);
+    }
+    if (!ground) {
+        throw runtime_error("Waveform relaxation needs a ground node.");
+    }
+    auto indexOf = [&](const Node* node) {
+        auto it = node ? index.find(node) : index.end();
+        return it != index.end() ? it->second : -1;
+    };
+
+    // Everything but resistors is a strong coupling and never cut
+    NodeSets sets(nodes.size());
+    auto joinNodes = [&](const Node* a, const Node* b) {
+        int i = indexOf(a), j = indexOf(b);
+        if (i != -1 && j != -1) sets.join(i, j);
+    };
+    for (const auto& c : circuit.capacitors) joinNodes(c.node1, c.node2);
+    for (const auto& l : circuit.inductors) joinNodes(l.node1, l.node2);
+    for (const auto& d : circuit.diodes) joinNodes(d.node1, d.node2);
+    for (const auto& v : circuit.voltageSources) joinNodes(v.node1, v.node2);
+    for (const auto& v : circuit.acVoltageSources) joinNodes(v.node1, v.node2);
+    for (const auto& s : circuit.currentSources) joinNodes(s.node1, s.node2);
+    for (const auto& model : circuit.reducedModels) {
+        for (const Node* port : model.ports) joinNodes(model.ports.front(), port);
+    }
+
+    vector<size_t> order(circuit.resistors.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return circuit.resistors[a].resistance < circuit.resistors[b].resistance;
+    });
+    for (size_t r : order) {
+        if (sets.count <= max(1, maxPartitions)) break;
+        joinNodes(circuit.resistors[r].node1, circuit.resistors[r].node2);
+    }
+
+    // Partition ids in order of first appearance, so the split is deterministic
+    map<int, int> partitionOf;
+    vector<int> nodePartition(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        int root = sets.find(i);
+        if (partitionOf.find(root) == partitionOf.end()) {
+            int id = partitionOf.size();
+            partitionOf[root] = id;
+        }
+        nodePartition[i] = partitionOf[root];
+    }
+
+    vector<CircuitPartition> partitions(partitionOf.size());
+    for (auto& part : partitions) {
+        part.circuit.reset(new Circuit());
+        Circuit& sub = *part.circuit;
+        sub.groundNodeNames = circuit.groundNodeNames;
+        sub.transientSettings = circuit.transientSettings;
+        sub.setIntegrationMethod(circuit.integrationMethod);
+        for (const Node* node : circuit.nodes) {
+            if (node->isGround) sub.findOrCreateNode(node->name)->setGround(true);
+        }
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        CircuitPartition& part = partitions[nodePartition[i]];
+        part.circuit->findOrCreateNode(nodes[i]->name)->setVoltage(nodes[i]->getVoltage());
+        part.ownedNodes.push_back(nodes[i]->name);
+    }
+
+    // Owner of a component: the partition of its first non-ground node (-1 if fully grounded)
+    auto ownerOf = [&](const Node* a, const Node* b) {
+        int i = indexOf(a);
+        if (i == -1) i = indexOf(b);
+        return i != -1 ? nodePartition[i] : -1;
+    };
+    for (const auto& c : circuit.capacitors) {
+        int p = ownerOf(c.node1, c.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, c, partitions[p].circuit->capacitors);
+    }
+    for (const auto& l : circuit.inductors) {
+        int p = ownerOf(l.node1, l.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, l, partitions[p].circuit->inductors);
+    }
+    for (const auto& d : circuit.diodes) {
+        int p = ownerOf(d.node1, d.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, d, partitions[p].circuit->diodes);
+    }
+    for (const auto& v : circuit.voltageSources) {
+        int p = ownerOf(v.node1, v.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, v, partitions[p].circuit->voltageSources);
+    }
+    for (const auto& v : circuit.acVoltageSources) {
+        int p = ownerOf(v.node1, v.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, v, partitions[p].circuit->acVoltageSources);
+    }
+    for (const auto& s : circuit.currentSources) {
+        int p = ownerOf(s.node1, s.node2);
+        if (p != -1) copyInto(*partitions[p].circuit, s, partitions[p].circuit->currentSources);
+    }
+    for (const auto& model : circuit.reducedModels) {
+        int p = model.ports.empty() ? -1 : ownerOf(model.ports.front(), nullptr);
+        if (p == -1) continue;
+        ReducedModel copy = model;
+        for (auto& port : copy.ports) port = partitions[p].circuit->findOrCreateNode(port->name);
+        partitions[p].circuit->reducedModels.push_back(copy);
+    }
+
+    auto addBoundary = [&](int p, const Node* node) {
+        CircuitPartition& part = partitions[p];
+        if (find(part.boundaryNodes.begin(), part.boundaryNodes.end(), node->name) == part.boundaryNodes.end()) {
+            part.circuit->findOrCreateNode(node->name)->setVoltage(node->getVoltage());
+            part.boundaryNodes.push_back(node->name);
+            part.boundaryOwners.push_back(nodePartition[indexOf(node)]);
+        }
+    };
+    for (const auto& r : circuit.resistors) {
+        int p1 = ownerOf(r.node1, nullptr), p2 = ownerOf(r.node2, nullptr);
+        if (p1 == -1 && p2 == -1) continue;
+        if (p1 == -1 || p2 == -1 || p1 == p2) {
+            int p = (p1 != -1) ? p1 : p2;
+            copyInto(*partitions[p].circuit, r, partitions[p].circuit->resistors);
+            continue;
+        }
+        copyInto(*partitions[p1].circuit, r, partitions[p1].circuit->resistors);
+        copyInto(*partitions[p2].circuit, r, partitions[p2].circuit->resistors);
+        addBoundary(p1, r.node2);
+        addBoundary(p2, r.node1);
+    }
+
+    for (auto& part : partitions) {
+        Circuit& sub = *part.circuit;
+        part.firstDriver = sub.voltageSources.size();
+        for (const string& name : part.boundaryNodes) {
+            VoltageSource driver;
+            driver.name = "WR_" + name;
+            driver.node1 = sub.findOrCreateNode(name);
+            driver.node2 = sub.findOrCreateNode(ground->name);
+            driver.value = sub.findNode(name)->getVoltage();
+            sub.voltageSources.push_back(driver);
+        }
+        sub.assignDiodeBranchIndices();
+    }
+    return partitions;
+}
@@ -1,22 +1,56 @@
 #include "CircuitSimulatorInterface.h"
 #include "Analysis.h"
+#include "ModelReduction.h"
 #include <cstring>
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 // --- HELPER FUNCTION ---
 // Safely copies a C++ string to a C-style char buffer provided by C#
 void safeStringCopy(char* buffer, int bufferSize, const std::string& source) {
     if (buffer && bufferSize > 0) {
         if (source.length() < static_cast<size_t>(bufferSize)) {
-            strcpy_s(buffer, bufferSize, source.c_str());
+            memcpy(buffer, source.c_str(), source.length() + 1);
         } else {
             buffer[0] = '\0'; // Indicate error or insufficient buffer
         }
     }
 }
 
+// Assigns a transient waveform to the voltage or current source with the given name
+bool setSourceWaveform(Circuit* circuit, const std::string& sourceName, const Waveform& waveform) {
+    if (VoltageSource* vs = circuit->findVoltageSource(sourceName)) {
+        vs->waveform = waveform;
+        return true;
+    }
+    if (CurrentSource* cs = circuit->findCurrentSource(sourceName)) {
+        cs->waveform = waveform;
+        return true;
+    }
+    return false;
+}
+
+// Copies one signal of the AC (analysis 0) or phase (analysis 1) sweep: the sweep values go to
+// sweep, and values get the magnitude (view 0), dB (view 1) or phase in degrees (view 2)
+int copySweepSignal(Circuit* circuit, int analysis, const std::string& signal, int view, double* sweep,
+                    double* values, int maxCount) {
+    const PhasorSweep& results = analysis == 0 ? circuit->acSweepResults : circuit->phaseSweepResults;
+    int index = results.signalIndex(signal);
+    if (index == -1) return 0;
+    int count = 0;
+    for (size_t i = 0; i < results.points() && count < maxCount; ++i, ++count) {
+        sweep[count] = results.sweep[i];
+        switch (view) {
+            case 1: values[count] = results.decibels(i, index); break;
+            case 2: values[count] = results.phaseDegrees(i, index); break;
+            default: values[count] = results.magnitude(i, index); break;
+        }
+    }
+    return count;
+}
+
 extern "C" {
     void* CreateCircuit() {
         try {
@@ -103,6 +137,26 @@ extern "C" {
         } catch (...) {}
     }
     
+    void AddDiode(void* circuit, const char* name, const char* anode, const char* cathode, double forwardVoltage) {
+        if (!circuit || !name || !anode || !cathode) return;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            Node* n1 = c->findOrCreateNode(anode);
+            Node* n2 = c->findOrCreateNode(cathode);
+            c->diodes.emplace_back(name, n1, n2, NORMAL, forwardVoltage);
+        } catch (...) {}
+    }
+
+    void AddZenerDiode(void* circuit, const char* name, const char* anode, const char* cathode, double forwardVoltage, double zenerVoltage) {
+        if (!circuit || !name || !anode || !cathode) return;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            Node* n1 = c->findOrCreateNode(anode);
+            Node* n2 = c->findOrCreateNode(cathode);
+            c->diodes.emplace_back(name, n1, n2, ZENER, forwardVoltage, zenerVoltage);
+        } catch (...) {}
+    }
+    
     void AddACVoltageSource(void* circuit, const char* name, const char* node1, const char* node2, double magnitude, double phase) {
         if (!circuit || !name || !node1 || !node2) return;
         try {
@@ -130,6 +184,254 @@ extern "C" {
         } catch (...) {}
     }
 
+    void SetIntegrationMethod(void* circuit, int method) {
+        if (!circuit || method < 0 || method > 2) return;
+        try {
+            static_cast<Circuit*>(circuit)->setIntegrationMethod(static_cast<IntegrationMethod>(method));
+        } catch (...) {}
+    }
+
+    bool SetDiodeModel(void* circuit, const char* diodeName, int model, double saturationCurrent, double emissionCoefficient) {
+        if (!circuit || !diodeName || model < 0 || model > 1) return false;
+        try {
+            Diode* d = static_cast<Circuit*>(circuit)->findDiode(diodeName);
+            if (!d) return false;
+            d->setModel(static_cast<DiodeModel>(model));
+            if (saturationCurrent > 0.0) d->saturationCurrent = saturationCurrent;
+            if (emissionCoefficient > 0.0) d->emissionCoefficient = emissionCoefficient;
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    void SetTransientStepControl(void* circuit, bool adaptive, double relTol, double absTol, double minStep, double maxStep) {
+        if (!circuit) return;
+        try {
+            TransientSettings& settings = static_cast<Circuit*>(circuit)->transientSettings;
+            settings.adaptiveStep = adaptive;
+            if (relTol > 0.0) settings.relTol = relTol;
+            if (absTol > 0.0) settings.absTol = absTol;
+            settings.minStep = max(0.0, minStep);
+            settings.maxStep = max(0.0, maxStep);
+        } catch (...) {}
+    }
+
+    void SetDeviceBypass(void* circuit, bool enabled, double tolerance) {
+        if (!circuit) return;
+        try {
+            TransientSettings& settings = static_cast<Circuit*>(circuit)->transientSettings;
+            settings.deviceBypass = enabled;
+            if (tolerance > 0.0) settings.bypassTol = tolerance;
+        } catch (...) {}
+    }
+
+    void SetFactorizationCache(void* circuit, int entries) {
+        if (!circuit) return;
+        try {
+            static_cast<Circuit*>(circuit)->transientSettings.factorizationCacheEntries = max(0, entries);
+        } catch (...) {}
+    }
+
+    void SetSteadyStateStop(void* circuit, bool enabled, double period, double relTol, double absTol) {
+        if (!circuit) return;
+        try {
+            TransientSettings& settings = static_cast<Circuit*>(circuit)->transientSettings;
+            settings.steadyStateStop = enabled;
+            settings.steadyStatePeriod = max(0.0, period);
+            if (relTol > 0.0) settings.steadyStateRelTol = relTol;
+            if (absTol > 0.0) settings.steadyStateAbsTol = absTol;
+        } catch (...) {}
+    }
+
+    void SetExponentialIntegrator(void* circuit, bool enabled, double tolerance, int maxKrylovDimension) {
+        if (!circuit) return;
+        try {
+            TransientSettings& settings = static_cast<Circuit*>(circuit)->transientSettings;
+            settings.exponentialIntegrator = enabled;
+            if (tolerance > 0.0) settings.exponentialTol = tolerance;
+            if (maxKrylovDimension > 0) settings.maxKrylovDimension = maxKrylovDimension;
+        } catch (...) {}
+    }
+
+    void SetTransientCheckpoint(void* circuit, const char* path, double interval) {
+        if (!circuit) return;
+        try {
+            TransientSettings& settings = static_cast<Circuit*>(circuit)->transientSettings;
+            settings.checkpointPath = path ? path : "";
+            settings.checkpointInterval = path ? max(0.0, interval) : 0.0;
+        } catch (...) {}
+    }
+
+    void SetWaveformRelaxation(void* circuit, int partitions, double windowLength, int maxIterations, double tolerance, bool gaussSeidel) {
+        if (!circuit) return;
+        try {
+            RelaxationSettings& settings = static_cast<Circuit*>(circuit)->relaxationSettings;
+            settings.partitions = max(0, partitions);
+            settings.windowLength = max(0.0, windowLength);
+            if (maxIterations > 0) settings.maxIterations = maxIterations;
+            if (tolerance > 0.0) settings.relTol = tolerance;
+            settings.gaussSeidel = gaussSeidel;
+        } catch (...) {}
+    }
+
+    void SetParareal(void* circuit, int slices, int coarseSteps, int maxIterations, double tolerance) {
+        if (!circuit) return;
+        try {
+            PararealSettings& settings = static_cast<Circuit*>(circuit)->pararealSettings;
+            settings.slices = max(0, slices);
+            if (coarseSteps > 0) settings.coarseSteps = coarseSteps;
+            settings.maxIterations = max(0, maxIterations);
+            if (tolerance > 0.0) settings.relTol = tolerance;
+        } catch (...) {}
+    }
+
+    void SetSteadyStateOptions(void* circuit, int maxNewtonIterations, int maxKrylovIterations, double relTol, double absTol, int warmupPeriods) {
+        if (!circuit) return;
+        try {
+            SteadyStateSettings& settings = static_cast<Circuit*>(circuit)->steadyStateSettings;
+            if (maxNewtonIterations > 0) settings.maxNewtonIterations = maxNewtonIterations;
+            if (maxKrylovIterations > 0) settings.maxKrylovIterations = maxKrylovIterations;
+            if (relTol > 0.0) settings.relTol = relTol;
+            if (absTol > 0.0) settings.absTol = absTol;
+            settings.warmupPeriods = max(0, warmupPeriods);
+        } catch (...) {}
+    }
+
+    void SetOperatingPointReuse(void* circuit, bool enabled) {
+        if (!circuit) return;
+        Circuit* c = static_cast<Circuit*>(circuit);
+        c->reuseOperatingPoint = enabled;
+        if (!enabled) c->operatingPoint = OperatingPoint();
+    }
+
+    void SetHomotopyOptions(void* circuit, bool enabled, double gminStart, double gminFinal, int maxSteps) {
+        if (!circuit) return;
+        try {
+            HomotopySettings& settings = static_cast<Circuit*>(circuit)->homotopySettings;
+            settings.enabled = enabled;
+            if (gminStart > 0.0) settings.gminStart = gminStart;
+            if (gminFinal > 0.0) settings.gminFinal = gminFinal;
+            if (maxSteps > 0) settings.maxSteps = maxSteps;
+        } catch (...) {}
+    }
+
+    void SetDCSweepOptions(void* circuit, int segments, int minSegmentPoints) {
+        if (!circuit) return;
+        try {
+            DcSweepSettings& settings = static_cast<Circuit*>(circuit)->dcSweepSettings;
+            settings.segments = max(0, segments);
+            if (minSegmentPoints > 0) settings.minSegmentPoints = minSegmentPoints;
+        } catch (...) {}
+    }
+
+    void SetACSweepOptions(void* circuit, int threads, int minThreadPoints) {
+        if (!circuit) return;
+        try {
+            AcSweepSettings& settings = static_cast<Circuit*>(circuit)->acSweepSettings;
+            settings.threads = max(0, threads);
+            if (minThreadPoints > 0) settings.minThreadPoints = minThreadPoints;
+        } catch (...) {}
+    }
+
+    void SetFastACSweep(void* circuit, bool enabled, int moments, int maxExpansionPoints, double tolerance) {
+        if (!circuit) return;
+        try {
+            AcSweepSettings& settings = static_cast<Circuit*>(circuit)->acSweepSettings;
+            settings.fastSweep = enabled;
+            if (moments > 0) settings.fastSweepMoments = moments;
+            if (maxExpansionPoints > 0) settings.fastSweepMaxExpansions = maxExpansionPoints;
+            if (tolerance > 0.0) settings.fastSweepTol = tolerance;
+        } catch (...) {}
+    }
+
+    void SetAdaptiveACSweep(void* circuit, int initialPoints, double tolerance) {
+        if (!circuit) return;
+        try {
+            AcSweepSettings& settings = static_cast<Circuit*>(circuit)->acSweepSettings;
+            if (initialPoints >= 2) settings.adaptiveInitialPoints = initialPoints;
+            if (tolerance > 0.0) settings.adaptiveTol = tolerance;
+        } catch (...) {}
+    }
+
+    bool KeepNodeObservable(void* circuit, const char* nodeName) {
+        if (!circuit || !nodeName) return false;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            if (!c->findNode(nodeName)) return false;
+            c->reductionSettings.keepNodes.push_back(nodeName);
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool AddTransferFunctionOutput(void* circuit, const char* signalName) {
+        if (!circuit || !signalName || !*signalName) return false;
+        try {
+            static_cast<Circuit*>(circuit)->transferFitSettings.outputs.push_back(signalName);
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    void ClearTransferFunctionOutputs(void* circuit) {
+        if (!circuit) return;
+        static_cast<Circuit*>(circuit)->transferFitSettings.outputs.clear();
+    }
+
+    void SetTransferFitOptions(void* circuit, int samples, int iterations, int maxOrder, double tolerance) {
+        if (!circuit) return;
+        TransferFitSettings& settings = static_cast<Circuit*>(circuit)->transferFitSettings;
+        if (samples > 0) settings.samples = samples;
+        if (iterations > 0) settings.iterations = iterations;
+        if (maxOrder > 0) settings.maxOrder = maxOrder;
+        if (tolerance > 0.0) settings.tol = tolerance;
+    }
+
+    bool SetSourceSinWaveform(void* circuit, const char* sourceName, double offset, double amplitude, double frequency, double delay, double damping, double phase) {
+        if (!circuit || !sourceName) return false;
+        try {
+            return setSourceWaveform(static_cast<Circuit*>(circuit), sourceName,
+                                     Waveform::sine(offset, amplitude, frequency, delay, damping, phase));
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool SetSourcePulseWaveform(void* circuit, const char* sourceName, double v1, double v2, double delay, double rise, double fall, double width, double period) {
+        if (!circuit || !sourceName) return false;
+        try {
+            return setSourceWaveform(static_cast<Circuit*>(circuit), sourceName,
+                                     Waveform::pulse(v1, v2, delay, rise, fall, width, period));
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool SetSourceExpWaveform(void* circuit, const char* sourceName, double v1, double v2, double delay1, double tau1, double delay2, double tau2) {
+        if (!circuit || !sourceName) return false;
+        try {
+            return setSourceWaveform(static_cast<Circuit*>(circuit), sourceName,
+                                     Waveform::exponential(v1, v2, delay1, tau1, delay2, tau2));
+        } catch (...) {
+            return false;
+        }
+    }
+
+    bool SetSourcePwlWaveform(void* circuit, const char* sourceName, const double* times, const double* values, int count) {
+        if (!circuit || !sourceName || !times || !values || count <= 0) return false;
+        try {
+            std::vector<double> t(times, times + count);
+            std::vector<double> v(values, values + count);
+            return setSourceWaveform(static_cast<Circuit*>(circuit), sourceName, Waveform::piecewiseLinear(t, v));
+        } catch (const std::exception& e) {
+            std::cerr << "PWL Waveform Error: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
     bool RunDCAnalysis(void* circuit) {
         if (!circuit) return false;
         try {
@@ -144,6 +446,21 @@ extern "C" {
         }
     }
 
+    bool RunDCSweepAnalysis(void* circuit, const char* sourceName, double start, double end, double step) {
+        if (!circuit || !sourceName) return false;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            dcSweepAnalysis(*c, sourceName, start, end, step);
+            return c->dcSweepStats.points > 0;
+        } catch (const std::exception& e) {
+            std::cerr << "DC Sweep Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in DC Sweep." << std::endl;
+            return false;
+        }
+    }
+
     bool RunTransientAnalysis(void* circuit, double stepTime, double stopTime) {
         if (!circuit) return false;
         try {
@@ -158,6 +475,58 @@ extern "C" {
         }
     }
 
+    bool ResumeTransientAnalysis(void* circuit, const char* checkpointPath, double stopTime) {
+        if (!circuit || !checkpointPath) return false;
+        try {
+            return resumeTransientAnalysis(*static_cast<Circuit*>(circuit), checkpointPath, stopTime);
+        } catch (const std::exception& e) {
+            std::cerr << "Transient Resume Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in Transient Resume." << std::endl;
+            return false;
+        }
+    }
+
+    bool RunWaveformRelaxationAnalysis(void* circuit, double stepTime, double stopTime) {
+        if (!circuit) return false;
+        try {
+            return waveformRelaxationAnalysis(*static_cast<Circuit*>(circuit), stepTime, stopTime);
+        } catch (const std::exception& e) {
+            std::cerr << "Waveform Relaxation Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in Waveform Relaxation." << std::endl;
+            return false;
+        }
+    }
+
+    bool RunPararealAnalysis(void* circuit, double stepTime, double stopTime) {
+        if (!circuit) return false;
+        try {
+            return pararealAnalysis(*static_cast<Circuit*>(circuit), stepTime, stopTime);
+        } catch (const std::exception& e) {
+            std::cerr << "Parareal Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in Parareal." << std::endl;
+            return false;
+        }
+    }
+
+    bool RunPeriodicSteadyStateAnalysis(void* circuit, double stepTime, double period) {
+        if (!circuit) return false;
+        try {
+            return periodicSteadyStateAnalysis(*static_cast<Circuit*>(circuit), stepTime, period);
+        } catch (const std::exception& e) {
+            std::cerr << "Periodic Steady-State Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in Periodic Steady-State Analysis." << std::endl;
+            return false;
+        }
+    }
+
     bool RunACAnalysis(void* circuit, const char* sourceName, double startFreq, double stopFreq, int numPoints, const char* sweepType) {
         if (!circuit || !sourceName || !sweepType) return false;
         try {
@@ -186,6 +555,64 @@ extern "C" {
         }
     }
 
+    bool RunTransferFunctionAnalysis(void* circuit, const char* sourceName, double startFreq, double stopFreq, int order) {
+        if (!circuit || !sourceName) return false;
+        try {
+            return transferFunctionAnalysis(*static_cast<Circuit*>(circuit), sourceName, startFreq, stopFreq, order);
+        } catch (const std::exception& e) {
+            std::cerr << "Transfer Function Analysis Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in Transfer Function Analysis." << std::endl;
+            return false;
+        }
+    }
+
+    bool RunDCSensitivityAnalysis(void* circuit, const char* output) {
+        if (!circuit || !output) return false;
+        try {
+            return dcSensitivityAnalysis(*static_cast<Circuit*>(circuit), output);
+        } catch (const std::exception& e) {
+            std::cerr << "DC Sensitivity Analysis Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in DC Sensitivity Analysis." << std::endl;
+            return false;
+        }
+    }
+
+    bool RunACSensitivityAnalysis(void* circuit, const char* output, double frequency) {
+        if (!circuit || !output) return false;
+        try {
+            return acSensitivityAnalysis(*static_cast<Circuit*>(circuit), output, frequency);
+        } catch (const std::exception& e) {
+            std::cerr << "AC Sensitivity Analysis Exception: " << e.what() << std::endl;
+            return false;
+        } catch (...) {
+            std::cerr << "Unknown exception in AC Sensitivity Analysis." << std::endl;
+            return false;
+        }
+    }
+
+    int ReduceLinearSubnetworks(void* circuit, int minInternalNodes, int moments, int maxOrder, double expansionFrequency) {
+        if (!circuit) return -1;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            ReductionSettings& settings = c->reductionSettings;
+            if (minInternalNodes > 0) settings.minInternalNodes = minInternalNodes;
+            if (moments > 0) settings.moments = moments;
+            if (maxOrder > 0) settings.maxOrder = maxOrder;
+            settings.expansionFrequency = max(0.0, expansionFrequency);
+            return reduceLinearSubnetworks(*c);
+        } catch (const std::exception& e) {
+            std::cerr << "Model Reduction Exception: " << e.what() << std::endl;
+            return -1;
+        } catch (...) {
+            std::cerr << "Unknown exception in Model Reduction." << std::endl;
+            return -1;
+        }
+    }
+
     double GetNodeVoltage(void* circuit, const char* nodeName) {
         if (!circuit || !nodeName) return 0.0;
         try {
@@ -237,16 +664,16 @@ extern "C" {
         }
     }
 
-    int GetNodeSweepHistory(void* circuit, const char* nodeName, double* frequencies, double* magnitudes, int maxCount) {
-        if (!circuit || !nodeName || !frequencies || !magnitudes || maxCount <= 0) return 0;
+    int GetNodeDCSweepHistory(void* circuit, const char* nodeName, double* sweepValues, double* voltages, int maxCount) {
+        if (!circuit || !nodeName || !sweepValues || !voltages || maxCount <= 0) return 0;
         try {
             Node* node = static_cast<Circuit*>(circuit)->findNode(nodeName);
             if (node) {
                 int count = 0;
-                for (const auto& point : node->ac_sweep_history) {
+                for (const auto& point : node->dc_sweep_history) {
                     if (count >= maxCount) break;
-                    frequencies[count] = point.first;
-                    magnitudes[count] = point.second;
+                    sweepValues[count] = point.first;
+                    voltages[count] = point.second;
                     count++;
                 }
                 return count;
@@ -257,21 +684,133 @@ extern "C" {
         }
     }
 
+    int GetNodeSweepHistory(void* circuit, const char* nodeName, double* frequencies, double* magnitudes, int maxCount) {
+        if (!circuit || !nodeName || !frequencies || !magnitudes || maxCount <= 0) return 0;
+        try {
+            return copySweepSignal(static_cast<Circuit*>(circuit), 0, std::string("V(") + nodeName + ")", 0,
+                                   frequencies, magnitudes, maxCount);
+        } catch (...) {
+            return 0;
+        }
+    }
+
     int GetNodePhaseSweepHistory(void* circuit, const char* nodeName, double* phases, double* magnitudes, int maxCount) {
         if (!circuit || !nodeName || !phases || !magnitudes || maxCount <= 0) return 0;
         try {
-            Node* node = static_cast<Circuit*>(circuit)->findNode(nodeName);
-            if (node) {
-                int count = 0;
-                for (const auto& point : node->phase_sweep_history) {
-                    if (count >= maxCount) break;
-                    phases[count] = point.first;
-                    magnitudes[count] = point.second;
-                    count++;
-                }
-                return count;
+            return copySweepSignal(static_cast<Circuit*>(circuit), 1, std::string("V(") + nodeName + ")", 0,
+                                   phases, magnitudes, maxCount);
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    int GetSweepSignal(void* circuit, int analysis, const char* signalName, int view, double* sweepValues, double* values, int maxCount) {
+        if (!circuit || !signalName || !sweepValues || !values || maxCount <= 0) return 0;
+        try {
+            return copySweepSignal(static_cast<Circuit*>(circuit), analysis, signalName, view, sweepValues, values, maxCount);
+        } catch (...) {
+            return 0;
+        }
+    }
+
+    int GetSweepPhasors(void* circuit, int analysis, const char* signalName, double* sweepValues, double* real, double* imag, int maxCount) {
+        if (!circuit || !signalName || !sweepValues || !real || !imag || maxCount <= 0) return 0;
+        try {
+            Circuit* c = static_cast<Circuit*>(circuit);
+            const PhasorSweep& results = analysis == 0 ? c->acSweepResults : c->phaseSweepResults;
+            int index = results.signalIndex(signalName);
+            if (index == -1) return 0;
+            int count = 0;
+            for (size_t i = 0; i < results.points() && count < maxCount; ++i, ++count) {
+                complex<double> value = results.phasor(i, index);
+                sweepValues[count] = results.sweep[i];
+                real[count] = value.real();
+                imag[count] = value.imag();
             }
+            return count;
+        } catch (...) {
             return 0;
+        }
+    }
+
+    bool EvaluateTransferFunction(void* circuit, const char* signalName, double frequency, double* real, double* imag) {
+        if (!circuit || !signalName || !real || !imag) return false;
+        const TransferFunction& model = static_cast<Circuit*>(circuit)->transferFunction;
+        int index = model.signalIndex(signalName);
+        if (index == -1) return false;
+        complex<double> value = model.evaluate(index, frequency);
+        *real = value.real();
+        *imag = value.imag();
+        return true;
+    }
+
+    bool EvaluateImpulseResponse(void* circuit, const char* signalName, double time, double* value) {
+        if (!circuit || !signalName || !value) return false;
+        const TransferFunction& model = static_cast<Circuit*>(circuit)->transferFunction;
+        int index = model.signalIndex(signalName);
+        if (index == -1) return false;
+        *value = model.impulseResponse(index, time);
+        return true;
+    }
+
+    int GetTransferFunctionPoles(void* circuit, double* real, double* imag, int maxCount) {
+        if (!circuit || !real || !imag || maxCount <= 0) return 0;
+        const TransferFunction& model = static_cast<Circuit*>(circuit)->transferFunction;
+        int count = 0;
+        for (; count < static_cast<int>(model.order()) && count < maxCount; ++count) {
+            real[count] = model.poles[count].real();
+            imag[count] = model.poles[count].imag();
+        }
+        return count;
+    }
+
+    int GetTransferFunctionResidues(void* circuit, const char* signalName, double* real, double* imag, int maxCount, double* constant, double* proportional) {
+        if (!circuit || !signalName || !real || !imag || maxCount <= 0) return 0;
+        const TransferFunction& model = static_cast<Circuit*>(circuit)->transferFunction;
+        int index = model.signalIndex(signalName);
+        if (index == -1) return 0;
+        int count = 0;
+        for (; count < static_cast<int>(model.order()) && count < maxCount; ++count) {
+            real[count] = model.residues[index][count].real();
+            imag[count] = model.residues[index][count].imag();
+        }
+        if (constant) *constant = model.constants[index];
+        if (proportional) *proportional = model.proportional[index];
+        return count;
+    }
+
+    bool GetSensitivity(void* circuit, const char* componentName, double* real, double* imag) {
+        if (!circuit || !componentName || !real || !imag) return false;
+        const SensitivityResults& results = static_cast<Circuit*>(circuit)->sensitivity;
+        for (size_t i = 0; i < results.components.size(); ++i) {
+            if (results.components[i] != componentName) continue;
+            *real = results.derivatives[i].real();
+            *imag = results.derivatives[i].imag();
+            return true;
+        }
+        return false;
+    }
+
+    bool GetSensitivityOutput(void* circuit, double* real, double* imag) {
+        if (!circuit || !real || !imag) return false;
+        const SensitivityResults& results = static_cast<Circuit*>(circuit)->sensitivity;
+        if (results.output.empty()) return false;
+        *real = results.value.real();
+        *imag = results.value.imag();
+        return true;
+    }
+
+    int GetSensitivityComponentNames(void* circuit, char* namesBuffer, int bufferSize) {
+        if (!circuit || !namesBuffer || bufferSize <= 0) return 0;
+        try {
+            const SensitivityResults& results = static_cast<Circuit*>(circuit)->sensitivity;
+            std::string allNames;
+            for (size_t i = 0; i < results.components.size(); ++i) {
+                if (i > 0) allNames += ",";
+                allNames += results.components[i];
+            }
+            safeStringCopy(namesBuffer, bufferSize, allNames);
+            return static_cast<int>(allNames.length());
         } catch (...) {
             return 0;
         }
@@ -326,5 +865,91 @@ extern "C" {
             return 0.0;
         }
     }
+
+    void GetDeviceActivity(void* circuit, int* evaluated, int* bypassed) {
+        if (!circuit) return;
+        const DeviceActivity& activity = static_cast<Circuit*>(circuit)->deviceActivity;
+        if (evaluated) *evaluated = static_cast<int>(activity.evaluated);
+        if (bypassed) *bypassed = static_cast<int>(activity.bypassed);
+    }
+
+    void GetFactorizationCacheStats(void* circuit, int* hits, int* misses) {
+        if (!circuit) return;
+        const TransientStats& stats = static_cast<Circuit*>(circuit)->transientStats;
+        if (hits) *hits = static_cast<int>(stats.cacheHits);
+        if (misses) *misses = static_cast<int>(stats.cacheMisses);
+    }
+
+    bool GetTransientEarlyStop(void* circuit, double* stopTime, bool* periodic) {
+        if (!circuit) return false;
+        const TransientStats& stats = static_cast<Circuit*>(circuit)->transientStats;
+        if (stopTime) *stopTime = stats.earlyStopTime;
+        if (periodic) *periodic = stats.earlyStopPeriodic;
+        return stats.earlyStopTime >= 0.0;
+    }
+
+    void GetPararealStats(void* circuit, int* iterations, double* estimatedSpeedup, double* wallTime) {
+        if (!circuit) return;
+        const PararealStats& stats = static_cast<Circuit*>(circuit)->pararealStats;
+        if (iterations) *iterations = stats.iterations;
+        if (estimatedSpeedup) *estimatedSpeedup = stats.estimatedSpeedup;
+        if (wallTime) *wallTime = stats.wallTime;
+    }
+
+    void GetSteadyStateStats(void* circuit, int* newtonIterations, int* krylovIterations, int* periods) {
+        if (!circuit) return;
+        const SteadyStateStats& stats = static_cast<Circuit*>(circuit)->steadyStateStats;
+        if (newtonIterations) *newtonIterations = stats.newtonIterations;
+        if (krylovIterations) *krylovIterations = stats.krylovIterations;
+        if (periods) *periods = static_cast<int>(stats.periods);
+    }
+
+    void GetHomotopyStats(void* circuit, int* method, int* steps, int* failedSteps) {
+        if (!circuit) return;
+        const HomotopyStats& stats = static_cast<Circuit*>(circuit)->homotopyStats;
+        if (method) *method = static_cast<int>(stats.method);
+        if (steps) *steps = static_cast<int>(stats.steps);
+        if (failedSteps) *failedSteps = static_cast<int>(stats.failedSteps);
+    }
+
+    void GetDCSweepStats(void* circuit, int* points, int* factorizations, int* segments) {
+        if (!circuit) return;
+        const DcSweepStats& stats = static_cast<Circuit*>(circuit)->dcSweepStats;
+        if (points) *points = static_cast<int>(stats.points);
+        if (factorizations) *factorizations = static_cast<int>(stats.factorizations);
+        if (segments) *segments = stats.segments;
+    }
+
+    void GetACSweepStats(void* circuit, int* points, int* threads, int* refinementPasses) {
+        if (!circuit) return;
+        const AcSweepStats& stats = static_cast<Circuit*>(circuit)->acSweepStats;
+        if (points) *points = static_cast<int>(stats.points);
+        if (threads) *threads = stats.threads;
+        if (refinementPasses) *refinementPasses = stats.refinementPasses;
+    }
+
+    void GetFastACSweepStats(void* circuit, int* expansionPoints, int* reducedOrder, int* directPoints) {
+        if (!circuit) return;
+        const AcSweepStats& stats = static_cast<Circuit*>(circuit)->acSweepStats;
+        if (expansionPoints) *expansionPoints = stats.expansionPoints;
+        if (reducedOrder) *reducedOrder = stats.reducedOrder;
+        if (directPoints) *directPoints = static_cast<int>(stats.directPoints);
+    }
+
+    void GetTransferFunctionStats(void* circuit, int* order, double* rmsError) {
+        if (!circuit) return;
+        const TransferFunction& model = static_cast<Circuit*>(circuit)->transferFunction;
+        if (order) *order = model.order();
+        if (rmsError) *rmsError = model.rmsError;
+    }
+
+    void GetReductionStats(void* circuit, int* subnetworks, int* removedNodes, int* removedComponents, int* states) {
+        if (!circuit) return;
+        const ReductionStats& stats = static_cast<Circuit*>(circuit)->reductionStats;
+        if (subnetworks) *subnetworks = stats.subnetworks;
+        if (removedNodes) *removedNodes = stats.removedNodes;
+        if (removedComponents) *removedComponents = stats.removedComponents;
+        if (states) *states = stats.states;
+    }
 }
 
@@ -11,4 +11,8 @@ double CurrentSource::getCurrent() {
 double CurrentSource::getVoltage() {
     if (!node1 || !node2) return 0.0;
     return fabs(node1->getVoltage() - node2->getVoltage());
+}
+
+double CurrentSource::valueAt(double time) const {
+    return waveform.valueAt(time, value);
 }
\ No newline at end of file
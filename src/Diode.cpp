@@ -1,17 +1,27 @@
 #include "Diode.h"
 #include "Node.h"
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
+namespace {
+    const double THERMAL_VOLTAGE = 0.025852; // kT/q at 300 K
+    const double MAX_EXPONENT = 80.0;        // exp() argument clamp, extended linearly beyond
+}
+
 Diode::Diode(const string &name, Node *n1, Node *n2, DiodeType type, double vf, double vz)
         :
           diodeType(type),
+          diodeModel(MODEL_IDEAL),
           currentState(STATE_OFF),
           forwardVoltage(vf),
           zenerVoltage(vz),
           branchIndex(-1),
           current(0.0) {
+    this->name = name;
+    node1 = n1;
+    node2 = n2;
 }
 
 DiodeType Diode::getDiodeType() const {
@@ -47,6 +57,9 @@ void Diode::setCurrent(double c) {
 }
 
 double Diode::getCurrent() {
+    if (diodeModel == MODEL_SHOCKLEY) {
+        return current;
+    }
     if (currentState == STATE_OFF) {
         return 0.0;
     }
@@ -55,10 +68,113 @@ double Diode::getCurrent() {
 
 double Diode::getVoltage() {
     if (!node1 || !node2) return 0.0;
+    if (diodeModel == MODEL_SHOCKLEY) {
+        return node1->getVoltage() - node2->getVoltage();
+    }
     if (currentState == STATE_FORWARD_ON) {
         return forwardVoltage;
     } else if (currentState == STATE_REVERSE_ON) {
         return -zenerVoltage;
     }
     return node1->getVoltage() - node2->getVoltage();
+}
+
+double Diode::switchingFunction(double v, double i) const {
+    switch (currentState) {
+        case STATE_FORWARD_ON:
+            return -i;
+        case STATE_REVERSE_ON:
+            return i;
+        case STATE_OFF:
+        default: {
+            double s = v - forwardVoltage;
+            if (diodeType == ZENER) {
+                s = max(s, -zenerVoltage - v);
+            }
+            return s;
+        }
+    }
+}
+
+DiodeState Diode::switchedState(double v) const {
+    if (currentState != STATE_OFF) {
+        return STATE_OFF;
+    }
+    if (diodeType == ZENER && v < 0.0) {
+        return STATE_REVERSE_ON;
+    }
+    return STATE_FORWARD_ON;
+}
+
+void Diode::setModel(DiodeModel model) {
+    diodeModel = model;
+}
+
+DiodeModel Diode::getModel() const {
+    return diodeModel;
+}
+
+// exp() that continues linearly past MAX_EXPONENT so a wild Newton iterate cannot overflow
+static double limitedExp(double x, double &derivative) {
+    if (x > MAX_EXPONENT) {
+        double e = exp(MAX_EXPONENT);
+        derivative = e;
+        return e * (1.0 + x - MAX_EXPONENT);
+    }
+    derivative = exp(x);
+    return derivative;
+}
+
+double Diode::shockleyCurrent(double v) const {
+    double nvt = emissionCoefficient * THERMAL_VOLTAGE;
+    double d;
+    double i = saturationCurrent * (limitedExp(v / nvt, d) - 1.0);
+    if (diodeType == ZENER) {
+        i -= saturationCurrent * limitedExp(-(v + zenerVoltage) / nvt, d);
+    }
+    return i;
+}
+
+double Diode::shockleyConductance(double v) const {
+    double nvt = emissionCoefficient * THERMAL_VOLTAGE;
+    double d;
+    limitedExp(v / nvt, d);
+    double g = saturationCurrent / nvt * d;
+    if (diodeType == ZENER) {
+        limitedExp(-(v + zenerVoltage) / nvt, d);
+        g += saturationCurrent / nvt * d;
+    }
+    return g;
+}
+
+// SPICE pnjlim: keeps the Newton update of the junction voltage on the logarithmic scale once
+// the exponential is steep, both for forward conduction and (zener) reverse breakdown
+double Diode::limitJunctionVoltage(double v_new, double v_old) const {
+    double nvt = emissionCoefficient * THERMAL_VOLTAGE;
+    double vcrit = nvt * log(nvt / (sqrt(2.0) * saturationCurrent));
+
+    if (v_new > vcrit && fabs(v_new - v_old) > 2.0 * nvt) {
+        if (v_old > 0.0) {
+            double arg = 1.0 + (v_new - v_old) / nvt;
+            v_new = (arg > 0.0) ? v_old + nvt * log(arg) : vcrit;
+        } else {
+            v_new = nvt * log(v_new / nvt);
+        }
+    }
+
+    if (diodeType == ZENER) {
+        // Same limiting mirrored around the breakdown knee
+        double r_new = -(v_new + zenerVoltage);
+        double r_old = -(v_old + zenerVoltage);
+        if (r_new > vcrit && fabs(r_new - r_old) > 2.0 * nvt) {
+            if (r_old > 0.0) {
+                double arg = 1.0 + (r_new - r_old) / nvt;
+                r_new = (arg > 0.0) ? r_old + nvt * log(arg) : vcrit;
+            } else {
+                r_new = nvt * log(r_new / nvt);
+            }
+            v_new = -r_new - zenerVoltage;
+        }
+    }
+    return v_new;
 }
\ No newline at end of file
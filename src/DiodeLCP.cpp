@@ -0,0 +1,113 @@
+#include "DiodeLCP.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+
+bool finite(const vector<double>& v) {
+    return all_of(v.begin(), v.end(), [](double x) { return isfinite(x); });
+}
+
+} // namespace
+
+bool DiodeLCP::prepare(Circuit& circuit) {
+    ready = false;
+    modes.clear();
+    bool ideal = false;
+    for (const auto& diode : circuit.diodes) {
+        if (diode.getModel() == MODEL_SHOCKLEY) return false;
+        ideal = true;
+    }
+    if (!ideal) {
+        return false;
+    }
+
+    // A0 is factored with every diode off; the states go back afterwards, so a failed
+    // preparation does not cost dcAnalysis the warm states of the operating-point cache
+    vector<DiodeState> states;
+    for (auto& diode : circuit.diodes) {
+        states.push_back(diode.getState());
+        diode.setState(STATE_OFF);
+    }
+    auto restore = [&](bool result) {
+        for (size_t k = 0; k < circuit.diodes.size(); ++k) circuit.diodes[k].setState(states[k]);
+        circuit.assignDiodeBranchIndices();
+        return result;
+    };
+    circuit.assignDiodeBranchIndices();
+    circuit.set_MNA_A(AnalysisType::DC);
+    if (circuit.MNA_A.empty()) {
+        return restore(false);
+    }
+    lu = luFactorize(circuit.MNA_A);
+    size_t size = circuit.MNA_A.size();
+
+    for (size_t k = 0; k < circuit.diodes.size(); ++k) {
+        const Diode& diode = circuit.diodes[k];
+        int a = circuit.getNodeMatrixIndex(diode.node1);
+        int c = circuit.getNodeMatrixIndex(diode.node2);
+        Mode forward{k, false, diode.getForwardVoltage(), vector<double>(size, 0.0)};
+        if (a != -1) forward.g[a] += 1.0;
+        if (c != -1) forward.g[c] -= 1.0;
+        modes.push_back(forward);
+        if (diode.getDiodeType() == ZENER) {
+            Mode reverse{k, true, diode.getZenerVoltage(), forward.g};
+            for (double& v : reverse.g) v = -v;
+            modes.push_back(reverse);
+        }
+    }
+
+    // M = G^T A0^-1 G over the conduction modes
+    vector<vector<double>> solved;
+    for (const auto& mode : modes) {
+        solved.push_back(luSolve(lu, mode.g));
+        if (!finite(solved.back())) return restore(false);
+    }
+    M.assign(modes.size(), vector<double>(modes.size(), 0.0));
+    for (size_t i = 0; i < modes.size(); ++i) {
+        for (size_t j = 0; j < modes.size(); ++j) {
+            M[i][j] = inner_product(modes[i].g.begin(), modes[i].g.end(), solved[j].begin(), 0.0);
+        }
+    }
+    ready = true;
+    return restore(true);
+}
+
+bool DiodeLCP::solve(Circuit& circuit) {
+    if (!ready) {
+        return false;
+    }
+    // Source values only enter the RHS, which is built with every diode off like A0
+    vector<DiodeState> states;
+    for (auto& diode : circuit.diodes) {
+        states.push_back(diode.getState());
+        diode.setState(STATE_OFF);
+    }
+    circuit.assignDiodeBranchIndices();
+    circuit.set_MNA_RHS(AnalysisType::DC);
+    vector<double> x0 = luSolve(lu, circuit.MNA_RHS);
+
+    vector<double> q(modes.size()), z;
+    for (size_t k = 0; k < modes.size(); ++k) {
+        q[k] = modes[k].voltage - inner_product(modes[k].g.begin(), modes[k].g.end(), x0.begin(), 0.0);
+    }
+    bool solved = finite(q) && solveLCP(M, q, z, 50 * static_cast<int>(modes.size()) + 10, &lastPivots);
+    totalPivots += lastPivots;
+    if (!solved) {
+        for (size_t k = 0; k < circuit.diodes.size(); ++k) circuit.diodes[k].setState(states[k]);
+        circuit.assignDiodeBranchIndices();
+        return false;
+    }
+
+    double largest = z.empty() ? 0.0 : *max_element(z.begin(), z.end());
+    for (size_t k = 0; k < modes.size(); ++k) {
+        if (z[k] > 1e-12 * max(1.0, largest)) {
+            circuit.diodes[modes[k].diode].setState(modes[k].reverse ? STATE_REVERSE_ON : STATE_FORWARD_ON);
+        }
+    }
+    circuit.assignDiodeBranchIndices();
+    return true;
+}
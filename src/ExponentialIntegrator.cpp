@@ -0,0 +1,172 @@
+#include "ExponentialIntegrator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+double norm(const vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x * x;
+    return sqrt(sum);
+}
+
+vector<double> multiply(const vector<vector<pair<int, double>>>& rows, const vector<double>& x) {
+    vector<double> y(rows.size(), 0.0);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (const auto& entry : rows[i]) y[i] += entry.second * x[entry.first];
+    }
+    return y;
+}
+
+// luFactorize does not report singular matrices; a vanishing pivot relative to the largest
+// one is taken as singular
+bool nonsingular(const LUFactorization& lu) {
+    double largest = 0.0, smallest = numeric_limits<double>::infinity();
+    for (size_t i = 0; i < lu.LU.size(); ++i) {
+        double pivot = fabs(lu.LU[i][i]);
+        largest = max(largest, pivot);
+        smallest = min(smallest, pivot);
+    }
+    return lu.LU.empty() || (isfinite(smallest) && smallest > 1e-14 * largest);
+}
+
+} // namespace
+
+ExponentialIntegrator::ExponentialIntegrator(const vector<vector<double>>& g, const vector<vector<double>>& c,
+                                             double gamma, double tolerance, int maxDimension)
+    : gamma(gamma), tolerance(tolerance), maxDimension(max(1, maxDimension)) {
+    // C holds only the capacitor and inductor stamps, so products with it go over its nonzeros
+    C.resize(c.size());
+    for (size_t i = 0; i < c.size(); ++i) {
+        for (size_t j = 0; j < c[i].size(); ++j) {
+            if (c[i][j] != 0.0) C[i].push_back({static_cast<int>(j), c[i][j]});
+        }
+    }
+    gLU = luFactorize(g);
+    if (!nonsingular(gLU)) {
+        throw runtime_error("Exponential integrator: the circuit has no DC solution (floating node or loop).");
+    }
+    vector<vector<double>> shifted = c;
+    for (size_t i = 0; i < shifted.size(); ++i) {
+        for (size_t j = 0; j < shifted[i].size(); ++j) shifted[i][j] += gamma * g[i][j];
+    }
+    shiftedLU = luFactorize(shifted);
+    if (!nonsingular(shiftedLU)) {
+        throw runtime_error("Exponential integrator: C + gamma G is singular.");
+    }
+}
+
+vector<double> ExponentialIntegrator::operatingPoint(const vector<double>& b) const {
+    return luSolve(gLU, b);
+}
+
+vector<double> ExponentialIntegrator::step(const vector<double>& x, const vector<double>& b0, const vector<double>& b1, double h) {
+    size_t n = x.size();
+    vector<double> slope(n);
+    for (size_t i = 0; i < n; ++i) slope[i] = (b1[i] - b0[i]) / h;
+    vector<double> p1 = luSolve(gLU, slope);
+    vector<double> cp1 = multiply(C, p1);
+    vector<double> rhs(n);
+    for (size_t i = 0; i < n; ++i) rhs[i] = b0[i] - cp1[i];
+    vector<double> p0 = luSolve(gLU, rhs);
+
+    vector<double> e(n);
+    for (size_t i = 0; i < n; ++i) e[i] = x[i] - p0[i];
+    vector<double> result = propagate(e, h);
+    for (size_t i = 0; i < n; ++i) result[i] += p0[i] + h * p1[i];
+    stats.steps++;
+    return result;
+}
+
+// exp(hA) e from the Arnoldi relation S V_m = V_m H_m + h_{m+1,m} v_{m+1} e_m^T with
+// S = (C + gamma G)^-1 C = (I - gamma A)^-1. The space is started from w = S e rather than e:
+// S maps any vector onto the consistent states, so the roundoff that leaves e slightly off the
+// algebraic constraints (dominant once e has decayed) cannot enter the basis as a spurious,
+// growing mode. Then exp(hA) e = exp(hA) S^-1 w ~= beta V_m exp(h/gamma (I - H_m^-1)) H_m^-1 e_1.
+// The dimension grows until two successive approximations agree to the tolerance.
+vector<double> ExponentialIntegrator::propagate(const vector<double>& e, double h) {
+    size_t n = e.size();
+    vector<double> start = luSolve(shiftedLU, multiply(C, e));
+    double beta = norm(start);
+    vector<double> result(n, 0.0);
+    if (beta == 0.0) {
+        return result;
+    }
+
+    int limit = min<int>(maxDimension, n);
+    vector<vector<double>> V(1, start);
+    for (double& v : V[0]) v /= beta;
+    vector<vector<double>> H(limit + 1, vector<double>(limit, 0.0));
+    vector<double> y, y_prev;
+
+    for (int m = 1; m <= limit; ++m) {
+        int k = m - 1;
+        vector<double> w = luSolve(shiftedLU, multiply(C, V[k]));
+        stats.krylovVectors++;
+        // Modified Gram-Schmidt, twice for orthogonality in the small basis
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int j = 0; j <= k; ++j) {
+                double dot = 0.0;
+                for (size_t i = 0; i < n; ++i) dot += w[i] * V[j][i];
+                H[j][k] += dot;
+                for (size_t i = 0; i < n; ++i) w[i] -= dot * V[j][i];
+            }
+        }
+        double next = norm(w);
+        H[m][k] = next;
+
+        // Projected exp(h/gamma (I - H_m^-1)) H_m^-1 e_1
+        vector<vector<double>> Hm(m, vector<double>(m));
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < m; ++j) Hm[i][j] = H[i][j];
+        }
+        LUFactorization hLU = luFactorize(Hm);
+        vector<vector<double>> M(m, vector<double>(m));
+        vector<double> unit(m), first;
+        for (int j = 0; j < m; ++j) {
+            fill(unit.begin(), unit.end(), 0.0);
+            unit[j] = 1.0;
+            vector<double> column = luSolve(hLU, unit);
+            if (j == 0) first = column;
+            for (int i = 0; i < m; ++i) M[i][j] = (h / gamma) * ((i == j ? 1.0 : 0.0) - column[i]);
+        }
+        vector<vector<double>> expM = matrixExponential(M);
+        y.assign(m, 0.0);
+        bool finite = true;
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < m; ++j) y[i] += expM[i][j] * first[j];
+            if (!isfinite(y[i])) finite = false;
+        }
+
+        bool breakdown = next <= 1e-12 || m == limit; // basis vectors are unit length
+        bool converged = false;
+        if (finite && !y_prev.empty()) {
+            double change = 0.0;
+            for (int i = 0; i < m; ++i) {
+                double d = y[i] - (i < m - 1 ? y_prev[i] : 0.0);
+                change += d * d;
+            }
+            converged = sqrt(change) <= tolerance;
+        }
+        if (!finite && !y_prev.empty()) {
+            y = y_prev; // Keep the last usable approximation
+            breakdown = true;
+        }
+        stats.maxDimension = max(stats.maxDimension, m);
+        if (converged || breakdown) {
+            break;
+        }
+        y_prev = y;
+        for (double& v : w) v /= next;
+        V.push_back(w);
+    }
+
+    for (size_t j = 0; j < y.size(); ++j) {
+        for (size_t i = 0; i < n; ++i) result[i] += beta * y[j] * V[j][i];
+    }
+    return result;
+}
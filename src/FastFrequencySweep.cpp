@@ -0,0 +1,211 @@
+#include "FastFrequencySweep.h"
+#include "LinearSolver.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+namespace {
+
+double dot(const vector<double>& a, const vector<double>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// Orthonormalizes v against the basis (modified Gram-Schmidt twice) and appends it, unless
+// less than 1e-10 of it is left; returns whether it was appended
+bool addToBasis(vector<vector<double>>& basis, vector<double> v) {
+    double original = sqrt(dot(v, v));
+    if (original == 0.0) return false;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& q : basis) {
+            double h = dot(q, v);
+            for (size_t i = 0; i < v.size(); ++i) v[i] -= h * q[i];
+        }
+    }
+    double length = sqrt(dot(v, v));
+    if (length < 1e-10 * original) return false;
+    for (double& x : v) x /= length;
+    basis.push_back(std::move(v));
+    return true;
+}
+
+} // namespace
+
+void fastFrequencySweep(const Circuit& circuit, const vector<double>& frequencies,
+                        vector<vector<complex<double>>>& solutions, AcSweepStats& stats) {
+    const AcSweepSettings& settings = circuit.acSweepSettings;
+    const AcPencil pencil = circuit.acPencil();
+    vector<complex<double>> rhs;
+    circuit.acRHS(rhs);
+    size_t n = pencil.size;
+    size_t size = n + circuit.inductors.size();
+    solutions.assign(frequencies.size(), {});
+    if (frequencies.empty() || n == 0) return;
+
+    // G and C of the first-order system; inductor k has current unknown n + k with
+    // v1 - v2 = s L i, so the pencil's Gamma entries are left out
+    vector<vector<double>> G(size, vector<double>(size, 0.0));
+    vector<vector<double>> C(size, vector<double>(size, 0.0));
+    for (size_t k = 0; k < pencil.rows.size(); ++k) {
+        G[pencil.rows[k]][pencil.cols[k]] += pencil.g[k];
+        C[pencil.rows[k]][pencil.cols[k]] += pencil.c[k];
+    }
+    for (size_t k = 0; k < circuit.inductors.size(); ++k) {
+        const Inductor& inductor = circuit.inductors[k];
+        int a = circuit.getNodeMatrixIndex(inductor.node1);
+        int c = circuit.getNodeMatrixIndex(inductor.node2);
+        size_t branch = n + k;
+        if (a != -1) {
+            G[a][branch] += 1.0;
+            G[branch][a] -= 1.0;
+        }
+        if (c != -1) {
+            G[c][branch] -= 1.0;
+            G[branch][c] += 1.0;
+        }
+        C[branch][branch] = inductor.inductance;
+    }
+    vector<complex<double>> b(size, {0.0, 0.0});
+    copy(rhs.begin(), rhs.end(), b.begin());
+    double b_norm = 0.0;
+    for (const auto& value : b) b_norm = max(b_norm, abs(value));
+
+    vector<vector<double>> basis;
+    vector<double> expansions;
+    auto expand = [&](double f0) {
+        complex<double> s0(0.0, 2.0 * M_PI * f0);
+        vector<vector<complex<double>>> K(size, vector<complex<double>>(size));
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < size; ++j) K[i][j] = G[i][j] + s0 * C[i][j];
+        }
+        ComplexLUFactorization lu = luFactorize(std::move(K));
+        expansions.push_back(f0);
+
+        vector<complex<double>> r = luSolve(lu, b);
+        vector<double> part(size);
+        for (int moment = 0; moment < settings.fastSweepMoments; ++moment) {
+            double length = 0.0;
+            for (const auto& value : r) length = max(length, abs(value));
+            if (length == 0.0 || !isfinite(length)) break;
+            bool added = false;
+            for (size_t i = 0; i < size; ++i) part[i] = r[i].real() / length;
+            added = addToBasis(basis, part) || added;
+            for (size_t i = 0; i < size; ++i) part[i] = r[i].imag() / length;
+            added = addToBasis(basis, part) || added;
+            if (!added) break;
+
+            vector<complex<double>> next(size, {0.0, 0.0});
+            for (size_t i = 0; i < size; ++i) {
+                for (size_t j = 0; j < size; ++j) next[i] += C[i][j] * r[j] / length;
+            }
+            r = luSolve(lu, next);
+        }
+    };
+
+    // Minimal-residual solve in the span at every frequency: z minimizes |(G + jwC) V z - b|.
+    // The Galerkin system V^T (G + jwC) V can be singular for MNA (source and inductor rows
+    // make G indefinite), this one is not. GV, CV and b are reduced once per basis by a QR
+    // factorization [GV CV b] = Q R, after which every frequency is a least-squares problem
+    // in the r <= 2q + 2 rows of R, solved by QR again rather than through the normal
+    // equations, whose condition number would be squared.
+    // Each point is then scored by the normwise backward error of its node part in Y(jw) x = b;
+    // points already within tolerance keep their solution
+    vector<double> errors(frequencies.size(), INFINITY);
+    auto evaluate = [&]() {
+        size_t q = basis.size();
+        vector<vector<double>> W(size, vector<double>(2 * q + 2));
+        for (size_t i = 0; i < size; ++i) {
+            for (size_t k = 0; k < q; ++k) {
+                W[i][k] = dot(G[i], basis[k]);
+                W[i][q + k] = dot(C[i], basis[k]);
+            }
+            W[i][2 * q] = b[i].real();
+            W[i][2 * q + 1] = b[i].imag();
+        }
+        householderQR(W, 2 * q + 2);
+        size_t r = min(size, 2 * q + 2);
+
+        // Real form of the complex problem over z = zr + j zi:
+        // [RG -wRC; wRC RG] [zr; zi] ~ [Rb_re; Rb_im]
+        vector<vector<double>> A(2 * r, vector<double>(2 * q));
+        vector<double> rhs_r(2 * r);
+        for (size_t i = 0; i < r; ++i) {
+            rhs_r[i] = W[i][2 * q];
+            rhs_r[r + i] = W[i][2 * q + 1];
+        }
+        vector<complex<double>> residual(n);
+        vector<double> row_sum(n);
+        for (size_t p = 0; p < frequencies.size(); ++p) {
+            if (errors[p] <= settings.fastSweepTol) continue;
+            double w = 2.0 * M_PI * frequencies[p];
+            for (size_t i = 0; i < r; ++i) {
+                for (size_t k = 0; k < q; ++k) {
+                    A[i][k] = A[r + i][q + k] = W[i][k];
+                    A[i][q + k] = -w * W[i][q + k];
+                    A[r + i][k] = w * W[i][q + k];
+                }
+            }
+            vector<double> z = leastSquares(A, rhs_r);
+
+            vector<complex<double>>& x = solutions[p];
+            x.assign(n, {0.0, 0.0});
+            for (size_t k = 0; k < q; ++k) {
+                complex<double> zk(z[k], z[q + k]);
+                for (size_t i = 0; i < n; ++i) x[i] += basis[k][i] * zk;
+            }
+
+            residual.assign(rhs.begin(), rhs.end());
+            row_sum.assign(n, 0.0);
+            for (size_t k = 0; k < pencil.rows.size(); ++k) {
+                complex<double> y(pencil.g[k], w * pencil.c[k] - pencil.gamma[k] / w);
+                residual[pencil.rows[k]] -= y * x[pencil.cols[k]];
+                row_sum[pencil.rows[k]] += abs(y);
+            }
+            double r_norm = 0.0, x_norm = 0.0, y_norm = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                r_norm = max(r_norm, abs(residual[i]));
+                x_norm = max(x_norm, abs(x[i]));
+                y_norm = max(y_norm, row_sum[i]);
+            }
+            errors[p] = isfinite(r_norm) ? r_norm / (y_norm * x_norm + b_norm) : INFINITY;
+        }
+    };
+
+    expand(sqrt(frequencies.front() * frequencies.back()));
+    evaluate();
+    // Another expansion costs about fastSweepMoments direct solves, and a model as large as
+    // the circuit saves nothing
+    while (static_cast<int>(expansions.size()) < settings.fastSweepMaxExpansions && basis.size() < n) {
+        size_t worst = max_element(errors.begin(), errors.end()) - errors.begin();
+        long missed = count_if(errors.begin(), errors.end(), [&](double e) { return e > settings.fastSweepTol; });
+        if (missed <= settings.fastSweepMoments ||
+            find(expansions.begin(), expansions.end(), frequencies[worst]) != expansions.end()) {
+            break;
+        }
+        size_t before = basis.size();
+        expand(frequencies[worst]);
+        if (basis.size() == before) break;
+        evaluate();
+    }
+
+    // Whatever the model still misses is solved directly
+    long direct = 0;
+    vector<vector<complex<double>>> A;
+    vector<complex<double>> b_direct;
+    for (size_t p = 0; p < frequencies.size(); ++p) {
+        if (errors[p] <= settings.fastSweepTol) continue;
+        pencil.assemble(frequencies[p], A);
+        b_direct = rhs;
+        gaussianEliminationInPlace(A, b_direct, solutions[p]);
+        direct++;
+    }
+    stats.expansionPoints = expansions.size();
+    stats.reducedOrder = basis.size();
+    stats.directPoints = direct;
+}
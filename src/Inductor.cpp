@@ -12,11 +12,69 @@ double Inductor::getVoltage() {
     return 0.0;
 }
 
-void Inductor::update(double dt) {
+double Inductor::companionResistance(IntegrationMethod method, double dt, double prev_dt) const {
+    if (method == IntegrationMethod::TRAPEZOIDAL) {
+        return 2.0 * inductance / dt;
+    }
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        return a0 * inductance / dt;
+    }
+    return inductance / dt;
+}
+
+double Inductor::companionVoltage(IntegrationMethod method, double dt, double prev_dt) const {
+    if (method == IntegrationMethod::TRAPEZOIDAL) {
+        return 2.0 * inductance / dt * prevCurrent + prevVoltage;
+    }
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        return -inductance / dt * (a1 * prevCurrent + a2 * prevPrevCurrent);
+    }
+    return inductance / dt * prevCurrent;
+}
+
+void Inductor::update(double, IntegrationMethod method, double) {
     if (!node1 || !node2) return;
+    double v = node1->getVoltage() - node2->getVoltage();
+
+    // Trapezoidal ringing shows up as a voltage that zig-zags every step without decaying
+    double delta = v - prevVoltage;
+    if (method == IntegrationMethod::TRAPEZOIDAL && delta * prevVoltageDelta < 0.0 && fabs(delta) > 1e-12 &&
+        fabs(delta) > 0.5 * fabs(prevVoltageDelta)) {
+        ringingCount++;
+    } else {
+        ringingCount = 0;
+    }
+
+    prevPrevCurrent = prevCurrent;
     prevCurrent = current;
+    prevVoltage = v;
+    prevVoltageDelta = delta;
 }
 
 void Inductor::setInductorCurrent(double c) {
     this->current = c;
-}
\ No newline at end of file
+}
+
+void Inductor::resetHistory() {
+    prevCurrent = current;
+    prevPrevCurrent = current;
+    prevVoltage = (node1 && node2) ? node1->getVoltage() - node2->getVoltage() : 0.0;
+    prevVoltageDelta = 0.0;
+    ringingCount = 0;
+}
+
+vector<double> Inductor::historyState() const {
+    return {prevCurrent, prevPrevCurrent, prevVoltage, prevVoltageDelta, static_cast<double>(ringingCount)};
+}
+
+void Inductor::restoreHistoryState(const vector<double>& state) {
+    prevCurrent = state[0];
+    prevPrevCurrent = state[1];
+    prevVoltage = state[2];
+    prevVoltageDelta = state[3];
+    ringingCount = static_cast<int>(state[4]);
+}
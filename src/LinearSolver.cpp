@@ -3,11 +3,23 @@
 #include <cmath>
 #include <algorithm>
 #include <complex>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 #include "LinearSolver.h"
 
 using namespace std;
 
 vector<complex<double>> gaussianElimination(vector<vector<complex<double>>> A, vector<complex<double>> b) {
+    vector<complex<double>> x;
+    gaussianEliminationInPlace(A, b, x);
+    return x;
+}
+
+void gaussianEliminationInPlace(vector<vector<complex<double>>>& A, vector<complex<double>>& b,
+                                vector<complex<double>>& x) {
     int n = A.size();
 
     for (int i = 0; i < n; i++) {
@@ -32,7 +44,7 @@ vector<complex<double>> gaussianElimination(vector<vector<complex<double>>> A, v
     }
 
     // Back substitution
-    vector<complex<double>> x(n);
+    x.resize(n);
     for (int i = n - 1; i >= 0; i--) {
         x[i] = b[i];
         for (int j = i + 1; j < n; j++) {
@@ -40,7 +52,6 @@ vector<complex<double>> gaussianElimination(vector<vector<complex<double>>> A, v
         }
         x[i] /= A[i][i];
     }
-    return x;
 }
 
 // Add a version for real numbers
@@ -80,6 +91,141 @@ vector<double> gaussianElimination(vector<vector<double>> A, vector<double> b) {
     return x;
 }
 
+LUFactorization luFactorize(vector<vector<double>> A) {
+    int n = A.size();
+    LUFactorization lu;
+    lu.pivot.resize(n);
+    for (int i = 0; i < n; i++) {
+        lu.pivot[i] = i;
+    }
+
+    for (int i = 0; i < n; i++) {
+        // Find pivot
+        int max_row = i;
+        for (int k = i + 1; k < n; k++) {
+            if (abs(A[k][i]) > abs(A[max_row][i])) {
+                max_row = k;
+            }
+        }
+        swap(A[i], A[max_row]);
+        swap(lu.pivot[i], lu.pivot[max_row]);
+
+        // Store the multipliers below the pivot (L) and eliminate (U)
+        for (int k = i + 1; k < n; k++) {
+            double factor = A[k][i] / A[i][i];
+            A[k][i] = factor;
+            for (int j = i + 1; j < n; j++) {
+                A[k][j] -= factor * A[i][j];
+            }
+        }
+    }
+    lu.LU = std::move(A);
+    return lu;
+}
+
+vector<double> luSolve(const LUFactorization& lu, const vector<double>& b) {
+    int n = lu.LU.size();
+    vector<double> x(n);
+
+    // Forward substitution (L has a unit diagonal)
+    for (int i = 0; i < n; i++) {
+        x[i] = b[lu.pivot[i]];
+        for (int j = 0; j < i; j++) {
+            x[i] -= lu.LU[i][j] * x[j];
+        }
+    }
+
+    // Back substitution
+    for (int i = n - 1; i >= 0; i--) {
+        for (int j = i + 1; j < n; j++) {
+            x[i] -= lu.LU[i][j] * x[j];
+        }
+        x[i] /= lu.LU[i][i];
+    }
+    return x;
+}
+
+ComplexLUFactorization luFactorize(vector<vector<complex<double>>> A) {
+    int n = A.size();
+    ComplexLUFactorization lu;
+    lu.pivot.resize(n);
+    for (int i = 0; i < n; i++) {
+        lu.pivot[i] = i;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int max_row = i;
+        for (int k = i + 1; k < n; k++) {
+            if (abs(A[k][i]) > abs(A[max_row][i])) {
+                max_row = k;
+            }
+        }
+        swap(A[i], A[max_row]);
+        swap(lu.pivot[i], lu.pivot[max_row]);
+
+        for (int k = i + 1; k < n; k++) {
+            complex<double> factor = A[k][i] / A[i][i];
+            A[k][i] = factor;
+            for (int j = i + 1; j < n; j++) {
+                A[k][j] -= factor * A[i][j];
+            }
+        }
+    }
+    lu.LU = std::move(A);
+    return lu;
+}
+
+vector<complex<double>> luSolve(const ComplexLUFactorization& lu, const vector<complex<double>>& b) {
+    int n = lu.LU.size();
+    vector<complex<double>> x(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = b[lu.pivot[i]];
+        for (int j = 0; j < i; j++) {
+            x[i] -= lu.LU[i][j] * x[j];
+        }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        for (int j = i + 1; j < n; j++) {
+            x[i] -= lu.LU[i][j] * x[j];
+        }
+        x[i] /= lu.LU[i][i];
+    }
+    return x;
+}
+
+// With P A = L U, A^T x = b is U^T L^T (P x) = b: forward substitution with U^T, back
+// substitution with the unit lower triangle's transpose, then the rows permuted back
+template <typename T>
+static vector<T> solveTransposed(const vector<vector<T>>& LU, const vector<int>& pivot, const vector<T>& b) {
+    int n = LU.size();
+    vector<T> w(n);
+    for (int i = 0; i < n; i++) {
+        w[i] = b[i];
+        for (int j = 0; j < i; j++) {
+            w[i] -= LU[j][i] * w[j];
+        }
+        w[i] /= LU[i][i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        for (int j = i + 1; j < n; j++) {
+            w[i] -= LU[j][i] * w[j];
+        }
+    }
+    vector<T> x(n);
+    for (int i = 0; i < n; i++) {
+        x[pivot[i]] = w[i];
+    }
+    return x;
+}
+
+vector<double> luSolveTransposed(const LUFactorization& lu, const vector<double>& b) {
+    return solveTransposed(lu.LU, lu.pivot, b);
+}
+
+vector<complex<double>> luSolveTransposed(const ComplexLUFactorization& lu, const vector<complex<double>>& b) {
+    return solveTransposed(lu.LU, lu.pivot, b);
+}
+
 // Other functions (display_vec2D, display_vec, test_solver) remain the same...
 void test_solver() {
     vector<vector<double>> a = {{1, 6, 3, 6},
@@ -107,4 +253,547 @@ void display_vec(vector<double> a) {
         cout << *it << endl;
     }
     cout << endl;
-}
\ No newline at end of file
+}
+
+vector<double> gmres(const function<vector<double>(const vector<double>&)>& apply, const vector<double>& b,
+                     double tol, int maxIterations, int* iterations) {
+    int n = b.size();
+    auto norm = [](const vector<double>& v) {
+        double sum = 0.0;
+        for (double x : v) sum += x * x;
+        return sqrt(sum);
+    };
+    vector<double> x(n, 0.0);
+    if (iterations) *iterations = 0;
+    double beta = norm(b);
+    if (beta == 0.0) {
+        return x;
+    }
+
+    // Arnoldi basis V, Hessenberg H reduced on the fly by Givens rotations (cs, sn), and the
+    // rotated right-hand side g whose last entry is the residual norm
+    vector<vector<double>> V(1, b);
+    for (double& v : V[0]) v /= beta;
+    vector<vector<double>> H;
+    vector<double> cs, sn, g(1, beta);
+    int k = 0;
+    for (; k < maxIterations; ++k) {
+        vector<double> w = apply(V[k]);
+        if (iterations) (*iterations)++;
+        vector<double> h(k + 2, 0.0);
+        for (int j = 0; j <= k; ++j) {
+            for (int i = 0; i < n; ++i) h[j] += w[i] * V[j][i];
+            for (int i = 0; i < n; ++i) w[i] -= h[j] * V[j][i];
+        }
+        h[k + 1] = norm(w);
+        for (int j = 0; j < k; ++j) {
+            double t = cs[j] * h[j] + sn[j] * h[j + 1];
+            h[j + 1] = -sn[j] * h[j] + cs[j] * h[j + 1];
+            h[j] = t;
+        }
+        double r = hypot(h[k], h[k + 1]);
+        cs.push_back(r > 0.0 ? h[k] / r : 1.0);
+        sn.push_back(r > 0.0 ? h[k + 1] / r : 0.0);
+        double w_norm = h[k + 1];
+        h[k] = r;
+        h[k + 1] = 0.0;
+        H.push_back(h);
+        g.push_back(-sn[k] * g[k]);
+        g[k] = cs[k] * g[k];
+
+        if (fabs(g[k + 1]) <= tol * beta || w_norm <= 1e-14 * beta) {
+            k++;
+            break;
+        }
+        for (double& v : w) v /= w_norm;
+        V.push_back(w);
+    }
+
+    // Back substitution on the triangular H, then x = V y
+    vector<double> y(k, 0.0);
+    for (int i = k - 1; i >= 0; --i) {
+        double sum = g[i];
+        for (int j = i + 1; j < k; ++j) sum -= H[j][i] * y[j];
+        y[i] = sum / H[i][i];
+    }
+    for (int j = 0; j < k; ++j) {
+        for (int i = 0; i < n; ++i) x[i] += y[j] * V[j][i];
+    }
+    return x;
+}
+
+vector<vector<double>> matrixExponential(const vector<vector<double>>& A) {
+    int n = A.size();
+    auto multiply = [n](const vector<vector<double>>& a, const vector<vector<double>>& b) {
+        vector<vector<double>> c(n, vector<double>(n, 0.0));
+        for (int i = 0; i < n; ++i) {
+            for (int k = 0; k < n; ++k) {
+                if (a[i][k] == 0.0) continue;
+                for (int j = 0; j < n; ++j) c[i][j] += a[i][k] * b[k][j];
+            }
+        }
+        return c;
+    };
+
+    // Scale so that ||A / 2^s||_inf <= 1/2, where the [6/6] approximant is accurate to roundoff
+    double norm = 0.0;
+    for (const auto& row : A) {
+        double sum = 0.0;
+        for (double a : row) sum += fabs(a);
+        norm = max(norm, sum);
+    }
+    int s = norm > 0.5 ? static_cast<int>(ceil(log2(norm / 0.5))) : 0;
+    double scale = ldexp(1.0, -s);
+
+    const int q = 6;
+    vector<vector<double>> X(n, vector<double>(n));
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) X[i][j] = A[i][j] * scale;
+    }
+    vector<vector<double>> N(n, vector<double>(n, 0.0)), D(n, vector<double>(n, 0.0));
+    for (int i = 0; i < n; ++i) {
+        N[i][i] = 1.0;
+        D[i][i] = 1.0;
+    }
+    vector<vector<double>> Xk = X;
+    double c = 1.0;
+    for (int k = 1; k <= q; ++k) {
+        if (k > 1) Xk = multiply(X, Xk);
+        c *= static_cast<double>(q - k + 1) / (k * (2 * q - k + 1));
+        double sign = (k % 2 == 0) ? 1.0 : -1.0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                N[i][j] += c * Xk[i][j];
+                D[i][j] += sign * c * Xk[i][j];
+            }
+        }
+    }
+
+    // E = D^-1 N, column by column, then undo the scaling by squaring
+    LUFactorization lu = luFactorize(D);
+    vector<vector<double>> E(n, vector<double>(n));
+    vector<double> column(n);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) column[i] = N[i][j];
+        vector<double> e = luSolve(lu, column);
+        for (int i = 0; i < n; ++i) E[i][j] = e[i];
+    }
+    for (int k = 0; k < s; ++k) {
+        E = multiply(E, E);
+    }
+    return E;
+}
+
+bool solveLCP(const vector<vector<double>>& M, const vector<double>& q, vector<double>& z,
+              int maxPivots, int* pivots) {
+    int n = q.size();
+    z.assign(n, 0.0);
+    if (pivots) *pivots = 0;
+    int start = min_element(q.begin(), q.end()) - q.begin();
+    if (n == 0 || q[start] >= 0.0) {
+        return true; // z = 0
+    }
+
+    // Tableau of I w - M z - e z0 = q. Columns: w (0..n-1), z (n..2n-1), z0 (2n), rhs (2n+1).
+    const int Z0 = 2 * n, RHS = 2 * n + 1;
+    vector<vector<double>> T(n, vector<double>(2 * n + 2, 0.0));
+    vector<int> basis(n);
+    for (int i = 0; i < n; ++i) {
+        T[i][i] = 1.0;
+        for (int j = 0; j < n; ++j) T[i][n + j] = -M[i][j];
+        T[i][Z0] = -1.0;
+        T[i][RHS] = q[i];
+        basis[i] = i;
+    }
+    auto pivot = [&](int r, int c) {
+        double p = T[r][c];
+        for (double& v : T[r]) v /= p;
+        for (int i = 0; i < n; ++i) {
+            if (i == r || T[i][c] == 0.0) continue;
+            double f = T[i][c];
+            for (int j = 0; j <= RHS; ++j) T[i][j] -= f * T[r][j];
+        }
+        basis[r] = c;
+    };
+
+    // z0 enters at the row of the most negative q, which makes every rhs nonnegative
+    int leaving = basis[start];
+    pivot(start, Z0);
+    for (int count = 1; count <= maxPivots; ++count) {
+        if (pivots) *pivots = count;
+        int entering = leaving < n ? leaving + n : leaving - n; // complement of the leaving variable
+        int row = -1;
+        double best = 0.0;
+        for (int i = 0; i < n; ++i) {
+            if (T[i][entering] <= 1e-12) continue;
+            double ratio = T[i][RHS] / T[i][entering];
+            // Ties go to z0, which ends the pivoting
+            if (row == -1 || ratio < best - 1e-12 || (ratio <= best + 1e-12 && basis[i] == Z0)) {
+                row = i;
+                best = ratio;
+            }
+        }
+        if (row == -1) {
+            return false; // ray termination
+        }
+        leaving = basis[row];
+        pivot(row, entering);
+        if (leaving == Z0) {
+            for (int i = 0; i < n; ++i) {
+                if (basis[i] >= n && basis[i] < Z0) z[basis[i] - n] = max(0.0, T[i][RHS]);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void householderQR(vector<vector<double>>& A, int columns) {
+    int m = A.size();
+    vector<double> v;
+    for (int k = 0; k < columns && k < m; ++k) {
+        double norm = 0.0;
+        for (int i = k; i < m; ++i) norm += A[i][k] * A[i][k];
+        norm = sqrt(norm);
+        if (norm == 0.0) continue;
+        // Reflect x = A[k..m)[k] onto alpha e1, alpha of the sign that avoids cancellation
+        double alpha = A[k][k] > 0.0 ? -norm : norm;
+        v.assign(m - k, 0.0);
+        for (int i = k; i < m; ++i) v[i - k] = A[i][k];
+        v[0] -= alpha;
+        double vv = 0.0;
+        for (double x : v) vv += x * x;
+        if (vv == 0.0) continue;
+        for (size_t j = k + 1; j < A[k].size(); ++j) {
+            double h = 0.0;
+            for (int i = k; i < m; ++i) h += v[i - k] * A[i][j];
+            h *= 2.0 / vv;
+            if (h == 0.0) continue;
+            for (int i = k; i < m; ++i) A[i][j] -= h * v[i - k];
+        }
+        A[k][k] = alpha;
+        for (int i = k + 1; i < m; ++i) A[i][k] = 0.0;
+    }
+}
+
+vector<double> leastSquares(vector<vector<double>> A, const vector<double>& b) {
+    int m = A.size();
+    int n = m > 0 ? A[0].size() : 0;
+    vector<double> x(n, 0.0);
+    if (m < n || n == 0) {
+        return x;
+    }
+    vector<double> scale(n, 0.0);
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < m; ++i) scale[j] += A[i][j] * A[i][j];
+        scale[j] = scale[j] > 0.0 ? 1.0 / sqrt(scale[j]) : 0.0;
+    }
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) A[i][j] *= scale[j];
+        A[i].push_back(b[i]);
+    }
+    householderQR(A, n);
+
+    double largest = 0.0;
+    for (int k = 0; k < n; ++k) largest = max(largest, fabs(A[k][k]));
+    for (int k = n - 1; k >= 0; --k) {
+        if (fabs(A[k][k]) <= 1e-14 * largest) continue;
+        double sum = A[k][n];
+        for (int j = k + 1; j < n; ++j) sum -= A[k][j] * x[j];
+        x[k] = sum / A[k][k];
+    }
+    for (int j = 0; j < n; ++j) x[j] *= scale[j];
+    return x;
+}
+
+vector<complex<double>> eigenvalues(vector<vector<double>> a) {
+    int n = a.size();
+    const double eps = numeric_limits<double>::epsilon();
+
+    // Balancing by powers of 2 so that row and column norms are comparable
+    for (bool done = false; !done;) {
+        done = true;
+        for (int i = 0; i < n; ++i) {
+            double r = 0.0, c = 0.0;
+            for (int j = 0; j < n; ++j) {
+                if (j == i) continue;
+                c += fabs(a[j][i]);
+                r += fabs(a[i][j]);
+            }
+            if (c == 0.0 || r == 0.0) continue;
+            double g = r / 2.0, f = 1.0, sum = c + r;
+            while (c < g) {
+                f *= 2.0;
+                c *= 4.0;
+            }
+            g = r * 2.0;
+            while (c > g) {
+                f /= 2.0;
+                c /= 4.0;
+            }
+            if ((c + r) / f < 0.95 * sum) {
+                done = false;
+                for (int j = 0; j < n; ++j) a[i][j] /= f;
+                for (int j = 0; j < n; ++j) a[j][i] *= f;
+            }
+        }
+    }
+
+    // Hessenberg form by stabilized elimination
+    for (int m = 1; m < n - 1; ++m) {
+        double x = 0.0;
+        int i = m;
+        for (int j = m; j < n; ++j) {
+            if (fabs(a[j][m - 1]) > fabs(x)) {
+                x = a[j][m - 1];
+                i = j;
+            }
+        }
+        if (i != m) {
+            for (int j = m - 1; j < n; ++j) swap(a[i][j], a[m][j]);
+            for (int j = 0; j < n; ++j) swap(a[j][i], a[j][m]);
+        }
+        if (x == 0.0) continue;
+        for (i = m + 1; i < n; ++i) {
+            double y = a[i][m - 1];
+            if (y == 0.0) continue;
+            y /= x;
+            for (int j = m; j < n; ++j) a[i][j] -= y * a[m][j];
+            for (int j = 0; j < n; ++j) a[j][m] += y * a[j][i];
+        }
+    }
+    for (int i = 2; i < n; ++i) {
+        for (int j = 0; j < i - 1; ++j) a[i][j] = 0.0;
+    }
+
+    // Francis double-shift QR, deflating one or two eigenvalues at a time from the bottom
+    vector<complex<double>> w(n);
+    double norm = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int j = max(i - 1, 0); j < n; ++j) norm += fabs(a[i][j]);
+    }
+    int nn = n - 1, l = 0;
+    double t = 0.0;
+    while (nn >= 0) {
+        int its = 0;
+        do {
+            for (l = nn; l > 0; --l) {
+                double s = fabs(a[l - 1][l - 1]) + fabs(a[l][l]);
+                if (s == 0.0) s = norm;
+                if (fabs(a[l][l - 1]) <= eps * s) {
+                    a[l][l - 1] = 0.0;
+                    break;
+                }
+            }
+            double x = a[nn][nn];
+            if (l == nn) {
+                w[nn--] = x + t;
+                continue;
+            }
+            double y = a[nn - 1][nn - 1];
+            double ww = a[nn][nn - 1] * a[nn - 1][nn];
+            if (l == nn - 1) {
+                double p = 0.5 * (y - x), q = p * p + ww, z = sqrt(fabs(q));
+                x += t;
+                if (q >= 0.0) {
+                    z = p + (p >= 0.0 ? z : -z);
+                    w[nn - 1] = w[nn] = x + z;
+                    if (z != 0.0) w[nn] = x - ww / z;
+                } else {
+                    w[nn - 1] = complex<double>(x + p, z);
+                    w[nn] = complex<double>(x + p, -z);
+                }
+                nn -= 2;
+                continue;
+            }
+            if (its == 60) {
+                throw runtime_error("eigenvalues: QR iteration did not converge.");
+            }
+            if (its == 10 || its == 20) {
+                // Exceptional shift
+                t += x;
+                for (int i = 0; i <= nn; ++i) a[i][i] -= x;
+                double s = fabs(a[nn][nn - 1]) + fabs(a[nn - 1][nn - 2]);
+                y = x = 0.75 * s;
+                ww = -0.4375 * s * s;
+            }
+            ++its;
+            int m;
+            double p = 0.0, q = 0.0, r = 0.0, z;
+            for (m = nn - 2; m >= l; --m) {
+                z = a[m][m];
+                r = x - z;
+                double s = y - z;
+                p = (r * s - ww) / a[m + 1][m] + a[m][m + 1];
+                q = a[m + 1][m + 1] - z - r - s;
+                r = a[m + 2][m + 1];
+                s = fabs(p) + fabs(q) + fabs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l) break;
+                double u = fabs(a[m][m - 1]) * (fabs(q) + fabs(r));
+                double v = fabs(p) * (fabs(a[m - 1][m - 1]) + fabs(z) + fabs(a[m + 1][m + 1]));
+                if (u <= eps * v) break;
+            }
+            for (int i = m; i < nn - 1; ++i) {
+                a[i + 2][i] = 0.0;
+                if (i != m) a[i + 2][i - 1] = 0.0;
+            }
+            for (int k = m; k < nn; ++k) {
+                if (k != m) {
+                    p = a[k][k - 1];
+                    q = a[k + 1][k - 1];
+                    r = k + 1 != nn ? a[k + 2][k - 1] : 0.0;
+                    x = fabs(p) + fabs(q) + fabs(r);
+                    if (x != 0.0) {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                double s = sqrt(p * p + q * q + r * r);
+                if (p < 0.0) s = -s;
+                if (s == 0.0) continue;
+                if (k == m) {
+                    if (l != m) a[k][k - 1] = -a[k][k - 1];
+                } else {
+                    a[k][k - 1] = -s * x;
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                for (int j = k; j <= nn; ++j) {
+                    p = a[k][j] + q * a[k + 1][j];
+                    if (k + 1 != nn) {
+                        p += r * a[k + 2][j];
+                        a[k + 2][j] -= p * z;
+                    }
+                    a[k + 1][j] -= p * y;
+                    a[k][j] -= p * x;
+                }
+                int last = min(nn, k + 3);
+                for (int i = l; i <= last; ++i) {
+                    p = x * a[i][k] + y * a[i][k + 1];
+                    if (k + 1 != nn) {
+                        p += z * a[i][k + 2];
+                        a[i][k + 2] -= p * r;
+                    }
+                    a[i][k + 1] -= p * q;
+                    a[i][k] -= p;
+                }
+            }
+        } while (l + 1 < nn);
+    }
+    return w;
+}
+
+bool SparseLU::factorize(int n, const vector<vector<pair<int, double>>>& rows) {
+    size = n;
+    steps.clear();
+    vector<unordered_map<int, double>> A(n);
+    vector<unordered_set<int>> columnRows(n);
+    for (int i = 0; i < n && i < static_cast<int>(rows.size()); ++i) {
+        for (const auto& entry : rows[i]) {
+            A[i][entry.first] += entry.second;
+            columnRows[entry.first].insert(i);
+        }
+    }
+
+    // Active columns ordered by their number of entries
+    set<pair<size_t, int>> byCount;
+    for (int j = 0; j < n; ++j) {
+        byCount.insert({columnRows[j].size(), j});
+    }
+    auto changeColumn = [&](int j, int row, bool add) {
+        byCount.erase({columnRows[j].size(), j});
+        if (add) {
+            columnRows[j].insert(row);
+        } else {
+            columnRows[j].erase(row);
+        }
+        byCount.insert({columnRows[j].size(), j});
+    };
+
+    steps.reserve(n);
+    for (int k = 0; k < n; ++k) {
+        int col = byCount.begin()->second;
+        byCount.erase(byCount.begin());
+
+        double largest = 0.0;
+        for (int i : columnRows[col]) {
+            largest = max(largest, fabs(A[i][col]));
+        }
+        if (largest == 0.0) {
+            steps.clear();
+            return false;
+        }
+        int row = -1;
+        for (int i : columnRows[col]) {
+            if (fabs(A[i][col]) >= 0.1 * largest && (row == -1 || A[i].size() < A[row].size())) {
+                row = i;
+            }
+        }
+
+        Step step;
+        step.row = row;
+        step.col = col;
+        step.pivot = A[row][col];
+        for (const auto& entry : A[row]) {
+            if (entry.first == col) continue;
+            step.upper.push_back(entry);
+            changeColumn(entry.first, row, false);
+        }
+        columnRows[col].erase(row);
+
+        for (int i : columnRows[col]) {
+            double factor = A[i][col] / step.pivot;
+            A[i].erase(col);
+            step.lower.push_back({i, factor});
+            for (const auto& entry : step.upper) {
+                auto it = A[i].find(entry.first);
+                if (it == A[i].end()) {
+                    A[i][entry.first] = -factor * entry.second;
+                    changeColumn(entry.first, i, true);
+                } else {
+                    it->second -= factor * entry.second;
+                }
+            }
+        }
+        columnRows[col].clear();
+        A[row].clear();
+        steps.push_back(std::move(step));
+    }
+    return true;
+}
+
+vector<double> SparseLU::solve(const vector<double>& b) const {
+    vector<double> y = b;
+    for (const auto& step : steps) {
+        double pivotValue = y[step.row];
+        if (pivotValue == 0.0) continue;
+        for (const auto& entry : step.lower) {
+            y[entry.first] -= entry.second * pivotValue;
+        }
+    }
+    vector<double> x(size, 0.0);
+    for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+        double sum = y[it->row];
+        for (const auto& entry : it->upper) {
+            sum -= entry.second * x[entry.first];
+        }
+        x[it->col] = sum / it->pivot;
+    }
+    return x;
+}
+
+size_t SparseLU::nonzeros() const {
+    size_t count = 0;
+    for (const auto& step : steps) {
+        count += 1 + step.upper.size() + step.lower.size();
+    }
+    return count;
+}
@@ -0,0 +1,313 @@
+#include "ModelReduction.h"
+#include "LinearSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <set>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+namespace {
+
+typedef vector<vector<pair<int, double>>> SparseRows;
+
+struct NodeSets {
+    vector<int> parent;
+
+    explicit NodeSets(int n) : parent(n) {
+        iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void join(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) parent[b] = a;
+    }
+};
+
+// Components of one subnetwork (indices into the circuit's vectors) and its local unknowns:
+// ports, then internal nodes, then the currents of the inductors
+struct Subnetwork {
+    vector<size_t> resistors, capacitors, inductors;
+    vector<Node*> ports;
+    vector<Node*> internal;
+};
+
+double norm(const vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x * x;
+    return sqrt(sum);
+}
+
+vector<double> multiply(const SparseRows& rows, const vector<double>& x) {
+    vector<double> y(rows.size(), 0.0);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (const auto& entry : rows[i]) y[i] += entry.second * x[entry.first];
+    }
+    return y;
+}
+
+// Local descriptor system in the passive form of Circuit::descriptorSystem
+void assemble(const Circuit& circuit, const Subnetwork& sub, SparseRows& g, SparseRows& c) {
+    map<const Node*, int> index;
+    for (size_t k = 0; k < sub.ports.size(); ++k) index[sub.ports[k]] = k;
+    for (size_t k = 0; k < sub.internal.size(); ++k) index[sub.internal[k]] = sub.ports.size() + k;
+    int size = sub.ports.size() + sub.internal.size() + sub.inductors.size();
+    g.assign(size, {});
+    c.assign(size, {});
+
+    auto local = [&](const Node* node) {
+        auto it = index.find(node);
+        return it == index.end() ? -1 : it->second;
+    };
+    auto stamp = [&](SparseRows& a, const Node* node1, const Node* node2, double value) {
+        int i = local(node1), j = local(node2);
+        if (i == j) return;
+        if (i != -1) a[i].push_back({i, value});
+        if (j != -1) a[j].push_back({j, value});
+        if (i != -1 && j != -1) {
+            a[i].push_back({j, -value});
+            a[j].push_back({i, -value});
+        }
+    };
+    for (size_t r : sub.resistors) {
+        const Resistor& res = circuit.resistors[r];
+        stamp(g, res.node1, res.node2, 1.0 / res.resistance);
+    }
+    for (size_t k : sub.capacitors) {
+        const Capacitor& cap = circuit.capacitors[k];
+        stamp(c, cap.node1, cap.node2, cap.capacitance);
+    }
+    int branch = sub.ports.size() + sub.internal.size();
+    for (size_t k : sub.inductors) {
+        const Inductor& ind = circuit.inductors[k];
+        int i = local(ind.node1), j = local(ind.node2);
+        if (i != -1) {
+            g[i].push_back({branch, 1.0});
+            g[branch].push_back({i, -1.0});
+        }
+        if (j != -1) {
+            g[j].push_back({branch, -1.0});
+            g[branch].push_back({j, 1.0});
+        }
+        c[branch].push_back({branch, ind.inductance});
+        branch++;
+    }
+}
+
+// Orthonormal basis of the block Krylov space of K0^-1 C_ii started from K0^-1 [B0, C_ip]
+// (block Arnoldi, modified Gram-Schmidt twice). Columns that fall below 1e-10 of their length
+// before orthogonalization are deflated; a block left empty ends the iteration.
+vector<vector<double>> krylovBasis(const SparseLU& k0, const SparseRows& cii,
+                                   const vector<vector<double>>& start, int moments, int maxOrder) {
+    vector<vector<double>> basis;
+    auto append = [&](vector<double> w) {
+        double length = norm(w);
+        if (length == 0.0 || !isfinite(length)) return false;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const auto& v : basis) {
+                double dot = inner_product(w.begin(), w.end(), v.begin(), 0.0);
+                for (size_t i = 0; i < w.size(); ++i) w[i] -= dot * v[i];
+            }
+        }
+        double remaining = norm(w);
+        if (remaining <= 1e-10 * length) return false;
+        for (double& x : w) x /= remaining;
+        basis.push_back(w);
+        return true;
+    };
+
+    size_t dimension = start.empty() ? 0 : start[0].size();
+    vector<size_t> block;
+    for (const auto& column : start) {
+        if (basis.size() >= static_cast<size_t>(maxOrder) || basis.size() >= dimension) break;
+        if (append(k0.solve(column))) block.push_back(basis.size() - 1);
+    }
+    for (int moment = 1; moment < moments && !block.empty(); ++moment) {
+        vector<size_t> next;
+        for (size_t b : block) {
+            if (basis.size() >= static_cast<size_t>(maxOrder) || basis.size() >= dimension) break;
+            if (append(k0.solve(multiply(cii, basis[b])))) next.push_back(basis.size() - 1);
+        }
+        block = next;
+    }
+    return basis;
+}
+
+} // namespace
+
+int reduceLinearSubnetworks(Circuit& circuit) {
+    const ReductionSettings& settings = circuit.reductionSettings;
+
+    // Ports: every node a non-RLC element or an existing macromodel touches, and keepNodes
+    set<const Node*> kept;
+    auto keep = [&](const Node* node) {
+        if (node && !node->isGround) kept.insert(node);
+    };
+    for (const auto& d : circuit.diodes) { keep(d.node1); keep(d.node2); }
+    for (const auto& v : circuit.voltageSources) { keep(v.node1); keep(v.node2); }
+    for (const auto& v : circuit.acVoltageSources) { keep(v.node1); keep(v.node2); }
+    for (const auto& s : circuit.currentSources) { keep(s.node1); keep(s.node2); }
+    for (const auto& model : circuit.reducedModels) {
+        for (const Node* port : model.ports) keep(port);
+    }
+    for (const auto& name : settings.keepNodes) keep(circuit.findNode(name));
+
+    map<const Node*, int> position;
+    for (size_t i = 0; i < circuit.nodes.size(); ++i) position[circuit.nodes[i]] = i;
+    auto internal = [&](const Node* node) {
+        return node && !node->isGround && !kept.count(node);
+    };
+
+    // Internal nodes joined through resistors, capacitors and inductors
+    NodeSets sets(circuit.nodes.size());
+    auto join = [&](const Node* a, const Node* b) {
+        if (internal(a) && internal(b)) sets.join(position[a], position[b]);
+    };
+    for (const auto& r : circuit.resistors) join(r.node1, r.node2);
+    for (const auto& c : circuit.capacitors) join(c.node1, c.node2);
+    for (const auto& l : circuit.inductors) join(l.node1, l.node2);
+
+    map<int, Subnetwork> groups;
+    auto owner = [&](const Node* a, const Node* b) {
+        if (internal(a)) return sets.find(position[a]);
+        if (internal(b)) return sets.find(position[b]);
+        return -1;
+    };
+    for (size_t k = 0; k < circuit.resistors.size(); ++k) {
+        int g = owner(circuit.resistors[k].node1, circuit.resistors[k].node2);
+        if (g != -1) groups[g].resistors.push_back(k);
+    }
+    for (size_t k = 0; k < circuit.capacitors.size(); ++k) {
+        int g = owner(circuit.capacitors[k].node1, circuit.capacitors[k].node2);
+        if (g != -1) groups[g].capacitors.push_back(k);
+    }
+    for (size_t k = 0; k < circuit.inductors.size(); ++k) {
+        int g = owner(circuit.inductors[k].node1, circuit.inductors[k].node2);
+        if (g != -1) groups[g].inductors.push_back(k);
+    }
+
+    double s0 = 2.0 * M_PI * settings.expansionFrequency;
+    set<size_t> removedResistors, removedCapacitors, removedInductors;
+    set<const Node*> removedNodes;
+    int reduced = 0;
+
+    for (auto& group : groups) {
+        Subnetwork& sub = group.second;
+        set<const Node*> seen;
+        auto touch = [&](Node* node) {
+            if (!node || node->isGround || !seen.insert(node).second) return;
+            if (internal(node)) sub.internal.push_back(node);
+            else sub.ports.push_back(node);
+        };
+        for (size_t k : sub.resistors) { touch(circuit.resistors[k].node1); touch(circuit.resistors[k].node2); }
+        for (size_t k : sub.capacitors) { touch(circuit.capacitors[k].node1); touch(circuit.capacitors[k].node2); }
+        for (size_t k : sub.inductors) { touch(circuit.inductors[k].node1); touch(circuit.inductors[k].node2); }
+        if (static_cast<int>(sub.internal.size()) < settings.minInternalNodes || sub.ports.empty()) {
+            continue;
+        }
+
+        SparseRows g, c;
+        assemble(circuit, sub, g, c);
+        int ports = sub.ports.size();
+        int inner = g.size() - ports;
+
+        // K0 = G_ii + s0 C_ii, C_ii, and the port input columns B0 = G_ip + s0 C_ip and C_ip
+        SparseRows k0Rows(inner), cii(inner);
+        vector<vector<double>> start(2 * ports, vector<double>(inner, 0.0));
+        for (int i = 0; i < inner; ++i) {
+            for (const auto& entry : g[ports + i]) {
+                if (entry.first >= ports) k0Rows[i].push_back({entry.first - ports, entry.second});
+                else start[entry.first][i] -= entry.second;
+            }
+            for (const auto& entry : c[ports + i]) {
+                if (entry.first >= ports) {
+                    k0Rows[i].push_back({entry.first - ports, s0 * entry.second});
+                    cii[i].push_back({entry.first - ports, entry.second});
+                } else {
+                    start[entry.first][i] -= s0 * entry.second;
+                    start[ports + entry.first][i] -= entry.second;
+                }
+            }
+        }
+        SparseLU k0;
+        if (!k0.factorize(inner, k0Rows)) {
+            cerr << "Warning: skipping a linear subnetwork of " << sub.internal.size()
+                 << " nodes: G + s0 C is singular inside it (no resistive path to a port; try a nonzero expansion frequency)." << endl;
+            continue;
+        }
+        vector<vector<double>> X = krylovBasis(k0, cii, start, max(1, settings.moments), max(1, settings.maxOrder));
+
+        // Gr = V^T G V and Cr = V^T C V with V = blockdiag(I, X)
+        int order = ports + X.size();
+        vector<vector<double>> columns(order, vector<double>(ports + inner, 0.0));
+        for (int k = 0; k < ports; ++k) columns[k][k] = 1.0;
+        for (size_t k = 0; k < X.size(); ++k) {
+            copy(X[k].begin(), X[k].end(), columns[ports + k].begin() + ports);
+        }
+        ReducedModel model;
+        model.name = "PRIMA" + to_string(circuit.reducedModels.size() + 1);
+        model.ports = sub.ports;
+        model.G.assign(order, vector<double>(order, 0.0));
+        model.C.assign(order, vector<double>(order, 0.0));
+        for (int b = 0; b < order; ++b) {
+            vector<double> gv = multiply(g, columns[b]);
+            vector<double> cv = multiply(c, columns[b]);
+            for (int a = 0; a < order; ++a) {
+                model.G[a][b] = inner_product(columns[a].begin(), columns[a].end(), gv.begin(), 0.0);
+                model.C[a][b] = inner_product(columns[a].begin(), columns[a].end(), cv.begin(), 0.0);
+            }
+        }
+        model.states.assign(X.size(), 0.0);
+        model.resetHistory();
+        circuit.reducedModels.push_back(model);
+
+        removedResistors.insert(sub.resistors.begin(), sub.resistors.end());
+        removedCapacitors.insert(sub.capacitors.begin(), sub.capacitors.end());
+        removedInductors.insert(sub.inductors.begin(), sub.inductors.end());
+        removedNodes.insert(sub.internal.begin(), sub.internal.end());
+        circuit.reductionStats.subnetworks++;
+        circuit.reductionStats.removedNodes += sub.internal.size();
+        circuit.reductionStats.removedComponents += sub.resistors.size() + sub.capacitors.size() + sub.inductors.size();
+        circuit.reductionStats.states += X.size();
+        reduced++;
+        cout << "// " << circuit.reducedModels.back().name << ": " << sub.internal.size() << " internal nodes, "
+             << sub.ports.size() << " ports -> " << X.size() << " states" << endl;
+    }
+    if (reduced == 0) {
+        return 0;
+    }
+
+    auto erase = [](auto& components, const set<size_t>& removed) {
+        size_t next = 0;
+        for (size_t k = 0; k < components.size(); ++k) {
+            if (!removed.count(k)) components[next++] = components[k];
+        }
+        components.resize(next);
+    };
+    erase(circuit.resistors, removedResistors);
+    erase(circuit.capacitors, removedCapacitors);
+    erase(circuit.inductors, removedInductors);
+    vector<Node*> remaining;
+    for (Node* node : circuit.nodes) {
+        if (removedNodes.count(node)) delete node;
+        else remaining.push_back(node);
+    }
+    circuit.nodes = remaining;
+    circuit.assignDiodeBranchIndices();
+    return reduced;
+}
@@ -0,0 +1,189 @@
+#include "NewtonSolver.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+void NewtonSolver::invalidate() {
+    linearValid = false;
+    factored = false;
+    keyed = false;
+    cache.clear();
+}
+
+void NewtonSolver::selectMatrix(const MatrixStampKey& key, bool recurring) {
+    if (keyed && key == currentKey) {
+        currentRecurring = currentRecurring || recurring;
+        return;
+    }
+    if (keyed && linearValid && currentRecurring && settings.cacheEntries > 0) {
+        cache.push_front({currentKey, std::move(linearMatrix), std::move(lu), factored});
+        if (cache.size() > static_cast<size_t>(settings.cacheEntries)) {
+            cache.pop_back();
+        }
+    }
+    currentKey = key;
+    keyed = true;
+    currentRecurring = recurring;
+
+    auto hit = find_if(cache.begin(), cache.end(), [&](const CachedMatrix& entry) { return entry.key == key; });
+    if (hit == cache.end()) {
+        linearValid = false;
+        factored = false;
+        stats.cacheMisses++;
+        return;
+    }
+    linearMatrix = std::move(hit->linearMatrix);
+    lu = std::move(hit->lu);
+    factored = hit->factored;
+    linearValid = true;
+    cache.erase(hit);
+    stats.cacheHits++;
+}
+
+// Companion model of each Shockley diode at its junction voltage: i = gd * v + Ieq
+void NewtonSolver::stampDiodes(Circuit& circuit, const vector<int>& n1, const vector<int>& n2,
+                               vector<vector<double>>& A, vector<double>& b) const {
+    for (size_t k = 0; k < circuit.diodes.size(); ++k) {
+        Diode& d = circuit.diodes[k];
+        if (d.getModel() != MODEL_SHOCKLEY) continue;
+        double vd = d.junctionVoltage;
+        // Bypass: a junction that has barely moved keeps its previous linearization. The device
+        // check in solve() still evaluates the exponential, so the converged point is unchanged.
+        if (settings.bypassTol > 0.0 && d.stampValid &&
+            fabs(vd - d.stampVoltage) <= settings.bypassTol * (1.0 + fabs(vd))) {
+            circuit.deviceActivity.bypassed++;
+        } else {
+            d.stampConductance = d.shockleyConductance(vd);
+            d.stampCurrent = d.shockleyCurrent(vd) - d.stampConductance * vd;
+            d.stampVoltage = vd;
+            d.stampValid = true;
+            circuit.deviceActivity.evaluated++;
+        }
+        double gd = d.stampConductance;
+        double ieq = d.stampCurrent;
+        int a = n1[k], c = n2[k];
+        if (a != -1) {
+            A[a][a] += gd;
+            b[a] -= ieq;
+        }
+        if (c != -1) {
+            A[c][c] += gd;
+            b[c] += ieq;
+        }
+        if (a != -1 && c != -1) {
+            A[a][c] -= gd;
+            A[c][a] -= gd;
+        }
+    }
+}
+
+bool NewtonSolver::solve(Circuit& circuit, AnalysisType type, vector<double>& x) {
+    if (!linearValid) {
+        circuit.set_MNA_A(type);
+        linearMatrix = circuit.MNA_A;
+        linearValid = true;
+        factored = false;
+    }
+    circuit.set_MNA_RHS(type);
+    const vector<double>& rhs = circuit.MNA_RHS;
+    int size = linearMatrix.size();
+    if (x.size() != static_cast<size_t>(size)) {
+        x.assign(size, 0.0);
+    }
+
+    vector<int> n1, n2;
+    bool nonlinear = false;
+    for (const auto& d : circuit.diodes) {
+        n1.push_back(circuit.getNodeMatrixIndex(d.node1));
+        n2.push_back(circuit.getNodeMatrixIndex(d.node2));
+        if (d.getModel() == MODEL_SHOCKLEY) nonlinear = true;
+    }
+
+    if (!nonlinear) {
+        if (!factored) {
+            lu = luFactorize(linearMatrix);
+            factored = true;
+            stats.factorizations++;
+        }
+        x = luSolve(lu, rhs);
+        stats.solves++;
+        stats.iterations++;
+        return true;
+    }
+
+    auto diodeVoltage = [&](size_t k, const vector<double>& v) {
+        double va = n1[k] != -1 ? v[n1[k]] : 0.0;
+        double vc = n2[k] != -1 ? v[n2[k]] : 0.0;
+        return va - vc;
+    };
+
+    double prev_update = -1.0;
+    bool refactor = !factored;
+    for (int iter = 0; iter < settings.maxIterations; ++iter) {
+        vector<vector<double>> A = linearMatrix;
+        vector<double> b = rhs;
+        stampDiodes(circuit, n1, n2, A, b);
+
+        if (refactor) {
+            lu = luFactorize(A);
+            factored = true;
+            refactor = false;
+            stats.factorizations++;
+        }
+
+        // Residual of the linearized system at the current iterate; with a fresh factorization
+        // this is a full Newton step, with a kept one a chord (modified Newton) step
+        vector<double> r(size, 0.0);
+        for (int i = 0; i < size; ++i) {
+            double sum = -b[i];
+            for (int j = 0; j < size; ++j) {
+                sum += A[i][j] * x[j];
+            }
+            r[i] = sum;
+        }
+        vector<double> dx = luSolve(lu, r);
+        stats.solves++;
+        stats.iterations++;
+
+        bool update_converged = true;
+        double update_norm = 0.0;
+        for (int i = 0; i < size; ++i) {
+            double x_new = x[i] - dx[i];
+            double tol = settings.relTol * max(fabs(x_new), fabs(x[i])) + settings.voltageTol;
+            if (fabs(dx[i]) > tol) update_converged = false;
+            update_norm = max(update_norm, fabs(dx[i]));
+            x[i] = x_new;
+        }
+
+        // Device check: the exponential at the new voltage must agree with the linearization
+        bool current_converged = true;
+        for (size_t k = 0; k < circuit.diodes.size(); ++k) {
+            Diode& d = circuit.diodes[k];
+            if (d.getModel() != MODEL_SHOCKLEY) continue;
+            double v = diodeVoltage(k, x);
+            double vd = d.junctionVoltage;
+            double i_lin = d.shockleyCurrent(vd) + d.shockleyConductance(vd) * (v - vd);
+            double i_exact = d.shockleyCurrent(v);
+            double tol = settings.relTol * max(fabs(i_exact), fabs(i_lin)) + settings.currentTol;
+            if (fabs(i_exact - i_lin) > tol) current_converged = false;
+
+            double v_limited = d.limitJunctionVoltage(v, vd);
+            if (v_limited != v) current_converged = false;
+            d.junctionVoltage = v_limited;
+            d.setCurrent(d.shockleyCurrent(v_limited));
+        }
+
+        if (update_converged && current_converged) {
+            return true;
+        }
+
+        if (prev_update > 0.0 && update_norm > settings.slowRatio * prev_update) {
+            refactor = true;
+        }
+        prev_update = update_norm;
+    }
+
+    stats.failures++;
+    return false;
+}
@@ -32,7 +32,5 @@ void Node::addVoltageHistoryPoint(double time, double vol) {
 void Node::clearHistory() {
     voltage_history.clear();
     dc_sweep_history.clear();
-    ac_sweep_history.clear();
-    phase_sweep_history.clear();
 }
 
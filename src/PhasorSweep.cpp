@@ -0,0 +1,38 @@
+#include "PhasorSweep.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void PhasorSweep::reset(const vector<string>& signalNames) {
+    signals = signalNames;
+    sweep.clear();
+    values.clear();
+}
+
+void PhasorSweep::addPoint(double sweepValue, const vector<complex<double>>& point) {
+    sweep.push_back(sweepValue);
+    values.insert(values.end(), point.begin(), point.begin() + min(point.size(), signals.size()));
+    values.resize(sweep.size() * signals.size(), {0.0, 0.0});
+}
+
+void PhasorSweep::clear() {
+    reset({});
+}
+
+int PhasorSweep::signalIndex(const string& name) const {
+    auto it = find(signals.begin(), signals.end(), name);
+    return it == signals.end() ? -1 : static_cast<int>(it - signals.begin());
+}
+
+double PhasorSweep::magnitude(size_t point, size_t signal) const {
+    return abs(phasor(point, signal));
+}
+
+double PhasorSweep::decibels(size_t point, size_t signal) const {
+    return 20.0 * log10(magnitude(point, signal));
+}
+
+double PhasorSweep::phaseDegrees(size_t point, size_t signal) const {
+    return arg(phasor(point, signal)) * 180.0 / M_PI;
+}
@@ -0,0 +1,81 @@
+#include "ReducedModel.h"
+#include "Node.h"
+
+using namespace std;
+
+vector<double> ReducedModel::unknowns() const {
+    vector<double> x;
+    for (const Node* port : ports) {
+        x.push_back(port->getVoltage());
+    }
+    x.insert(x.end(), states.begin(), states.end());
+    x.resize(G.size(), 0.0);
+    return x;
+}
+
+double ReducedModel::companionFactor(IntegrationMethod method, double dt, double prev_dt) const {
+    if (method == IntegrationMethod::TRAPEZOIDAL) {
+        return 2.0 / dt;
+    }
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        return a0 / dt;
+    }
+    return 1.0 / dt;
+}
+
+vector<double> ReducedModel::companionCurrent(IntegrationMethod method, double dt, double prev_dt) const {
+    size_t n = G.size();
+    // Combination of past points whose charge the history current carries
+    vector<double> past(n, 0.0);
+    if (method == IntegrationMethod::GEAR2 && prev_dt > 0.0) {
+        double a0, a1, a2;
+        gear2Coefficients(dt, prev_dt, a0, a1, a2);
+        for (size_t i = 0; i < n; ++i) past[i] = -(a1 * prevX[i] + a2 * prevPrevX[i]) / dt;
+    } else {
+        double factor = companionFactor(method, dt, prev_dt);
+        for (size_t i = 0; i < n; ++i) past[i] = factor * prevX[i];
+    }
+    vector<double> current(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) current[i] += C[i][j] * past[j];
+        if (method == IntegrationMethod::TRAPEZOIDAL) current[i] += prevCurrent[i];
+    }
+    return current;
+}
+
+void ReducedModel::update(double dt, IntegrationMethod method, double prev_dt) {
+    vector<double> x = unknowns();
+    double factor = companionFactor(method, dt, prev_dt);
+    vector<double> history = companionCurrent(method, dt, prev_dt);
+    for (size_t i = 0; i < x.size(); ++i) {
+        double charge = 0.0;
+        for (size_t j = 0; j < x.size(); ++j) charge += C[i][j] * x[j];
+        prevCurrent[i] = factor * charge - history[i];
+    }
+    prevPrevX = prevX;
+    prevX = x;
+}
+
+void ReducedModel::resetHistory() {
+    prevX = unknowns();
+    prevPrevX = prevX;
+    prevCurrent.assign(G.size(), 0.0);
+}
+
+vector<double> ReducedModel::historyState() const {
+    vector<double> state = prevX;
+    state.insert(state.end(), prevPrevX.begin(), prevPrevX.end());
+    state.insert(state.end(), prevCurrent.begin(), prevCurrent.end());
+    return state;
+}
+
+void ReducedModel::restoreHistoryState(const vector<double>& state) {
+    size_t n = G.size();
+    if (state.size() != 3 * n) return;
+    prevX.assign(state.begin(), state.begin() + n);
+    prevPrevX.assign(state.begin() + n, state.begin() + 2 * n);
+    prevCurrent.assign(state.begin() + 2 * n, state.end());
+    states.assign(prevX.begin() + ports.size(), prevX.end());
+}
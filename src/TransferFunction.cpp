@@ -0,0 +1,226 @@
+#include "TransferFunction.h"
+#include "LinearSolver.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+namespace {
+
+// Partial fractions over the samples s[k], one column per pole. A complex pair a, conj(a)
+// gets the real-coefficient columns 1/(s-a) + 1/(s-conj a) and j/(s-a) - j/(s-conj a), whose
+// coefficients c1, c2 stand for the residues c1 + j c2 and c1 - j c2.
+vector<vector<complex<double>>> poleBasis(const vector<complex<double>>& poles, const vector<complex<double>>& s) {
+    vector<vector<complex<double>>> basis(s.size(), vector<complex<double>>(poles.size()));
+    const complex<double> j(0.0, 1.0);
+    for (size_t k = 0; k < s.size(); ++k) {
+        for (size_t n = 0; n < poles.size(); ++n) {
+            if (poles[n].imag() == 0.0) {
+                basis[k][n] = 1.0 / (s[k] - poles[n]);
+                continue;
+            }
+            complex<double> a = 1.0 / (s[k] - poles[n]), b = 1.0 / (s[k] - conj(poles[n]));
+            basis[k][n] = a + b;
+            basis[k][n + 1] = j * a - j * b;
+            ++n;
+        }
+    }
+    return basis;
+}
+
+// Residues from the real coefficients of poleBasis
+vector<complex<double>> residuesFrom(const vector<complex<double>>& poles, const vector<double>& c) {
+    vector<complex<double>> residues(poles.size());
+    for (size_t n = 0; n < poles.size(); ++n) {
+        if (poles[n].imag() == 0.0) {
+            residues[n] = c[n];
+            continue;
+        }
+        residues[n] = complex<double>(c[n], c[n + 1]);
+        residues[n + 1] = conj(residues[n]);
+        ++n;
+    }
+    return residues;
+}
+
+// Zeros of sigma(s) = 1 + sum c_n phi_n(s): the eigenvalues of A - b c^T for the real
+// realization (A, b) of the basis, a pair a = x + jy contributing the block [x y; -y x] with
+// b = (2, 0). Unstable zeros are mirrored into the left half plane.
+vector<complex<double>> relocatePoles(const vector<complex<double>>& poles, const vector<double>& c) {
+    size_t N = poles.size();
+    vector<vector<double>> H(N, vector<double>(N, 0.0));
+    vector<double> b(N, 0.0);
+    for (size_t n = 0; n < N; ++n) {
+        if (poles[n].imag() == 0.0) {
+            H[n][n] = poles[n].real();
+            b[n] = 1.0;
+            continue;
+        }
+        H[n][n] = H[n + 1][n + 1] = poles[n].real();
+        H[n][n + 1] = poles[n].imag();
+        H[n + 1][n] = -poles[n].imag();
+        b[n] = 2.0;
+        ++n;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t k = 0; k < N; ++k) H[i][k] -= b[i] * c[k];
+    }
+
+    vector<complex<double>> relocated;
+    for (const auto& zero : eigenvalues(H)) {
+        complex<double> p(-fabs(zero.real()), fabs(zero.imag()));
+        if (zero.imag() == 0.0) {
+            relocated.push_back(p);
+        } else if (zero.imag() > 0.0) {
+            relocated.push_back(p);
+            relocated.push_back(conj(p));
+        }
+    }
+    return relocated.size() == N ? relocated : poles;
+}
+
+} // namespace
+
+double TransferFunction::fit(const vector<double>& frequencies, const vector<vector<complex<double>>>& samples,
+                             int order, int iterations) {
+    size_t K = frequencies.size();
+    size_t N = max(order, 1);
+    poles.clear();
+    residues.assign(samples.size(), {});
+    constants.assign(samples.size(), 0.0);
+    proportional.assign(samples.size(), 0.0);
+    rmsError = 0.0;
+    if (K == 0 || samples.empty()) {
+        return rmsError;
+    }
+
+    vector<complex<double>> s(K);
+    for (size_t k = 0; k < K; ++k) s[k] = complex<double>(0.0, 2.0 * M_PI * frequencies[k]);
+    // Each output is fitted relative to its largest sample, so all weigh alike in the poles
+    vector<double> scale(samples.size(), 0.0);
+    for (size_t m = 0; m < samples.size(); ++m) {
+        for (const auto& value : samples[m]) scale[m] = max(scale[m], abs(value));
+        if (scale[m] == 0.0) scale[m] = 1.0;
+    }
+
+    // Starting poles: pairs -w/100 +- jw with w spread logarithmically over the band, and a
+    // real pole in the middle of it for an odd order
+    double w0 = 2.0 * M_PI * *min_element(frequencies.begin(), frequencies.end());
+    double w1 = 2.0 * M_PI * *max_element(frequencies.begin(), frequencies.end());
+    w0 = max(w0, w1 * 1e-9);
+    size_t pairs = N / 2;
+    for (size_t i = 0; i < pairs; ++i) {
+        double w = pairs == 1 ? sqrt(w0 * w1) : w0 * pow(w1 / w0, i / static_cast<double>(pairs - 1));
+        poles.push_back(complex<double>(-w / 100.0, w));
+        poles.push_back(complex<double>(-w / 100.0, -w));
+    }
+    if (N % 2 == 1) {
+        poles.push_back(-sqrt(w0 * w1));
+    }
+
+    // Columns of one output's system: partial fractions (N), d, e, then -f times the partial
+    // fractions (N) for sigma's coefficients. Only the rows of its QR factor that involve
+    // sigma alone are kept, which leaves sigma's coefficients as one small least-squares
+    // problem over all outputs (the fast form of vector fitting).
+    double d_scale = 1.0 / sqrt(static_cast<double>(K)), e_scale = 0.0;
+    for (const auto& point : s) e_scale += norm(point);
+    e_scale = 1.0 / sqrt(e_scale);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        vector<vector<complex<double>>> phi = poleBasis(poles, s);
+        vector<double> column_scale(N, 0.0);
+        for (size_t n = 0; n < N; ++n) {
+            for (size_t k = 0; k < K; ++k) column_scale[n] += norm(phi[k][n]);
+            column_scale[n] = column_scale[n] > 0.0 ? 1.0 / sqrt(column_scale[n]) : 0.0;
+        }
+
+        vector<vector<double>> reduced;
+        vector<double> reduced_rhs;
+        for (size_t m = 0; m < samples.size(); ++m) {
+            vector<vector<double>> A(2 * K, vector<double>(2 * N + 3, 0.0));
+            for (size_t k = 0; k < K; ++k) {
+                complex<double> f = samples[m][k] / scale[m];
+                for (size_t n = 0; n < N; ++n) {
+                    complex<double> p = phi[k][n] * column_scale[n];
+                    complex<double> q = -f * p;
+                    A[2 * k][n] = p.real();
+                    A[2 * k + 1][n] = p.imag();
+                    A[2 * k][N + 2 + n] = q.real();
+                    A[2 * k + 1][N + 2 + n] = q.imag();
+                }
+                A[2 * k][N] = d_scale;
+                A[2 * k + 1][N + 1] = s[k].imag() * e_scale;
+                A[2 * k][2 * N + 2] = f.real();
+                A[2 * k + 1][2 * N + 2] = f.imag();
+            }
+            householderQR(A, 2 * N + 2);
+            for (size_t row = N + 2; row < 2 * N + 2; ++row) {
+                reduced.emplace_back(A[row].begin() + N + 2, A[row].begin() + 2 * N + 2);
+                reduced_rhs.push_back(A[row][2 * N + 2]);
+            }
+        }
+        vector<double> c = leastSquares(reduced, reduced_rhs);
+        for (size_t n = 0; n < N; ++n) c[n] *= column_scale[n];
+        poles = relocatePoles(poles, c);
+    }
+
+    // Residues, d and e of each output for the final poles
+    vector<vector<complex<double>>> phi = poleBasis(poles, s);
+    for (size_t m = 0; m < samples.size(); ++m) {
+        vector<vector<double>> A(2 * K, vector<double>(N + 2, 0.0));
+        vector<double> rhs(2 * K);
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t n = 0; n < N; ++n) {
+                A[2 * k][n] = phi[k][n].real();
+                A[2 * k + 1][n] = phi[k][n].imag();
+            }
+            A[2 * k][N] = 1.0;
+            A[2 * k + 1][N + 1] = s[k].imag();
+            rhs[2 * k] = samples[m][k].real();
+            rhs[2 * k + 1] = samples[m][k].imag();
+        }
+        vector<double> c = leastSquares(A, rhs);
+        residues[m] = residuesFrom(poles, c);
+        constants[m] = c[N];
+        proportional[m] = c[N + 1];
+
+        double sum = 0.0;
+        for (size_t k = 0; k < K; ++k) sum += norm(evaluate(m, frequencies[k]) - samples[m][k]);
+        rmsError = max(rmsError, sqrt(sum / K) / scale[m]);
+    }
+    return rmsError;
+}
+
+void TransferFunction::clear() {
+    source.clear();
+    signals.clear();
+    poles.clear();
+    residues.clear();
+    constants.clear();
+    proportional.clear();
+    rmsError = 0.0;
+}
+
+int TransferFunction::signalIndex(const string& name) const {
+    auto it = find(signals.begin(), signals.end(), name);
+    return it == signals.end() ? -1 : static_cast<int>(it - signals.begin());
+}
+
+complex<double> TransferFunction::evaluate(size_t signal, double frequency) const {
+    complex<double> s(0.0, 2.0 * M_PI * frequency);
+    complex<double> value = constants[signal] + s * proportional[signal];
+    for (size_t k = 0; k < poles.size(); ++k) value += residues[signal][k] / (s - poles[k]);
+    return value;
+}
+
+double TransferFunction::impulseResponse(size_t signal, double time) const {
+    if (time < 0.0) {
+        return 0.0;
+    }
+    complex<double> value = 0.0;
+    for (size_t k = 0; k < poles.size(); ++k) value += residues[signal][k] * exp(poles[k] * time);
+    return value.real();
+}
@@ -0,0 +1,199 @@
+#include "TransientCheckpoint.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'C', 'S', 'C', 'K', 'P', 'T', '\0', '\0'};
+const uint32_t VERSION = 3;
+
+class Writer {
+public:
+    explicit Writer(ofstream& out) : out(out) {}
+
+    template <typename T>
+    void value(T v) { out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+    void doubles(const vector<double>& v) {
+        value<uint64_t>(v.size());
+        out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(double));
+    }
+
+    void rows(const vector<vector<double>>& v) {
+        value<uint64_t>(v.size());
+        for (const auto& row : v) doubles(row);
+    }
+
+private:
+    ofstream& out;
+};
+
+class Reader {
+public:
+    explicit Reader(ifstream& in) : in(in) {}
+
+    template <typename T>
+    T value() {
+        T v;
+        in.read(reinterpret_cast<char*>(&v), sizeof(T));
+        check();
+        return v;
+    }
+
+    vector<double> doubles() {
+        uint64_t n = value<uint64_t>();
+        if (n > (1u << 28)) {
+            throw runtime_error("Checkpoint file is corrupt.");
+        }
+        vector<double> v(n);
+        in.read(reinterpret_cast<char*>(v.data()), n * sizeof(double));
+        check();
+        return v;
+    }
+
+    vector<vector<double>> rows() {
+        uint64_t n = value<uint64_t>();
+        if (n > (1u << 28)) {
+            throw runtime_error("Checkpoint file is corrupt.");
+        }
+        vector<vector<double>> v;
+        for (uint64_t i = 0; i < n; ++i) v.push_back(doubles());
+        return v;
+    }
+
+private:
+    ifstream& in;
+
+    void check() {
+        if (!in) throw runtime_error("Checkpoint file is truncated.");
+    }
+};
+
+} // namespace
+
+void writeTransientCheckpoint(const string& path, const TransientCheckpoint& checkpoint) {
+    const string temp = path + ".tmp";
+    {
+        ofstream out(temp, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error("Cannot write checkpoint file " + temp + ".");
+        }
+        Writer w(out);
+        out.write(MAGIC, sizeof(MAGIC));
+        w.value(VERSION);
+
+        w.value(checkpoint.time);
+        w.value(checkpoint.t_step);
+        w.value(checkpoint.gridStart);
+        w.value<int64_t>(checkpoint.gridIndex);
+        w.value(checkpoint.nextStep);
+        w.value(checkpoint.minStep);
+        w.value(checkpoint.maxStep);
+        w.value(checkpoint.nextCheckpoint);
+        w.doubles(checkpoint.solution);
+        w.doubles(checkpoint.pastTimes);
+        w.rows(checkpoint.pastSolutions);
+        w.doubles(checkpoint.detectorTimes);
+        w.rows(checkpoint.detectorSolutions);
+        w.value(checkpoint.detectorSince);
+
+        const CircuitState& state = checkpoint.state;
+        w.doubles(state.nodeVoltages);
+        w.doubles(state.inductorCurrents);
+        w.value<uint64_t>(state.diodeStates.size());
+        for (DiodeState s : state.diodeStates) w.value<int32_t>(s);
+        w.doubles(state.diodeCurrents);
+        w.doubles(state.junctionVoltages);
+        w.rows(state.capacitorHistory);
+        w.rows(state.inductorHistory);
+        w.rows(state.reducedModelHistory);
+        w.value(state.prevDeltaT);
+        w.value<int32_t>(state.historyDepth);
+        w.value<int32_t>(state.dampingSteps);
+
+        const TransientStats& stats = checkpoint.stats;
+        w.value<int64_t>(stats.steps);
+        w.value<int64_t>(stats.newtonIterations);
+        w.value<int64_t>(stats.factorizations);
+        w.value<int64_t>(stats.diodeEvents);
+        w.value<int64_t>(stats.cacheHits);
+        w.value<int64_t>(stats.cacheMisses);
+
+        out.flush();
+        if (!out) {
+            throw runtime_error("Error writing checkpoint file " + temp + ".");
+        }
+    }
+    // Replaces the previous checkpoint in one step (atomically on POSIX), so it survives until
+    // the new one is complete
+    error_code error;
+    filesystem::rename(temp, path, error);
+    if (error) {
+        throw runtime_error("Cannot replace checkpoint file " + path + ": " + error.message() + ".");
+    }
+}
+
+TransientCheckpoint readTransientCheckpoint(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        throw runtime_error("Cannot open checkpoint file " + path + ".");
+    }
+    Reader r(in);
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in || !equal(magic, magic + sizeof(MAGIC), MAGIC)) {
+        throw runtime_error(path + " is not a transient checkpoint.");
+    }
+    if (r.value<uint32_t>() != VERSION) {
+        throw runtime_error("Unsupported checkpoint version in " + path + ".");
+    }
+
+    TransientCheckpoint checkpoint;
+    checkpoint.time = r.value<double>();
+    checkpoint.t_step = r.value<double>();
+    checkpoint.gridStart = r.value<double>();
+    checkpoint.gridIndex = r.value<int64_t>();
+    checkpoint.nextStep = r.value<double>();
+    checkpoint.minStep = r.value<double>();
+    checkpoint.maxStep = r.value<double>();
+    checkpoint.nextCheckpoint = r.value<double>();
+    checkpoint.solution = r.doubles();
+    checkpoint.pastTimes = r.doubles();
+    checkpoint.pastSolutions = r.rows();
+    checkpoint.detectorTimes = r.doubles();
+    checkpoint.detectorSolutions = r.rows();
+    checkpoint.detectorSince = r.value<double>();
+
+    CircuitState& state = checkpoint.state;
+    state.nodeVoltages = r.doubles();
+    state.inductorCurrents = r.doubles();
+    uint64_t diodes = r.value<uint64_t>();
+    if (diodes > (1u << 28)) {
+        throw runtime_error("Checkpoint file is corrupt.");
+    }
+    for (uint64_t i = 0; i < diodes; ++i) {
+        state.diodeStates.push_back(static_cast<DiodeState>(r.value<int32_t>()));
+    }
+    state.diodeCurrents = r.doubles();
+    state.junctionVoltages = r.doubles();
+    state.capacitorHistory = r.rows();
+    state.inductorHistory = r.rows();
+    state.reducedModelHistory = r.rows();
+    state.prevDeltaT = r.value<double>();
+    state.historyDepth = r.value<int32_t>();
+    state.dampingSteps = r.value<int32_t>();
+
+    TransientStats& stats = checkpoint.stats;
+    stats.steps = r.value<int64_t>();
+    stats.newtonIterations = r.value<int64_t>();
+    stats.factorizations = r.value<int64_t>();
+    stats.diodeEvents = r.value<int64_t>();
+    stats.cacheHits = r.value<int64_t>();
+    stats.cacheMisses = r.value<int64_t>();
+    return checkpoint;
+}
@@ -14,6 +14,10 @@ double VoltageSource::getVoltage() {
     return value;
 }
 
+double VoltageSource::valueAt(double time) const {
+    return waveform.valueAt(time, value);
+}
+
 void VoltageSource::addCurrentHistoryPoint(double time, double cur) {
     current_history.push_back({time, cur});
 }
@@ -0,0 +1,198 @@
+#include "Waveform.h"
+#include <cmath>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace std;
+
+Waveform Waveform::sine(double offset, double amplitude, double freq, double delay, double damping, double phase) {
+    Waveform w;
+    w.type = WaveformType::SIN;
+    w.params = {offset, amplitude, freq, delay, damping, phase};
+    return w;
+}
+
+Waveform Waveform::pulse(double v1, double v2, double delay, double rise, double fall, double width, double period) {
+    Waveform w;
+    w.type = WaveformType::PULSE;
+    w.params = {v1, v2, delay, rise, fall, width, period};
+    return w;
+}
+
+Waveform Waveform::exponential(double v1, double v2, double delay1, double tau1, double delay2, double tau2) {
+    Waveform w;
+    w.type = WaveformType::EXP;
+    w.params = {v1, v2, delay1, tau1, delay2, tau2};
+    return w;
+}
+
+Waveform Waveform::piecewiseLinear(const vector<double>& times, const vector<double>& values) {
+    if (times.empty() || times.size() != values.size()) {
+        throw invalid_argument("PWL waveform needs matching, non-empty time and value lists.");
+    }
+    for (size_t i = 1; i < times.size(); ++i) {
+        if (times[i] < times[i - 1]) {
+            throw invalid_argument("PWL waveform times must be non-decreasing.");
+        }
+    }
+    Waveform w;
+    w.type = WaveformType::PWL;
+    w.pwlTimes = times;
+    w.pwlValues = values;
+    return w;
+}
+
+Waveform Waveform::sampled(const vector<double>& times, const vector<double>& values) {
+    Waveform w = piecewiseLinear(times, values);
+    w.type = WaveformType::SAMPLED;
+    return w;
+}
+
+bool Waveform::isTimeVarying() const {
+    return type != WaveformType::DC;
+}
+
+double Waveform::valueAt(double time, double dcValue) const {
+    switch (type) {
+        case WaveformType::SIN: {
+            double vo = params[0], va = params[1], freq = params[2], td = params[3], theta = params[4];
+            double phase_rad = params[5] * M_PI / 180.0;
+            if (time < td) {
+                return vo + va * sin(phase_rad);
+            }
+            double tl = time - td;
+            return vo + va * exp(-theta * tl) * sin(2.0 * M_PI * freq * tl + phase_rad);
+        }
+        case WaveformType::PULSE: {
+            double v1 = params[0], v2 = params[1], td = params[2], tr = params[3], tf = params[4], pw = params[5], per = params[6];
+            if (time < td) {
+                return v1;
+            }
+            double tl = time - td;
+            if (per > 0.0) {
+                tl = fmod(tl, per);
+            }
+            if (tl < tr) {
+                return v1 + (v2 - v1) * tl / tr;
+            }
+            if (tl < tr + pw) {
+                return v2;
+            }
+            if (tl < tr + pw + tf) {
+                return v2 + (v1 - v2) * (tl - tr - pw) / tf;
+            }
+            return v1;
+        }
+        case WaveformType::EXP: {
+            double v1 = params[0], v2 = params[1], td1 = params[2], tau1 = params[3], td2 = params[4], tau2 = params[5];
+            double v = v1;
+            if (time >= td1) {
+                v += (v2 - v1) * (1.0 - exp(-(time - td1) / tau1));
+            }
+            if (time >= td2) {
+                v += (v1 - v2) * (1.0 - exp(-(time - td2) / tau2));
+            }
+            return v;
+        }
+        case WaveformType::PWL:
+        case WaveformType::SAMPLED:
+            return pwlValueAt(time);
+        case WaveformType::DC:
+        default:
+            return dcValue;
+    }
+}
+
+double Waveform::nextBreakpoint(double after) const {
+    const double none = numeric_limits<double>::infinity();
+    switch (type) {
+        case WaveformType::SIN: {
+            double td = params[3];
+            return (td > 0.0 && td > after) ? td : none;
+        }
+        case WaveformType::PULSE: {
+            double td = params[2], tr = params[3], tf = params[4], pw = params[5], per = params[6];
+            if (after < td) {
+                return td;
+            }
+            const double corners[] = {tr, tr + pw, tr + pw + tf};
+            double k = 0.0;
+            if (per > 0.0) {
+                k = floor((after - td) / per);
+            }
+            // Corners of the current period, then the start of the next one
+            for (int p = 0; p < 2; ++p) {
+                double start = td + (k + p) * per;
+                if (p == 1 && per <= 0.0) break;
+                if (start > after) return start;
+                for (double c : corners) {
+                    if (start + c > after) return start + c;
+                }
+            }
+            return none;
+        }
+        case WaveformType::EXP: {
+            double td1 = params[2], td2 = params[4];
+            if (td1 > after) return min(td1, td2 > after ? td2 : none);
+            return td2 > after ? td2 : none;
+        }
+        case WaveformType::PWL: {
+            auto it = upper_bound(pwlTimes.begin(), pwlTimes.end(), after);
+            return it != pwlTimes.end() ? *it : none;
+        }
+        case WaveformType::DC:
+        default:
+            return none;
+    }
+}
+
+double Waveform::period() const {
+    if (type == WaveformType::SIN && params[2] > 0.0 && params[4] == 0.0) {
+        return 1.0 / params[2];
+    }
+    if (type == WaveformType::PULSE && params[6] > 0.0) {
+        return params[6];
+    }
+    return 0.0;
+}
+
+double Waveform::periodStart() const {
+    if (type == WaveformType::SIN) return params[3];
+    if (type == WaveformType::PULSE) return params[2];
+    return 0.0;
+}
+
+double Waveform::pwlValueAt(double time) const {
+    size_t n = pwlTimes.size();
+    if (time <= pwlTimes[0]) {
+        cursor = 0;
+        return pwlValues[0];
+    }
+    if (time >= pwlTimes[n - 1]) {
+        cursor = n - 1;
+        return pwlValues[n - 1];
+    }
+
+    // Walk the cursor from the previous lookup; amortized O(1) when time advances monotonically
+    // and only a few segments back when a rejected step retreats
+    if (cursor >= n - 1) {
+        cursor = n - 2;
+    }
+    while (pwlTimes[cursor] > time) {
+        cursor--;
+    }
+    while (pwlTimes[cursor + 1] <= time) {
+        cursor++;
+    }
+
+    double t0 = pwlTimes[cursor], t1 = pwlTimes[cursor + 1];
+    if (t1 == t0) {
+        return pwlValues[cursor + 1];
+    }
+    return pwlValues[cursor] + (pwlValues[cursor + 1] - pwlValues[cursor]) * (time - t0) / (t1 - t0);
+}
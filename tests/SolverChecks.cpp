@@ -0,0 +1,1349 @@
+// Behavior and accuracy checks for the solvers, each against an independent reference
+// (analytic, a direct solve or a plain serial run). Run one check by name (as ctest does) or
+// all of them without arguments; the exit code is non-zero when a check fails.
+
+#include "Analysis.h"
+#include "Circuit.h"
+#include "CircuitSimulatorInterface.h"
+#include "DiodeLCP.h"
+#include "LinearSolver.h"
+#include "NewtonSolver.h"
+#include "TransientCheckpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Writes an MNA solution back to the nodes, sources and diodes (Analysis.cpp)
+void result_from_vec(Circuit& circuit, const vector<double>& solvedVoltages, const vector<Node*>& nonGroundNodes);
+
+namespace {
+
+typedef vector<pair<double, double>> History;
+
+// Runs an analysis with its progress messages silenced
+template <typename F>
+auto quietly(F run) -> decltype(run()) {
+    cout.setstate(ios::failbit);
+    auto result = run();
+    cout.clear();
+    return result;
+}
+
+// Linear interpolation of a (time, value) history
+double valueAt(const History& history, double t) {
+    auto it = lower_bound(history.begin(), history.end(), t - 1e-15,
+                          [](const pair<double, double>& point, double time) { return point.first < time; });
+    if (it == history.end()) return history.back().second;
+    if (it == history.begin()) return it->second;
+    auto prev = it - 1;
+    double w = (t - prev->first) / (it->first - prev->first);
+    return prev->second + w * (it->second - prev->second);
+}
+
+bool report(const char* what, double measured, double limit) {
+    bool ok = measured <= limit;
+    printf("  %-58s %.3e (limit %.1e) %s\n", what, measured, limit, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+bool reportAtLeast(const char* what, double measured, double limit) {
+    bool ok = measured >= limit;
+    printf("  %-58s %.3e (at least %.1e) %s\n", what, measured, limit, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// --- Companion models (TRAPEZOIDAL, GEAR2) and trapezoidal ringing damping ---
+
+// Series RLC (alpha = 1000/s, wd = 3000 rad/s) driven by a 1 V step at t = 0
+History rlcStepResponse(IntegrationMethod method, double t_step) {
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", 0.0);
+    SetSourcePulseWaveform(c, "V1", 0.0, 1.0, 0.0, 1e-9, 1e-9, 1.0, 0.0);
+    AddResistor(c, "R1", "in", "a", 20);
+    AddInductor(c, "L1", "a", "out", 10e-3);
+    AddCapacitor(c, "C1", "out", "0", 10e-6);
+    SetGroundNode(c, "0");
+    SetIntegrationMethod(c, static_cast<int>(method));
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    quietly([&] { return transientAnalysis(circuit, t_step, 0.01); });
+    History history = circuit.findNode("out")->voltage_history;
+    DestroyCircuit(c);
+    return history;
+}
+
+double rlcStepError(const History& history) {
+    const double alpha = 1000.0, wd = 3000.0;
+    double error = 0.0;
+    for (const auto& point : history) {
+        double t = point.first;
+        double exact = 1.0 - exp(-alpha * t) * (cos(wd * t) + alpha / wd * sin(wd * t));
+        error = max(error, fabs(point.second - exact));
+    }
+    return error;
+}
+
+// The RLC step response against the analytic solution. Trapezoidal and Gear-2 must converge at
+// second order and, at a step 5x larger, be more accurate than backward Euler
+bool companionModels() {
+    const IntegrationMethod methods[] = {IntegrationMethod::BACKWARD_EULER, IntegrationMethod::TRAPEZOIDAL,
+                                         IntegrationMethod::GEAR2};
+    const char* names[] = {"backward Euler", "trapezoidal", "Gear-2"};
+    double error[3][3]; // at 50, 20 and 10 us
+    for (int m = 0; m < 3; ++m) {
+        error[m][0] = rlcStepError(rlcStepResponse(methods[m], 5e-5));
+        error[m][1] = rlcStepError(rlcStepResponse(methods[m], 2e-5));
+        error[m][2] = rlcStepError(rlcStepResponse(methods[m], 1e-5));
+        printf("  %-15s max |error| %.3e, %.3e, %.3e at 50, 20, 10 us; order %.2f\n", names[m], error[m][0],
+               error[m][1], error[m][2], log2(error[m][1] / error[m][2]));
+    }
+    bool ok = reportAtLeast("trapezoidal order of convergence", log2(error[1][1] / error[1][2]), 1.8);
+    ok = reportAtLeast("Gear-2 order of convergence", log2(error[2][1] / error[2][2]), 1.8) && ok;
+    ok = report("trapezoidal at 50 us / backward Euler at 10 us", error[1][0] / error[0][2], 1.0) && ok;
+    return report("Gear-2 at 50 us / backward Euler at 10 us", error[2][0] / error[0][2], 1.0) && ok;
+}
+
+// A stiff RC (tau = 1 ms) settled at 1 V, continued by the trapezoidal rule at 0.1 s steps
+// from a capacitor history holding a spurious 1 mA. The trapezoidal error mode decays by
+// (1 - h/2tau) / (1 + h/2tau) = -0.96 per step, so undamped it still rings after 20 steps;
+// the ringing detector must switch to backward Euler, which removes it
+bool ringingDamping() {
+    const double R = 1000.0, C = 1e-6, h = 0.1, spurious = 1e-3;
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", 1.0);
+    AddResistor(c, "R1", "in", "out", R);
+    AddCapacitor(c, "C1", "out", "0", C);
+    SetGroundNode(c, "0");
+    SetIntegrationMethod(c, static_cast<int>(IntegrationMethod::TRAPEZOIDAL));
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    quietly([&] { return transientAnalysis(circuit, h, 3 * h); });
+    circuit.capacitors[0].prevCurrent = spurious;
+    Node* out = circuit.findNode("out");
+    out->clearHistory();
+    quietly([&] { return transientSegment(circuit, h, 3 * h, 23 * h, true); });
+    double damped = 0.0;
+    for (size_t i = 10; i < out->voltage_history.size(); ++i) {
+        damped = max(damped, fabs(out->voltage_history[i].second - 1.0));
+    }
+
+    // The same steps without damping: i = Geq v - Ieq, Ieq = Geq v_prev + i_prev
+    double v = 1.0, i = spurious, undamped = 0.0;
+    const double geq = 2.0 * C / h;
+    for (int step = 1; step <= 20; ++step) {
+        double ieq = geq * v + i;
+        double next = (1.0 / R + ieq) / (1.0 / R + geq);
+        i = geq * next - ieq;
+        v = next;
+        if (step > 10) undamped = max(undamped, fabs(v - 1.0));
+    }
+    DestroyCircuit(c);
+    printf("  undamped trapezoidal over the last 10 steps: %.3e V\n", undamped);
+    return report("damped trapezoidal over the last 10 steps, max |error| (V)", damped, 1e-3 * undamped);
+}
+
+// --- Shockley diode DC (DiodeModel::MODEL_SHOCKLEY) ---
+
+// A source driving a Shockley diode through a resistor, solved by Newton in dcAnalysis and by
+// bisection of (V - v) / R = Is (exp(v / (n Vt)) - 1) here, Vt = kT/q at 300 K
+bool shockleyOperatingPoint() {
+    struct Point {
+        double source, resistance, saturation, emission;
+    };
+    const Point points[] = {{5.0, 1000.0, 1e-14, 1.0}, {1.0, 100.0, 1e-9, 2.0}, {-5.0, 1000.0, 1e-14, 1.0}};
+    const double thermalVoltage = 0.025852;
+    double worst = 0.0;
+    for (const Point& p : points) {
+        void* c = CreateCircuit();
+        AddVoltageSource(c, "V1", "in", "0", p.source);
+        AddResistor(c, "R1", "in", "d", p.resistance);
+        AddDiode(c, "D1", "d", "0", 0.7);
+        SetDiodeModel(c, "D1", 1, p.saturation, p.emission);
+        SetGroundNode(c, "0");
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        bool converged = quietly([&] { return dcAnalysis(circuit); });
+        double solved = circuit.findNode("d")->voltage;
+        DestroyCircuit(c);
+
+        // The residual current falls monotonically with v
+        auto residual = [&](double v) {
+            return (p.source - v) / p.resistance - p.saturation * (exp(v / (p.emission * thermalVoltage)) - 1.0);
+        };
+        double lo = min(p.source, 0.0), hi = max(p.source, 0.0);
+        for (int i = 0; i < 200; ++i) {
+            double mid = 0.5 * (lo + hi);
+            (residual(mid) > 0.0 ? lo : hi) = mid;
+        }
+        double exact = 0.5 * (lo + hi);
+        printf("  V = %4.1f V, R = %6.1f, Is = %.0e, n = %.1f: %.9f V, hand %.9f V\n", p.source, p.resistance,
+               p.saturation, p.emission, solved, exact);
+        worst = max(worst, converged ? fabs(solved - exact) : 1.0);
+    }
+    return report("Newton vs hand operating point, max |difference| (V)", worst, 1e-6);
+}
+
+// --- Ideal diode switching events ---
+
+// A half-wave rectifier (5 V, 50 Hz source, Vf = 0.7 V, resistive load) at a 1 ms step. The
+// diode turns on when the source reaches Vf, at asin(Vf / 5) / (2 pi 50), and off when it falls
+// back to Vf half a period later; the off-grid history points the events add must sit at those
+// instants
+bool rectifierEventTime() {
+    const double amplitude = 5.0, frequency = 50.0, vf = 0.7, t_step = 1e-3;
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", 0.0);
+    SetSourceSinWaveform(c, "V1", 0.0, amplitude, frequency, 0.0, 0.0, 0.0);
+    AddDiode(c, "D1", "in", "out", vf);
+    AddResistor(c, "RL", "out", "0", 1000);
+    SetGroundNode(c, "0");
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    quietly([&] { return transientAnalysis(circuit, t_step, 0.02); });
+    vector<double> events;
+    for (const auto& point : circuit.findNode("out")->voltage_history) {
+        double steps = point.first / t_step;
+        if (fabs(steps - round(steps)) > 1e-6) events.push_back(point.first);
+    }
+    DestroyCircuit(c);
+
+    const double on = asin(vf / amplitude) / (2.0 * M_PI * frequency);
+    const double expected[] = {on, 0.5 / frequency - on};
+    double worst = events.size() == 2 ? 0.0 : 1.0;
+    for (size_t i = 0; i < events.size() && i < 2; ++i) {
+        printf("  event %zu at %.9f s, exact %.9f s\n", i, events[i], expected[i]);
+        worst = max(worst, fabs(events[i] - expected[i]));
+    }
+    printf("  %zu off-grid points\n", events.size());
+    return report("event time vs exact crossing, max |difference| (s)", worst, 1e-7);
+}
+
+// --- Waveform relaxation (RelaxationSettings) ---
+
+// An RC ladder driven by a repeating PULSE source, the kind of chain waveform relaxation
+// partitions into segments coupled through single nodes
+void* pulsedRCLadder(int sections) {
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "n0", "0", 0.0);
+    SetSourcePulseWaveform(c, "V1", 0.0, 1.0, 1e-4, 1e-5, 1e-5, 4e-4, 1e-3);
+    for (int i = 0; i < sections; ++i) {
+        string a = "n" + to_string(i), b = "n" + to_string(i + 1);
+        AddResistor(c, ("R" + to_string(i)).c_str(), a.c_str(), b.c_str(), 100);
+        AddCapacitor(c, ("C" + to_string(i)).c_str(), b.c_str(), "0", 1e-7);
+    }
+    AddResistor(c, "RL", ("n" + to_string(sections)).c_str(), "0", 1000);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// Largest difference between the voltage histories of two runs of the same circuit, over every
+// node and every time point of the reference
+double historyDifference(const Circuit& reference, const Circuit& other) {
+    double difference = 0.0;
+    for (const Node* node : reference.nodes) {
+        if (node->isGround) continue;
+        const History& history = const_cast<Circuit&>(other).findNode(node->name)->voltage_history;
+        if (history.empty()) return 1.0;
+        for (const auto& point : node->voltage_history) {
+            difference = max(difference, fabs(valueAt(history, point.first) - point.second));
+        }
+    }
+    return difference;
+}
+
+// A 20-section ladder over two pulse periods by waveform relaxation on four partitions in
+// 0.1 ms windows, Jacobi and Gauss-Seidel, against the serial transient at the same step
+bool waveformRelaxation() {
+    const double t_step = 2e-6, t_stop = 2e-3;
+    void* serial = pulsedRCLadder(20);
+    Circuit& reference = *static_cast<Circuit*>(serial);
+    quietly([&] { return transientAnalysis(reference, t_step, t_stop); });
+    double worst = 0.0;
+    for (bool gaussSeidel : {false, true}) {
+        void* c = pulsedRCLadder(20);
+        SetWaveformRelaxation(c, 4, 1e-4, 0, 1e-6, gaussSeidel);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        bool converged = quietly([&] { return waveformRelaxationAnalysis(circuit, t_step, t_stop); });
+        double difference = converged ? historyDifference(reference, circuit) : 1.0;
+        printf("  %-12s max |difference| %.3e V\n", gaussSeidel ? "Gauss-Seidel" : "Jacobi", difference);
+        worst = max(worst, difference);
+        DestroyCircuit(c);
+    }
+    DestroyCircuit(serial);
+    return report("relaxation vs serial transient, max |difference| (V)", worst, 1e-5);
+}
+
+// --- Parareal (PararealSettings) ---
+
+// The pulsed RC ladder by Parareal on eight slices, converged to the default tolerance and run
+// for the full slice count of iterations, where it reproduces the serial fine propagator,
+// against the serial transient at the same step
+bool parareal() {
+    const double t_step = 2e-6, t_stop = 2e-3;
+    void* serial = pulsedRCLadder(20);
+    Circuit& reference = *static_cast<Circuit*>(serial);
+    quietly([&] { return transientAnalysis(reference, t_step, t_stop); });
+    double difference[2];
+    for (int exact = 0; exact < 2; ++exact) {
+        void* c = pulsedRCLadder(20);
+        SetParareal(c, 8, 0, 0, 0.0);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        if (exact) circuit.pararealSettings.relTol = circuit.pararealSettings.absTol = 0.0;
+        bool converged = quietly([&] { return pararealAnalysis(circuit, t_step, t_stop); });
+        int iterations = 0;
+        double speedup = 0.0, wallTime = 0.0;
+        GetPararealStats(c, &iterations, &speedup, &wallTime);
+        difference[exact] = converged || exact ? historyDifference(reference, circuit) : 1.0;
+        printf("  %-22s %d iteration(s), max |difference| %.3e V\n", exact ? "slice-count iterations" : "default tolerance",
+               iterations, difference[exact]);
+        DestroyCircuit(c);
+    }
+    DestroyCircuit(serial);
+    bool ok = report("converged Parareal vs serial transient, max |difference| (V)", difference[0], 1e-4);
+    return report("Parareal after 8 iterations vs serial, max |difference| (V)", difference[1], 1e-12) && ok;
+}
+
+// --- Periodic steady state (SteadyStateSettings) ---
+
+// A half-wave rectifier (50 Hz, 10 V) charging a 100 uF smoothing capacitor through 200 ohm.
+// The shooting-Newton period is compared with the last period of a 60-period serial transient
+// at the same step, settled by then (its drift over the last period is printed)
+bool periodicSteadyState() {
+    const double period = 0.02, t_step = 1e-4;
+    const int periods = 60;
+    auto rectifier = [] {
+        void* c = CreateCircuit();
+        AddVoltageSource(c, "V1", "in", "0", 0.0);
+        SetSourceSinWaveform(c, "V1", 0.0, 10.0, 50.0, 0.0, 0.0, 0.0);
+        AddResistor(c, "RS", "in", "a", 200);
+        AddDiode(c, "D1", "a", "out", 0.7);
+        AddCapacitor(c, "C1", "out", "0", 100e-6);
+        AddResistor(c, "RL", "out", "0", 1000);
+        SetGroundNode(c, "0");
+        return c;
+    };
+    void* serial = rectifier();
+    Circuit& reference = *static_cast<Circuit*>(serial);
+    quietly([&] { return transientAnalysis(reference, t_step, periods * period); });
+    void* c = rectifier();
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    bool converged = quietly([&] { return periodicSteadyStateAnalysis(circuit, t_step, period); });
+    int newton = 0, krylov = 0, simulated = 0;
+    GetSteadyStateStats(c, &newton, &krylov, &simulated);
+
+    const double t_last = (periods - 1) * period;
+    double difference = converged ? 0.0 : 1.0, drift = 0.0;
+    for (const char* name : {"a", "out"}) {
+        const History& settled = reference.findNode(name)->voltage_history;
+        for (const auto& point : circuit.findNode(name)->voltage_history) {
+            double last = valueAt(settled, t_last + point.first);
+            difference = max(difference, fabs(last - point.second));
+            drift = max(drift, fabs(last - valueAt(settled, t_last - period + point.first)));
+        }
+    }
+    printf("  %d Newton iteration(s), %d periods simulated (serial: %d, last-period drift %.3e V)\n", newton,
+           simulated, periods, drift);
+    DestroyCircuit(c);
+    DestroyCircuit(serial);
+    return report("steady-state period vs serial last period, max |difference| (V)", difference, 1e-6);
+}
+
+// --- Early termination at steady state (TransientSettings::steadyStateStop) ---
+
+// An RC (tau = 1 ms) stepped to 1 V, and the same RC driven by a 1 kHz sine, over 50 ms with
+// early termination, against the full runs. The run must stop well before t_stop but not
+// before the full run has settled to the tolerance (to its final value, or to its value a
+// period later), and its filled output must cover the same time points as the full run and
+// stay within the tolerance of it
+bool steadyStateStop() {
+    const double t_step = 1e-5, t_stop = 0.05, relTol = 1e-5, absTol = 1e-6, period = 1e-3;
+    double worst = 0.0, latest = 0.0, margin = 1.0;
+    bool sameGrid = true;
+    for (int periodic = 0; periodic < 2; ++periodic) {
+        Circuit* runs[2];
+        void* handles[2];
+        for (int early = 0; early < 2; ++early) {
+            void* c = CreateCircuit();
+            AddVoltageSource(c, "V1", "in", "0", 0.0);
+            if (periodic) {
+                SetSourceSinWaveform(c, "V1", 0.0, 1.0, 1.0 / period, 0.0, 0.0, 0.0);
+            } else {
+                SetSourcePulseWaveform(c, "V1", 0.0, 1.0, 0.0, 1e-9, 1e-9, 1.0, 0.0);
+            }
+            AddResistor(c, "R1", "in", "out", 1000);
+            AddCapacitor(c, "C1", "out", "0", 1e-6);
+            SetGroundNode(c, "0");
+            SetSteadyStateStop(c, early == 1, 0.0, relTol, absTol);
+            handles[early] = c;
+            runs[early] = static_cast<Circuit*>(c);
+            quietly([&] { return transientAnalysis(*runs[early], t_step, t_stop); });
+        }
+        double stopTime = -1.0;
+        bool stoppedPeriodic = false;
+        bool stopped = GetTransientEarlyStop(handles[1], &stopTime, &stoppedPeriodic);
+        const History& full = runs[0]->findNode("out")->voltage_history;
+        const History& filled = runs[1]->findNode("out")->voltage_history;
+        sameGrid = sameGrid && stopped && stoppedPeriodic == (periodic == 1) && full.size() == filled.size();
+        double difference = 0.0, settled = 0.0;
+        for (size_t i = 0; i < full.size(); ++i) {
+            double t = full[i].first, v = full[i].second;
+            double target = periodic ? valueAt(full, min(t + period, t_stop)) : full.back().second;
+            if (t + period <= t_stop && fabs(v - target) > relTol * fabs(v) + absTol) settled = t;
+            if (i < filled.size()) {
+                sameGrid = sameGrid && t == filled[i].first;
+                difference = max(difference, fabs(v - filled[i].second));
+            }
+        }
+        printf("  %-4s settled at %.4f s, stopped at %.4f s of %.2f s, max |difference| %.3e V\n",
+               periodic ? "sine" : "step", settled, stopTime, t_stop, difference);
+        worst = max(worst, difference);
+        latest = max(latest, stopped ? stopTime / t_stop : 1.0);
+        margin = min(margin, stopTime - settled);
+        DestroyCircuit(handles[0]);
+        DestroyCircuit(handles[1]);
+    }
+    bool ok = report("filled output on a different time grid (0 = same)", sameGrid ? 0.0 : 1.0, 0.0);
+    ok = report("latest stop time / t_stop", latest, 0.5) && ok;
+    ok = reportAtLeast("stop time - settling time of the full run (s)", margin, 0.0) && ok;
+    return report("filled vs full output, max |difference| (V)", worst, relTol + absTol) && ok;
+}
+
+// --- Transient checkpoints (TransientSettings::checkpointInterval) ---
+
+// A half-wave rectifier with an LC filter, whose diode switches throughout the run
+void* filteredRectifier() {
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", 0.0);
+    SetSourceSinWaveform(c, "V1", 0.0, 10.0, 50.0, 0.0, 0.0, 0.0);
+    AddResistor(c, "RS", "in", "a", 5);
+    AddDiode(c, "D1", "a", "b", 0.7);
+    AddInductor(c, "L1", "b", "out", 10e-3);
+    AddCapacitor(c, "C1", "out", "0", 220e-6);
+    AddResistor(c, "RL", "out", "0", 100);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// The rectifier over 0.1 s with checkpoints every 0.035 s, at a fixed step and with adaptive
+// steps. A fresh circuit resumed from the last checkpoint (written mid-run) must reproduce
+// every node's history from there bit for bit
+bool checkpointResume() {
+    const double t_step = 1e-4, t_stop = 0.1;
+    const string path = "solver_checks_resume.ckpt";
+    bool identical = true;
+    for (int adaptive = 0; adaptive < 2; ++adaptive) {
+        void* handles[2];
+        double resumedFrom = 0.0;
+        for (int resumed = 0; resumed < 2; ++resumed) {
+            void* c = filteredRectifier();
+            if (adaptive) SetTransientStepControl(c, true, 1e-4, 1e-7, 0.0, 0.0);
+            Circuit& circuit = *static_cast<Circuit*>(c);
+            if (resumed) {
+                resumedFrom = readTransientCheckpoint(path).time;
+                quietly([&] { return resumeTransientAnalysis(circuit, path, t_stop); });
+            } else {
+                SetTransientCheckpoint(c, path.c_str(), 0.035);
+                quietly([&] { return transientAnalysis(circuit, t_step, t_stop); });
+            }
+            handles[resumed] = c;
+        }
+        const Circuit& full = *static_cast<Circuit*>(handles[0]);
+        Circuit& resumed = *static_cast<Circuit*>(handles[1]);
+        size_t compared = 0;
+        bool same = resumedFrom > 0.0 && resumedFrom < t_stop;
+        for (const Node* node : full.nodes) {
+            if (node->isGround) continue;
+            History tail;
+            for (const auto& point : node->voltage_history) {
+                if (point.first >= resumedFrom) tail.push_back(point);
+            }
+            const History& history = resumed.findNode(node->name)->voltage_history;
+            same = same && history.size() == tail.size() &&
+                   memcmp(history.data(), tail.data(), tail.size() * sizeof(tail[0])) == 0;
+            compared += tail.size();
+        }
+        printf("  %-8s resumed from t = %.4f s, %zu points compared: %s\n", adaptive ? "adaptive" : "fixed",
+               resumedFrom, compared, same ? "bit-identical" : "DIFFERENT");
+        identical = identical && same;
+        DestroyCircuit(handles[0]);
+        DestroyCircuit(handles[1]);
+    }
+    remove(path.c_str());
+    return report("resumed histories differing from the full run (0 = bit-identical)", identical ? 0.0 : 1.0, 0.0);
+}
+
+// --- PRIMA model reduction (ReductionSettings) ---
+
+// A 120-section RC line between a source and a diode-clamped load, whose internal nodes
+// reduceLinearSubnetworks replaces with one macromodel
+void* rcLine(bool ac) {
+    void* c = CreateCircuit();
+    if (ac) {
+        AddACVoltageSource(c, "V1", "in", "0", 1.0, 0.0);
+    } else {
+        AddVoltageSource(c, "V1", "in", "0", 0.0);
+        SetSourcePulseWaveform(c, "V1", 0.0, 2.0, 1e-5, 1e-6, 1e-6, 1e-4, 2e-4);
+    }
+    for (int i = 0; i < 120; ++i) {
+        string a = i == 0 ? "in" : "n" + to_string(i), b = i == 119 ? "out" : "n" + to_string(i + 1);
+        AddResistor(c, ("R" + to_string(i)).c_str(), a.c_str(), b.c_str(), 5);
+        AddCapacitor(c, ("C" + to_string(i)).c_str(), b.c_str(), "0", 1e-9);
+    }
+    AddResistor(c, "RL", "out", "0", 1000);
+    KeepNodeObservable(c, "out");
+    if (!ac) AddDiode(c, "D1", "out", "0", 0.7);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// The line's port voltage V(out) with the full network and with a PRIMA macromodel matching
+// eight block moments about DC: AC over 100 Hz - 1 MHz relative to the largest response, and
+// the clamped pulse response in transient
+bool primaReduction() {
+    double ac = 0.0, transient = 0.0;
+    int states = 0;
+    vector<complex<double>> response[2];
+    History waveform[2];
+    for (int reduced = 0; reduced < 2; ++reduced) {
+        for (int kind = 0; kind < 2; ++kind) {
+            void* c = rcLine(kind == 0);
+            if (reduced) {
+                int subnetworks = quietly([&] { return ReduceLinearSubnetworks(c, 0, 8, 0, 0.0); });
+                int removedNodes = 0, removedComponents = 0;
+                GetReductionStats(c, &subnetworks, &removedNodes, &removedComponents, &states);
+            }
+            Circuit& circuit = *static_cast<Circuit*>(c);
+            if (kind == 0) {
+                quietly([&] { return acSweepAnalysis(circuit, "V1", 100, 1e6, 60, "Decade"); });
+                int signal = circuit.acSweepResults.signalIndex("V(out)");
+                for (size_t p = 0; p < circuit.acSweepResults.points(); ++p) {
+                    response[reduced].push_back(circuit.acSweepResults.phasor(p, signal));
+                }
+            } else {
+                quietly([&] { return transientAnalysis(circuit, 2e-7, 4e-4); });
+                waveform[reduced] = circuit.findNode("out")->voltage_history;
+            }
+            DestroyCircuit(c);
+        }
+    }
+    double largest = 0.0;
+    for (size_t p = 0; p < response[0].size(); ++p) {
+        largest = max(largest, abs(response[0][p]));
+        ac = max(ac, p < response[1].size() ? abs(response[1][p] - response[0][p]) : 1.0);
+    }
+    for (const auto& point : waveform[0]) {
+        transient = max(transient, fabs(valueAt(waveform[1], point.first) - point.second));
+    }
+    printf("  119 internal nodes reduced to %d states\n", states);
+    bool ok = report("AC port response, max relative difference", ac / largest, 1e-6);
+    return report("transient port voltage, max |difference| (V)", transient, 1e-6) && ok;
+}
+
+// --- DC sweep (DcSweepSettings) ---
+
+// A zener-clamped source feeding a Shockley diode and load
+void* clampedDiodeLoad(double volts) {
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", volts);
+    AddResistor(c, "R1", "in", "a", 100);
+    AddZenerDiode(c, "Z1", "0", "a", 0.7, 5.1);
+    AddDiode(c, "D1", "a", "out", 0.7);
+    SetDiodeModel(c, "D1", 1, 1e-14, 1.0);
+    AddResistor(c, "RL", "out", "0", 1000);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// A -10 V to 10 V sweep of the clamp in 0.05 V steps, as one warm-started segment and as four,
+// against dcAnalysis of a fresh circuit at every sweep value. Both stop Newton at
+// NewtonSettings' tolerance from different starting points, so they must agree to within it
+bool dcSweep() {
+    const NewtonSettings newton;
+    const double start = -10.0, stop = 10.0, step = 0.05;
+    const char* names[] = {"in", "a", "out"};
+    vector<vector<double>> reference;
+    for (int k = 0; start + k * step <= stop + 1e-9; ++k) {
+        void* c = clampedDiodeLoad(start + k * step);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        quietly([&] { return dcAnalysis(circuit); });
+        reference.push_back({});
+        for (const char* name : names) reference.back().push_back(circuit.findNode(name)->voltage);
+        DestroyCircuit(c);
+    }
+    double worst = 0.0;
+    for (int segments : {1, 4}) {
+        void* c = clampedDiodeLoad(0.0);
+        SetDCSweepOptions(c, segments, 0);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        quietly([&] { dcSweepAnalysis(circuit, "V1", start, stop, step); return true; });
+        int points = 0, factorizations = 0, used = 0;
+        GetDCSweepStats(c, &points, &factorizations, &used);
+        double difference = points == static_cast<int>(reference.size()) ? 0.0 : 1e9;
+        for (size_t n = 0; n < 3; ++n) {
+            const History& history = circuit.findNode(names[n])->dc_sweep_history;
+            for (size_t k = 0; k < reference.size(); ++k) {
+                double tol = newton.relTol * fabs(reference[k][n]) + newton.voltageTol;
+                difference = max(difference, k < history.size() ? fabs(history[k].second - reference[k][n]) / tol : 1e9);
+            }
+        }
+        printf("  %d segment(s): %d points, %d factorizations, max |difference| %.3f of the tolerance\n", used, points,
+               factorizations, difference);
+        worst = max(worst, difference);
+        DestroyCircuit(c);
+    }
+    return report("sweep vs point-by-point dcAnalysis, max |difference| / tolerance", worst, 1.0);
+}
+
+// --- Homotopy continuation (HomotopySettings) ---
+
+// Twenty Shockley diodes in series across 10 V through 100 ohm, each biased at about 0.5 V,
+// from which the plain Newton solve started at zero does not converge. With homotopy the
+// operating point must be found and agree at every node with the current I bisected from
+// V = I R + 20 n Vt ln(1 + I / Is) here, the diodes sharing the remaining voltage equally
+bool homotopyContinuation() {
+    const int diodes = 20;
+    const double V = 10.0, R = 100.0, Is = 1e-14, thermalVoltage = 0.025852;
+    double lo = 0.0, hi = V / R;
+    for (int i = 0; i < 200; ++i) {
+        double current = 0.5 * (lo + hi);
+        (current * R + diodes * thermalVoltage * log1p(current / Is) > V ? hi : lo) = current;
+    }
+    const double junction = (V - 0.5 * (lo + hi) * R) / diodes;
+
+    double error[2];
+    int method = 0, steps = 0, failedSteps = 0;
+    for (int homotopy = 0; homotopy < 2; ++homotopy) {
+        void* c = CreateCircuit();
+        AddVoltageSource(c, "V1", "in", "0", V);
+        AddResistor(c, "R1", "in", "n0", R);
+        for (int i = 0; i < diodes; ++i) {
+            string name = "D" + to_string(i), cathode = i == diodes - 1 ? "0" : "n" + to_string(i + 1);
+            AddDiode(c, name.c_str(), ("n" + to_string(i)).c_str(), cathode.c_str(), 0.7);
+            SetDiodeModel(c, name.c_str(), 1, Is, 1.0);
+        }
+        SetGroundNode(c, "0");
+        SetHomotopyOptions(c, homotopy == 1, 0.0, 0.0, 0);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        cerr.setstate(ios::failbit);
+        quietly([&] { return dcAnalysis(circuit); });
+        cerr.clear();
+        error[homotopy] = 0.0;
+        for (int i = 0; i < diodes; ++i) {
+            double v = circuit.findNode("n" + to_string(i))->voltage;
+            error[homotopy] = isfinite(v) ? max(error[homotopy], fabs(v - (diodes - i) * junction)) : INFINITY;
+        }
+        if (homotopy) GetHomotopyStats(c, &method, &steps, &failedSteps);
+        DestroyCircuit(c);
+    }
+    printf("  plain Newton: max |error| %.3e V\n", error[0]);
+    printf("  homotopy method %d (1 gmin, 2 source, 3 pseudo-transient), %d steps, %d failed\n", method, steps,
+           failedSteps);
+    bool ok = reportAtLeast("homotopy method used (0 = plain solve converged)", method, 1.0);
+    ok = report("homotopy method failed (4 = all failed)", method == static_cast<int>(HomotopyMethod::FAILED), 0.0) && ok;
+    return report("homotopy vs hand solution, max |difference| (V)", error[1], 1e-6) && ok;
+}
+
+// --- Operating-point reuse (Circuit::operatingPoint) ---
+
+// Node voltages and source currents of a solved circuit
+vector<double> solvedValues(Circuit& circuit) {
+    vector<double> values;
+    for (const Node* node : circuit.nodes) values.push_back(node->voltage);
+    for (auto& source : circuit.voltageSources) values.push_back(source.getCurrent());
+    return values;
+}
+
+// dcAnalysis of the zener clamp, repeated after a transient has moved every node and diode
+// state: the repeat must reuse the cached point (as its progress message says) and give it
+// back bit for bit. With the load changed the cache only warm-starts the solve, whose result
+// must match a fresh circuit with that load to the Newton tolerance
+bool operatingPointReuse() {
+    auto solve = [](Circuit& circuit) {
+        ostringstream log;
+        streambuf* console = cout.rdbuf(log.rdbuf());
+        dcAnalysis(circuit);
+        cout.rdbuf(console);
+        return log.str().find("Reusing the operating point") != string::npos;
+    };
+    void* c = clampedDiodeLoad(8.0);
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    bool first = solve(circuit);
+    vector<double> solved = solvedValues(circuit);
+    quietly([&] { return transientAnalysis(circuit, 1e-5, 1e-4); });
+    for (auto& diode : circuit.diodes) diode.setState(STATE_OFF);
+    for (Node* node : circuit.nodes) node->setVoltage(0.0);
+    bool repeat = solve(circuit);
+    vector<double> reused = solvedValues(circuit);
+    bool identical = !first && repeat && reused.size() == solved.size() &&
+                     memcmp(reused.data(), solved.data(), solved.size() * sizeof(double)) == 0;
+    printf("  first solve %s, repeat %s\n", first ? "reused" : "solved", repeat ? "reused" : "solved");
+
+    for (auto& resistor : circuit.resistors) {
+        if (resistor.name == "RL") resistor.resistance = 2000;
+    }
+    bool changed = solve(circuit);
+    void* fresh = clampedDiodeLoad(8.0);
+    Circuit& reference = *static_cast<Circuit*>(fresh);
+    for (auto& resistor : reference.resistors) {
+        if (resistor.name == "RL") resistor.resistance = 2000;
+    }
+    solve(reference);
+    const NewtonSettings newton;
+    double difference = changed ? 1e9 : 0.0;
+    for (size_t i = 0; i < circuit.nodes.size(); ++i) {
+        double v = reference.nodes[i]->voltage;
+        difference = max(difference, fabs(circuit.nodes[i]->voltage - v) / (newton.relTol * fabs(v) + newton.voltageTol));
+    }
+    DestroyCircuit(fresh);
+    DestroyCircuit(c);
+    bool ok = report("repeat not reused or not bit-identical (0 = identical hit)", identical ? 0.0 : 1.0, 0.0);
+    return report("warm start after a value change vs fresh, max |difference| / tolerance", difference, 1.0) && ok;
+}
+
+// --- Ideal-diode DC states by LCP (DiodeLCP) ---
+
+// The DC system for the present diode states, solved and written back to the circuit
+void solveDCStates(Circuit& circuit) {
+    vector<Node*> nonGroundNodes;
+    for (Node* node : circuit.nodes) {
+        if (!node->isGround) nonGroundNodes.push_back(node);
+    }
+    circuit.assignDiodeBranchIndices();
+    circuit.set_MNA_A(AnalysisType::DC);
+    circuit.set_MNA_RHS(AnalysisType::DC);
+    result_from_vec(circuit, gaussianElimination(circuit.MNA_A, circuit.MNA_RHS), nonGroundNodes);
+}
+
+void prepareDC(Circuit& circuit) {
+    circuit.setDeltaT(1e12);
+    circuit.stepMethod = IntegrationMethod::BACKWARD_EULER;
+    circuit.time = 0.0;
+    for (auto& diode : circuit.diodes) diode.setState(STATE_OFF);
+}
+
+// The state iteration the LCP replaced: starting with every diode off, solve, switch each
+// diode whose voltage or current violates its state, and repeat until none does
+bool stateIteration(Circuit& circuit) {
+    const double SWITCH_TOL = 1e-9;
+    prepareDC(circuit);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        solveDCStates(circuit);
+        bool switched = false;
+        for (auto& diode : circuit.diodes) {
+            double v = diode.node1->getVoltage() - diode.node2->getVoltage();
+            DiodeState state = diode.getState();
+            DiodeState next = state;
+            if (state == STATE_OFF && v > diode.getForwardVoltage() + SWITCH_TOL) {
+                next = STATE_FORWARD_ON;
+            } else if (state == STATE_OFF && diode.getDiodeType() == ZENER && v < -diode.getZenerVoltage() - SWITCH_TOL) {
+                next = STATE_REVERSE_ON;
+            } else if (state == STATE_FORWARD_ON && diode.getCurrent() < -SWITCH_TOL) {
+                next = STATE_OFF;
+            } else if (state == STATE_REVERSE_ON && diode.getCurrent() > SWITCH_TOL) {
+                next = STATE_OFF;
+            }
+            switched = switched || next != state;
+            diode.setState(next);
+        }
+        if (!switched) return true;
+    }
+    return false;
+}
+
+// A bridge rectifier (bleed resistors keep its output nodes defined with every diode off) and
+// an ideal zener clamp feeding a diode and load, each at source values from -10 V to 10 V:
+// the states from Lemke's method must be those the state iteration settles on, and the node
+// voltages they give the same
+bool diodeLCP() {
+    int points = 0, pivots = 0, stateMismatches = 0, conducting[3] = {0, 0, 0};
+    double difference = 0.0;
+    for (int kind = 0; kind < 2; ++kind) {
+        for (double volts = -10.0; volts <= 10.0 + 1e-9; volts += 0.25) {
+            vector<DiodeState> states[2];
+            vector<double> voltages[2];
+            for (int lemke = 0; lemke < 2; ++lemke) {
+                void* c = CreateCircuit();
+                AddVoltageSource(c, "V1", "in", "0", volts);
+                if (kind == 0) {
+                    AddResistor(c, "RS", "in", "a", 10);
+                    AddDiode(c, "D1", "a", "p", 0.7);
+                    AddDiode(c, "D2", "0", "p", 0.7);
+                    AddDiode(c, "D3", "n", "a", 0.7);
+                    AddDiode(c, "D4", "n", "0", 0.7);
+                    AddResistor(c, "RL", "p", "n", 100);
+                    AddResistor(c, "RP", "p", "0", 1e6);
+                    AddResistor(c, "RN", "n", "0", 1e6);
+                } else {
+                    AddResistor(c, "R1", "in", "a", 100);
+                    AddZenerDiode(c, "Z1", "0", "a", 0.7, 5.1);
+                    AddDiode(c, "D1", "a", "out", 0.7);
+                    AddResistor(c, "RL", "out", "0", 1000);
+                }
+                SetGroundNode(c, "0");
+                Circuit& circuit = *static_cast<Circuit*>(c);
+                if (lemke) {
+                    prepareDC(circuit);
+                    DiodeLCP lcp;
+                    if (lcp.prepare(circuit) && lcp.solve(circuit)) {
+                        pivots += lcp.lastPivots;
+                    } else {
+                        stateMismatches++;
+                    }
+                    solveDCStates(circuit);
+                } else if (!stateIteration(circuit)) {
+                    stateMismatches++;
+                }
+                for (const auto& diode : circuit.diodes) states[lemke].push_back(diode.getState());
+                for (const Node* node : circuit.nodes) voltages[lemke].push_back(node->voltage);
+                DestroyCircuit(c);
+            }
+            if (states[0] != states[1]) stateMismatches++;
+            for (DiodeState state : states[1]) conducting[state]++;
+            for (size_t i = 0; i < voltages[0].size(); ++i) {
+                difference = max(difference, fabs(voltages[0][i] - voltages[1][i]));
+            }
+            points++;
+        }
+    }
+    printf("  %d operating points, %d Lemke pivots in total; diode states off %d, forward %d, reverse %d\n",
+           points, pivots, conducting[STATE_OFF], conducting[STATE_FORWARD_ON], conducting[STATE_REVERSE_ON]);
+    bool ok = report("operating points with different diode states", stateMismatches, 0.0);
+    return report("LCP vs state iteration node voltages, max |difference| (V)", difference, 1e-12) && ok;
+}
+
+// --- Factorization cache (NewtonSettings::cacheEntries) ---
+
+// The filtered rectifier over ten periods at a fixed step: its diode alternates between two
+// conduction patterns, so after the first period returning to a pattern at the regular step
+// must hit the cache, and the run must give the same waveforms as with the cache off
+bool factorizationCache() {
+    History waveform[2];
+    int hits[2] = {0, 0}, misses[2] = {0, 0};
+    long events = 0;
+    for (int cached = 0; cached < 2; ++cached) {
+        void* c = filteredRectifier();
+        SetFactorizationCache(c, cached ? 8 : 0);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        quietly([&] { return transientAnalysis(circuit, 1e-4, 0.2); });
+        GetFactorizationCacheStats(c, &hits[cached], &misses[cached]);
+        waveform[cached] = circuit.findNode("out")->voltage_history;
+        events = circuit.transientStats.diodeEvents;
+        DestroyCircuit(c);
+    }
+    printf("  %ld diode events; cache on: %d hits, %d misses; cache off: %d hits, %d misses\n", events, hits[1],
+           misses[1], hits[0], misses[0]);
+    double difference = waveform[0].size() == waveform[1].size() ? 0.0 : 1.0;
+    for (size_t i = 0; i < waveform[0].size() && i < waveform[1].size(); ++i) {
+        difference = max(difference, fabs(waveform[0][i].second - waveform[1][i].second));
+    }
+    bool ok = reportAtLeast("hits / diode events with the cache on", static_cast<double>(hits[1]) / events, 0.9);
+    return report("cache on vs off, max |difference| (V)", difference, 1e-12) && ok;
+}
+
+// --- Exponential integrator (TransientSettings::exponentialIntegrator) ---
+
+void* pulsedRLC() {
+    void* c = CreateCircuit();
+    AddVoltageSource(c, "V1", "in", "0", 0.0);
+    SetSourcePulseWaveform(c, "V1", 0.0, 1.0, 1e-3, 1e-4, 1e-4, 2e-3, 5e-3);
+    AddResistor(c, "R1", "in", "a", 50);
+    AddInductor(c, "L1", "a", "out", 10e-3);
+    AddCapacitor(c, "C1", "out", "0", 10e-6);
+    AddResistor(c, "R2", "out", "0", 200);
+    AddCapacitor(c, "C2", "in", "b", 1e-6);
+    AddResistor(c, "R3", "b", "0", 1000);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+History pulsedRLCResponse(double t_step, bool exponential) {
+    void* c = pulsedRLC();
+    if (exponential) {
+        SetExponentialIntegrator(c, true, 0.0, 0);
+    } else {
+        SetIntegrationMethod(c, static_cast<int>(IntegrationMethod::TRAPEZOIDAL));
+    }
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    quietly([&] { return transientAnalysis(circuit, t_step, 0.02); });
+    History history = circuit.findNode("out")->voltage_history;
+    DestroyCircuit(c);
+    return history;
+}
+
+// The RLC network driven by a PULSE source, integrated exponentially at t_step = 1 ms and by
+// the trapezoidal rule at 0.1 ms, against the Richardson extrapolation of trapezoidal runs at
+// 1e-7 and 5e-8 s (both land on the source breakpoints, so the h^2 error term cancels)
+bool exponentialIntegrator() {
+    History coarse = pulsedRLCResponse(1e-7, false);
+    History fine = pulsedRLCResponse(5e-8, false);
+    auto reference = [&](double t) { return (4.0 * valueAt(fine, t) - valueAt(coarse, t)) / 3.0; };
+    auto maxError = [&](const History& history) {
+        double error = 0.0;
+        for (const auto& point : history) error = max(error, fabs(point.second - reference(point.first)));
+        return error;
+    };
+    double exponential = maxError(pulsedRLCResponse(1e-3, true));
+    double trapezoidal = maxError(pulsedRLCResponse(1e-4, false));
+    printf("  trapezoidal at t_step = 0.1 ms for comparison: %.3e\n", trapezoidal);
+    return report("exponential integrator at t_step = 1 ms, max |error| (V)", exponential, 1e-9);
+}
+
+// --- Parallel AC sweep (AcSweepSettings::threads) ---
+
+void* acLadder(int sections) {
+    void* c = CreateCircuit();
+    AddACVoltageSource(c, "VIN", "n0", "0", 1.0, 0.0);
+    for (int i = 0; i < sections; ++i) {
+        string a = "n" + to_string(i), b = "n" + to_string(i + 1);
+        AddResistor(c, ("R" + to_string(i)).c_str(), a.c_str(), b.c_str(), 10);
+        if (i % 2) {
+            AddInductor(c, ("L" + to_string(i)).c_str(), b.c_str(), "0", 1e-3);
+        } else {
+            AddCapacitor(c, ("C" + to_string(i)).c_str(), b.c_str(), "0", 1e-6);
+        }
+    }
+    AddResistor(c, "RL", ("n" + to_string(sections)).c_str(), "0", 50);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// The same decade sweep of an RLC ladder on one thread and on four: every phasor must be
+// bit-identical
+bool parallelACSweep() {
+    vector<double> sweep;
+    vector<complex<double>> values;
+    bool identical = true;
+    for (int threads : {1, 4}) {
+        void* c = acLadder(40);
+        SetACSweepOptions(c, threads, 1);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        quietly([&] { return acSweepAnalysis(circuit, "VIN", 10, 1e6, 100, "Decade"); });
+        int points = 0, used = 0, passes = 0;
+        GetACSweepStats(c, &points, &used, &passes);
+        printf("  %d thread(s) requested, %d used, %d points\n", threads, used, points);
+        const PhasorSweep& results = circuit.acSweepResults;
+        if (sweep.empty()) {
+            sweep = results.sweep;
+            values = results.values;
+        } else {
+            identical = results.sweep.size() == sweep.size() && results.values.size() == values.size() &&
+                        memcmp(results.sweep.data(), sweep.data(), sweep.size() * sizeof(double)) == 0 &&
+                        memcmp(results.values.data(), values.data(), values.size() * sizeof(values[0])) == 0;
+        }
+        DestroyCircuit(c);
+    }
+    return report("phasors differing between 1 and 4 threads (0 = bit-identical)", identical ? 0.0 : 1.0, 0.0);
+}
+
+// --- AC pencil assembly (Circuit::acPencil) ---
+
+// Y(jw) stamped element by element with complex admittances, as the AC matrix was assembled
+// before the G + jwC + Gamma/(jw) pencil
+void elementAdmittanceMatrix(const Circuit& circuit, double frequency, vector<vector<complex<double>>>& A) {
+    int n = circuit.countNonGroundNodes();
+    size_t size = n + circuit.acVoltageSources.size();
+    A.assign(size, vector<complex<double>>(size, {0.0, 0.0}));
+    auto stamp = [&](const Node* node1, const Node* node2, complex<double> y) {
+        int a = circuit.getNodeMatrixIndex(node1);
+        int b = circuit.getNodeMatrixIndex(node2);
+        if (a != -1) A[a][a] += y;
+        if (b != -1) A[b][b] += y;
+        if (a != -1 && b != -1) {
+            A[a][b] -= y;
+            A[b][a] -= y;
+        }
+    };
+    const complex<double> jw(0.0, 2.0 * M_PI * frequency);
+    for (const auto& res : circuit.resistors) stamp(res.node1, res.node2, 1.0 / res.resistance);
+    for (const auto& cap : circuit.capacitors) stamp(cap.node1, cap.node2, 1.0 / (1.0 / (jw * cap.capacitance)));
+    for (const auto& ind : circuit.inductors) stamp(ind.node1, ind.node2, 1.0 / (jw * ind.inductance));
+    for (size_t i = 0; i < circuit.acVoltageSources.size(); ++i) {
+        int a = circuit.getNodeMatrixIndex(circuit.acVoltageSources[i].node1);
+        int b = circuit.getNodeMatrixIndex(circuit.acVoltageSources[i].node2);
+        size_t row = n + i;
+        if (a != -1) {
+            A[a][row] += 1.0;
+            A[row][a] += 1.0;
+        }
+        if (b != -1) {
+            A[b][row] -= 1.0;
+            A[row][b] -= 1.0;
+        }
+    }
+}
+
+// An RLC ladder and a two-resonance filter swept from their pencils, against direct solves of
+// the element-by-element matrices: largest difference of any phasor at any frequency,
+// relative to the largest phasor of that sweep
+bool acPencilAssembly() {
+    double worst = 0.0;
+    for (int circuitKind = 0; circuitKind < 2; ++circuitKind) {
+        void* c = circuitKind == 0 ? acLadder(40) : CreateCircuit();
+        if (circuitKind == 1) {
+            AddACVoltageSource(c, "VIN", "in", "0", 1.0, 0.0);
+            AddResistor(c, "R1", "in", "a", 1);
+            AddInductor(c, "L1", "a", "b", 1e-3);
+            AddCapacitor(c, "C1", "b", "out", 1e-6);
+            AddCapacitor(c, "C3", "a", "b", 1e-8);
+            AddResistor(c, "RL", "out", "0", 2);
+            AddInductor(c, "L2", "out", "m", 1e-2);
+            AddCapacitor(c, "C2", "m", "q", 1e-9);
+            AddResistor(c, "RQ", "q", "0", 50);
+            SetGroundNode(c, "0");
+        }
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        SetACSweepOptions(c, 1, 1);
+        quietly([&] { return acSweepAnalysis(circuit, "VIN", 10, 1e7, 200, "Decade"); });
+        const PhasorSweep& results = circuit.acSweepResults;
+
+        vector<vector<complex<double>>> A;
+        vector<complex<double>> b, x;
+        double largest = 0.0, difference = 0.0;
+        for (size_t p = 0; p < results.points(); ++p) {
+            elementAdmittanceMatrix(circuit, results.sweep[p], A);
+            circuit.acRHS(b);
+            gaussianEliminationInPlace(A, b, x);
+            for (size_t i = 0; i < circuit.nodes.size(); ++i) {
+                const Node* node = circuit.nodes[i];
+                if (node->isGround) continue;
+                int signal = results.signalIndex("V(" + node->name + ")");
+                complex<double> value = results.phasor(p, signal);
+                largest = max(largest, abs(value));
+                difference = max(difference, abs(value - x[circuit.getNodeMatrixIndex(node)]));
+            }
+        }
+        worst = max(worst, difference / largest);
+        DestroyCircuit(c);
+    }
+    return report("pencil vs element-by-element assembly, max relative difference", worst, 5e-15);
+}
+
+// --- Sweep signal views (PhasorSweep) ---
+
+// A 2 V, 30 degree source across an RC low-pass and an RL branch, swept in frequency and in
+// source phase. The magnitude, dB and phase views read through GetSweepSignal must match the
+// phasors computed here, V(out) = Vs / (1 + jwRC) and I(L1) = Vs / (R2 + jwL), with the
+// phase in (-180, 180]
+bool sweepSignalViews() {
+    const double magnitude = 2.0, phase = 30.0, R = 1000.0, C = 1e-6, R2 = 100.0, L = 10e-3, f0 = 200.0;
+    void* c = CreateCircuit();
+    AddACVoltageSource(c, "VIN", "in", "0", magnitude, phase);
+    AddResistor(c, "R1", "in", "out", R);
+    AddCapacitor(c, "C1", "out", "0", C);
+    AddInductor(c, "L1", "in", "m", L);
+    AddResistor(c, "R2", "m", "0", R2);
+    SetGroundNode(c, "0");
+    Circuit& circuit = *static_cast<Circuit*>(c);
+
+    auto expected = [&](int analysis, const string& signal, double sweepValue) {
+        double f = analysis == 0 ? sweepValue : f0;
+        double degrees = analysis == 0 ? phase : sweepValue;
+        complex<double> source = polar(magnitude, degrees * M_PI / 180.0);
+        complex<double> jw(0.0, 2.0 * M_PI * f);
+        return signal == "V(out)" ? source / (1.0 + jw * R * C) : source / (R2 + jw * L);
+    };
+    double worst[3] = {0.0, 0.0, 0.0};
+    int count = 0;
+    for (int analysis = 0; analysis < 2; ++analysis) {
+        // Each analysis clears the results of the other
+        if (analysis == 0) {
+            quietly([&] { return acSweepAnalysis(circuit, "VIN", 1, 1e6, 61, "Decade"); });
+        } else {
+            quietly([&] { return phaseSweepAnalysis(circuit, "VIN", f0, -180, 180, 73); });
+        }
+        for (const string signal : {"V(out)", "I(L1)"}) {
+            for (int view = 0; view < 3; ++view) {
+                double sweep[100], values[100];
+                int n = GetSweepSignal(c, analysis, signal.c_str(), view, sweep, values, 100);
+                count += n;
+                if (n == 0) worst[view] = INFINITY;
+                for (int i = 0; i < n; ++i) {
+                    complex<double> x = expected(analysis, signal, sweep[i]);
+                    double exact = view == 0 ? abs(x) : view == 1 ? 20.0 * log10(abs(x)) : arg(x) * 180.0 / M_PI;
+                    double error = fabs(values[i] - exact);
+                    if (view == 0) error /= abs(x);
+                    if (view == 2) error = min(error, 360.0 - error); // -180 and 180 are the same phase
+                    if (view == 2 && (values[i] <= -180.0 || values[i] > 180.0)) error = INFINITY;
+                    worst[view] = max(worst[view], error);
+                }
+            }
+        }
+    }
+    DestroyCircuit(c);
+    printf("  %d values read\n", count);
+    bool ok = report("magnitude view, max relative error", worst[0], 1e-12);
+    ok = report("dB view, max |error| (dB)", worst[1], 1e-10) && ok;
+    return report("phase view, max |error| (degrees)", worst[2], 1e-9) && ok;
+}
+
+// --- Adaptive AC sweep (AcSweepSettings::adaptiveTol) ---
+
+void* notchedBandPass() {
+    void* c = CreateCircuit();
+    AddACVoltageSource(c, "VIN", "in", "0", 1.0, 0.0);
+    AddResistor(c, "R1", "in", "a", 1);
+    AddInductor(c, "L1", "a", "b", 1e-3);
+    AddCapacitor(c, "C1", "b", "out", 1e-6);
+    AddResistor(c, "RL", "out", "0", 2);
+    AddInductor(c, "L2", "out", "m", 1e-2);
+    AddCapacitor(c, "C2", "m", "q", 1e-9);
+    AddResistor(c, "RQ", "q", "0", 50);
+    SetGroundNode(c, "0");
+    return c;
+}
+
+// |V(out)| in dB over a sweep of the band pass
+History notchedBandPassResponse(const char* sweepType, int points) {
+    void* c = notchedBandPass();
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    quietly([&] { return acSweepAnalysis(circuit, "VIN", 100, 1e7, points, sweepType); });
+    const PhasorSweep& results = circuit.acSweepResults;
+    int signal = results.signalIndex("V(out)");
+    History response;
+    for (size_t p = 0; p < results.points(); ++p) {
+        response.push_back({log10(results.sweep[p]), 20.0 * log10(abs(results.phasor(p, signal)))});
+    }
+    DestroyCircuit(c);
+    return response;
+}
+
+// The band pass with its Q=63 notch near 50 kHz, swept on a decade grid and adaptively with the
+// same point budget; each response is interpolated linearly in log frequency and compared in dB
+// against a 20001-point decade sweep
+bool adaptiveACSweep() {
+    History reference = notchedBandPassResponse("Decade", 20001);
+    double worstRatio = 0.0;
+    for (int points : {100, 200, 400}) {
+        double error[2] = {0.0, 0.0};
+        int k = 0;
+        for (const char* sweepType : {"Decade", "Adaptive"}) {
+            History response = notchedBandPassResponse(sweepType, points);
+            for (const auto& point : reference) {
+                error[k] = max(error[k], fabs(valueAt(response, point.first) - point.second));
+            }
+            k++;
+        }
+        printf("  budget %3d: decade %.3f dB, adaptive %.3f dB\n", points, error[0], error[1]);
+        worstRatio = max(worstRatio, error[1] / error[0]);
+    }
+    return report("adaptive / decade worst-case dB error, largest ratio", worstRatio, 0.7);
+}
+
+// --- Fast frequency sweep (AcSweepSettings::fastSweep) ---
+
+// A 100-section RLC ladder and the notched band pass swept at 300 decade points through the
+// Krylov-projected model, against the direct sweep of the same points: largest difference of
+// any phasor at any frequency, relative to the largest phasor of that sweep
+bool fastACSweep() {
+    double worst = 0.0;
+    for (int circuitKind = 0; circuitKind < 2; ++circuitKind) {
+        PhasorSweep results[2];
+        int expansions = 0, order = 0, direct = 0;
+        for (int fast = 0; fast < 2; ++fast) {
+            void* c = circuitKind == 0 ? acLadder(100) : notchedBandPass();
+            SetFastACSweep(c, fast == 1, 0, 0, 0.0);
+            Circuit& circuit = *static_cast<Circuit*>(c);
+            quietly([&] { return acSweepAnalysis(circuit, "VIN", 100, 1e7, 300, "Decade"); });
+            if (fast) GetFastACSweepStats(c, &expansions, &order, &direct);
+            results[fast] = circuit.acSweepResults;
+            DestroyCircuit(c);
+        }
+        double largest = 0.0, difference = results[0].values.size() == results[1].values.size() ? 0.0 : INFINITY;
+        for (size_t i = 0; i < results[0].values.size() && i < results[1].values.size(); ++i) {
+            largest = max(largest, abs(results[0].values[i]));
+            difference = max(difference, abs(results[1].values[i] - results[0].values[i]));
+        }
+        printf("  %-11s %d expansion point(s), order %d, %d point(s) solved directly, max relative difference %.3e\n",
+               circuitKind == 0 ? "ladder" : "band pass", expansions, order, direct, difference / largest);
+        worst = max(worst, difference / largest);
+    }
+    return report("fast vs direct sweep, max relative difference", worst, 1e-8);
+}
+
+// --- Transfer function fit (TransferFunction) ---
+
+// Rational models of two responses each of the notched band pass (order 4) and a 12-section
+// RLC ladder, fitted over 100 Hz - 10 MHz with the order chosen automatically and evaluated at
+// the 1000 points of a direct decade sweep of the same band (the source is 1 V at 0 degrees,
+// so the responses are the phasors): largest difference relative to the largest response of
+// each signal
+bool transferFunctionFit() {
+    double worst = 0.0;
+    for (int circuitKind = 0; circuitKind < 2; ++circuitKind) {
+        void* c = circuitKind == 0 ? notchedBandPass() : acLadder(12);
+        Circuit& circuit = *static_cast<Circuit*>(c);
+        vector<string> signals = circuitKind == 0 ? vector<string>{"V(out)", "I(L2)"} : vector<string>{"V(n12)", "I(L5)"};
+        for (const string& signal : signals) AddTransferFunctionOutput(c, signal.c_str());
+        bool fitted = quietly([&] { return transferFunctionAnalysis(circuit, "VIN", 100, 1e7, 0); });
+        int order = 0;
+        double rmsError = 0.0;
+        GetTransferFunctionStats(c, &order, &rmsError);
+        quietly([&] { return acSweepAnalysis(circuit, "VIN", 100, 1e7, 1000, "Decade"); });
+        const PhasorSweep& results = circuit.acSweepResults;
+        printf("  %-9s order %2d, fit rms error %.3e\n", circuitKind == 0 ? "band pass" : "ladder", order, rmsError);
+        for (const string& signal : signals) {
+            int index = results.signalIndex(signal);
+            double largest = 0.0, difference = fitted && index != -1 ? 0.0 : INFINITY;
+            for (size_t p = 0; p < results.points() && index != -1; ++p) {
+                double re = 0.0, im = 0.0;
+                if (!EvaluateTransferFunction(c, signal.c_str(), results.sweep[p], &re, &im)) difference = INFINITY;
+                complex<double> direct = results.phasor(p, index);
+                largest = max(largest, abs(direct));
+                difference = max(difference, abs(complex<double>(re, im) - direct));
+            }
+            printf("    %-7s max relative difference %.3e\n", signal.c_str(), difference / largest);
+            worst = max(worst, difference / largest);
+        }
+        DestroyCircuit(c);
+    }
+    return report("model vs direct sweep, max relative difference", worst, 1e-10);
+}
+
+// --- Adjoint sensitivities (SensitivityResults) ---
+
+// A Shockley diode between RLC networks (DC) and an RLC filter (AC)
+void* sensitivityCircuit(bool ac) {
+    void* c = CreateCircuit();
+    if (ac) {
+        AddACVoltageSource(c, "VIN", "in", "0", 1.0, 0.0);
+        AddResistor(c, "R1", "in", "a", 100);
+        AddInductor(c, "L1", "a", "out", 10e-3);
+        AddCapacitor(c, "C1", "out", "0", 1e-6);
+        AddResistor(c, "R2", "out", "0", 1000);
+        AddCapacitor(c, "C2", "a", "0", 100e-9);
+    } else {
+        AddVoltageSource(c, "V1", "in", "0", 5.0);
+        AddResistor(c, "R1", "in", "a", 1000);
+        AddResistor(c, "R3", "a", "0", 5000);
+        AddInductor(c, "L1", "a", "b", 1e-3);
+        AddDiode(c, "D1", "b", "out", 0.7);
+        SetDiodeModel(c, "D1", 1, 1e-14, 1.0);
+        AddResistor(c, "R2", "out", "0", 2000);
+        AddCapacitor(c, "C1", "out", "0", 1e-6);
+    }
+    SetGroundNode(c, "0");
+    return c;
+}
+
+void scaleComponent(Circuit& circuit, const string& name, double factor) {
+    for (auto& res : circuit.resistors) {
+        if (res.name == name) res.resistance *= factor;
+    }
+    for (auto& cap : circuit.capacitors) {
+        if (cap.name == name) cap.capacitance *= factor;
+    }
+    for (auto& ind : circuit.inductors) {
+        if (ind.name == name) ind.inductance *= factor;
+    }
+    for (auto& vs : circuit.voltageSources) {
+        if (vs.name == name) vs.value *= factor;
+    }
+    for (auto& ac : circuit.acVoltageSources) {
+        if (ac.name == name) ac.magnitude *= factor;
+    }
+}
+
+// The output of a sensitivity run with one component value scaled
+complex<double> sensitivityOutput(bool ac, const string& output, const string& component, double factor) {
+    void* c = sensitivityCircuit(ac);
+    Circuit& circuit = *static_cast<Circuit*>(c);
+    scaleComponent(circuit, component, factor);
+    quietly([&] { return ac ? acSensitivityAnalysis(circuit, output, 1000.0) : dcSensitivityAnalysis(circuit, output); });
+    complex<double> value = circuit.sensitivity.value;
+    DestroyCircuit(c);
+    return value;
+}
+
+// Every derivative of V(out) and an inductor current, in DC and at 1 kHz, against central
+// differences of re-solved circuits with the component scaled by 1 +- 1e-5. Compared as
+// normalized sensitivities p / |y| dy/dp so that all components weigh alike; capacitors and
+// inductors must come out zero in DC
+bool adjointSensitivity() {
+    const double delta = 1e-5;
+    double worst = 0.0;
+    int compared = 0;
+    for (int ac = 0; ac < 2; ++ac) {
+        for (const string output : {"V(out)", "I(L1)"}) {
+            void* c = sensitivityCircuit(ac == 1);
+            Circuit& circuit = *static_cast<Circuit*>(c);
+            bool solved = quietly([&] {
+                return ac ? acSensitivityAnalysis(circuit, output, 1000.0) : dcSensitivityAnalysis(circuit, output);
+            });
+            SensitivityResults results = circuit.sensitivity;
+            double difference = solved && results.components.size() >= 5 ? 0.0 : INFINITY;
+            for (size_t k = 0; k < results.components.size(); ++k) {
+                const string& component = results.components[k];
+                double nominal = 0.0;
+                for (const auto& res : circuit.resistors) if (res.name == component) nominal = res.resistance;
+                for (const auto& cap : circuit.capacitors) if (cap.name == component) nominal = cap.capacitance;
+                for (const auto& ind : circuit.inductors) if (ind.name == component) nominal = ind.inductance;
+                for (const auto& vs : circuit.voltageSources) if (vs.name == component) nominal = vs.value;
+                for (const auto& src : circuit.acVoltageSources) if (src.name == component) nominal = src.magnitude;
+                complex<double> up = sensitivityOutput(ac == 1, output, component, 1.0 + delta);
+                complex<double> down = sensitivityOutput(ac == 1, output, component, 1.0 - delta);
+                complex<double> finite = (up - down) / (2.0 * delta);
+                difference = max(difference, abs(results.derivatives[k] * nominal - finite) / abs(results.value));
+                compared++;
+            }
+            DestroyCircuit(c);
+            printf("  %s %-6s %zu components, max |normalized difference| %.3e\n", ac ? "AC" : "DC",
+                   output.c_str(), results.components.size(), difference);
+            worst = max(worst, difference);
+        }
+    }
+    return report("adjoint vs finite differences, max |normalized difference|", worst, 1e-8);
+}
+
+struct Check {
+    const char* name;
+    bool (*run)();
+};
+
+const Check checks[] = {
+    {"companion_models", companionModels},
+    {"ringing_damping", ringingDamping},
+    {"shockley_operating_point", shockleyOperatingPoint},
+    {"rectifier_event_time", rectifierEventTime},
+    {"waveform_relaxation", waveformRelaxation},
+    {"parareal", parareal},
+    {"periodic_steady_state", periodicSteadyState},
+    {"steady_state_stop", steadyStateStop},
+    {"checkpoint_resume", checkpointResume},
+    {"prima_reduction", primaReduction},
+    {"dc_sweep", dcSweep},
+    {"homotopy_continuation", homotopyContinuation},
+    {"operating_point_reuse", operatingPointReuse},
+    {"diode_lcp", diodeLCP},
+    {"factorization_cache", factorizationCache},
+    {"exponential_integrator", exponentialIntegrator},
+    {"parallel_ac_sweep", parallelACSweep},
+    {"ac_pencil_assembly", acPencilAssembly},
+    {"sweep_signal_views", sweepSignalViews},
+    {"adaptive_ac_sweep", adaptiveACSweep},
+    {"fast_ac_sweep", fastACSweep},
+    {"transfer_function_fit", transferFunctionFit},
+    {"adjoint_sensitivity", adjointSensitivity},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool ok = true;
+    int ran = 0;
+    for (const Check& check : checks) {
+        if (argc > 1 && strcmp(argv[1], check.name) != 0) continue;
+        printf("%s\n", check.name);
+        ok = check.run() && ok;
+        ran++;
+    }
+    if (ran == 0) {
+        cerr << "Error: no check named " << argv[1] << "." << endl;
+        return 2;
+    }
+    return ok ? 0 : 1;
+}